@@ -37,6 +37,22 @@ typedef struct
     idl_uint32_t micro; /**< Micro component of the version. */
 } idl_api_version_t;
 
+/**
+ * @brief   Trace event.
+ * @details Scoped compiler event, corresponding to a complete event (phase 'X') of the Chrome
+ *          trace event format.
+ * @ingroup structs
+ */
+typedef struct
+{
+    idl_utf8_t    name; /**< Event name (for example, the pass or generator function). */
+    idl_utf8_t    category; /**< Event category: compile, import, pass or generator. */
+    idl_utf8_t    detail; /**< Event argument, such as the imported file name (empty string if none). */
+    idl_float64_t start; /**< Start time in microseconds from an unspecified point in time. */
+    idl_float64_t duration; /**< Duration in microseconds. */
+    idl_uint32_t  thread_id; /**< Identifier of the thread that emitted the event. */
+} idl_trace_event_t;
+
 /**
  * @name Function pointer types.
  * @brief Function pointers definitions.
@@ -85,6 +101,18 @@ typedef void
 (*idl_write_callback_t)(const idl_source_t* source,
                         idl_data_t data);
 
+/**
+ * @brief     Callback to which trace events are passed.
+ * @details   Receives an event when the compiler leaves a traced scope.
+ * @param[in] event Completed trace event.
+ * @param[in] data User data specified when setting up a callback.
+ * @note      The callback may be called concurrently from several threads when generators run in parallel.
+ * @ingroup   types
+ */
+typedef void
+(*idl_trace_callback_t)(const idl_trace_event_t* event,
+                        idl_data_t data);
+
 /** @} */
 
 /**
@@ -174,7 +202,7 @@ idl_options_set_warnings_as_errors(idl_options_t options,
  * @brief     Get output directory.
  * @details   Returns the path that the compiler will use to save compilation output.
  * @param[in] options Target options.
- * @return    Directory path.
+ * @return    Directory path (empty for the base directory).
  * @sa        ::idl_options_set_output_dir
  * @ingroup   functions
  */
@@ -183,7 +211,8 @@ idl_options_get_output_dir(idl_options_t options);
 
 /**
  * @brief     Set output directory.
- * @details   Configure the path that the compiler will use to save compilation output.
+ * @details   Configure the path that the compiler will use to save compilation output. A relative path is
+ *            resolved against ::idl_options_set_base_dir.
  * @param[in] options Target options.
  * @param[in] dir Directory path.
  * @note      Compiler output to the file system does not occur if output via a ::idl_options_set_writer is configured.
@@ -194,6 +223,59 @@ idl_api void
 idl_options_set_output_dir(idl_options_t options,
                            idl_utf8_t dir);
 
+/**
+ * @brief     Get base directory.
+ * @details   Returns the directory against which relative paths are resolved.
+ * @param[in] options Target options.
+ * @return    Directory path, or null if the current working directory is used.
+ * @sa        ::idl_options_set_base_dir
+ * @ingroup   functions
+ */
+idl_api idl_utf8_t
+idl_options_get_base_dir(idl_options_t options);
+
+/**
+ * @brief     Set base directory.
+ * @details   Configures the directory against which the relative input file, output directory, import
+ *            directories and depfile paths are resolved. If set, the compiler does not use the current
+ *            working directory of the process.
+ * @param[in] options Target options.
+ * @param[in] dir Directory path (null to use the current working directory).
+ * @note      The current working directory is shared by all threads of a process, so services that
+ *            compile from several threads should set an absolute base directory.
+ * @sa        ::idl_options_get_base_dir
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_base_dir(idl_options_t options,
+                         idl_utf8_t dir);
+
+/**
+ * @brief     Get number of jobs.
+ * @details   Returns the number of threads a single compilation may use.
+ * @param[in] options Target options.
+ * @return    Number of jobs (0 for one job per hardware thread).
+ * @sa        ::idl_options_set_jobs
+ * @ingroup   functions
+ */
+idl_api idl_uint32_t
+idl_options_get_jobs(idl_options_t options);
+
+/**
+ * @brief     Set number of jobs.
+ * @details   Configures the number of threads a single compilation may use. With more than one job, the
+ *            imported files are lexed concurrently before they are parsed, the declarations are checked
+ *            concurrently, and several generators or output files are generated concurrently. The result of
+ *            the compilation does not depend on the number of jobs. The default is 1.
+ * @param[in] options Target options.
+ * @param[in] jobs Number of jobs (0 for one job per hardware thread).
+ * @sa        ::idl_options_get_jobs
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_jobs(idl_options_t options,
+                     idl_uint32_t jobs);
+
 /**
  * @brief         Returns an array of directories to search for imports.
  * @details       These paths are used to search source code when an import is encountered during compilation.
@@ -380,6 +462,167 @@ idl_api void
 idl_options_set_version(idl_options_t options,
                         const idl_api_version_t* version);
 
+/**
+ * @brief     Get import cache setting.
+ * @details   Return *TRUE* if the compiler instance keeps its import directory index between compilations.
+ * @param[in] options Target options.
+ * @return    *TRUE* is enabled.
+ * @sa        ::idl_options_set_import_cache
+ * @ingroup   functions
+ */
+idl_api idl_bool_t
+idl_options_get_import_cache(idl_options_t options);
+
+/**
+ * @brief     Set import cache setting.
+ * @details   Each import directory is listed once and indexed by lowercase file name. By default the
+ *            index lives for a single compilation; if enabled, it is kept in the idl_compiler_t instance
+ *            and reused by subsequent compilations.
+ * @param[in] options Target options.
+ * @param[in] enable Enable import cache.
+ * @note      Files added to or removed from import directories after they were indexed are not seen while the cache is enabled.
+ * @sa        ::idl_options_get_import_cache
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_import_cache(idl_options_t options,
+                             idl_bool_t enable);
+
+/**
+ * @brief     Get compile cache setting.
+ * @details   Return *TRUE* if the compiler instance reuses outputs of previous compilations.
+ * @param[in] options Target options.
+ * @return    *TRUE* is enabled.
+ * @sa        ::idl_options_set_compile_cache
+ * @ingroup   functions
+ */
+idl_api idl_bool_t
+idl_options_get_compile_cache(idl_options_t options);
+
+/**
+ * @brief     Set compile cache setting.
+ * @details   If enabled, the idl_compiler_t instance remembers the outputs and warnings of each successful
+ *            compilation together with the content hashes of all sources it read and the modification times
+ *            of the directories searched for imports. A subsequent compilation with the same arguments and
+ *            options whose sources and searched directories have not changed returns the remembered
+ *            outputs without parsing. Other compilations still parse and generate everything, but imported
+ *            files whose path and content are unchanged are not lexed again.
+ * @param[in] options Target options.
+ * @param[in] enable Enable compile cache.
+ * @note      Sources obtained from ::idl_options_set_importer are requested again to check their hashes. The JavaScript
+ *            generator output is reused together with its generation timestamp.
+ * @sa        ::idl_options_get_compile_cache
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_compile_cache(idl_options_t options,
+                              idl_bool_t enable);
+
+/**
+ * @brief     Get write if changed setting.
+ * @details   Return *TRUE* if output files whose content has not changed are left untouched.
+ * @param[in] options Target options.
+ * @return    *TRUE* is enabled.
+ * @sa        ::idl_options_set_write_if_changed
+ * @ingroup   functions
+ */
+idl_api idl_bool_t
+idl_options_get_write_if_changed(idl_options_t options);
+
+/**
+ * @brief     Set write if changed setting.
+ * @details   If enabled, the compiler compares the generated content with the existing output file by hash
+ *            and does not rewrite the file if they are equal, so its modification time is preserved and
+ *            build systems do not rebuild dependent targets.
+ * @param[in] options Target options.
+ * @param[in] enable Enable write if changed.
+ * @note      Files actually written are reported by ::idl_compilation_result_get_changed_files.
+ * @sa        ::idl_options_get_write_if_changed
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_write_if_changed(idl_options_t options,
+                                 idl_bool_t enable);
+
+/**
+ * @brief     Get depfile path.
+ * @details   Returns the path of the depfile written after compilation.
+ * @param[in] options Target options.
+ * @return    Depfile path, or null if no depfile is written.
+ * @sa        ::idl_options_set_depfile
+ * @ingroup   functions
+ */
+idl_api idl_utf8_t
+idl_options_get_depfile(idl_options_t options);
+
+/**
+ * @brief     Set depfile path.
+ * @details   After a successful compilation, the compiler writes a Make/Ninja depfile listing every file
+ *            resolved from the file system while compiling (the input file and all its imports). Sources
+ *            from ::idl_options_set_importer and in-memory sources are not listed.
+ * @param[in] options Target options.
+ * @param[in] file Depfile path (null to disable).
+ * @note      The depfile rule names ::idl_options_set_depfile_target if set, otherwise all output files written
+ *            to disk. Ninja requires the target to be an output declared for the build edge.
+ * @sa        ::idl_options_get_depfile
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_depfile(idl_options_t options,
+                        idl_utf8_t file);
+
+/**
+ * @brief     Get depfile target.
+ * @details   Returns the target written as the depfile rule output.
+ * @param[in] options Target options.
+ * @return    Depfile target, or null if output files are used.
+ * @sa        ::idl_options_set_depfile_target
+ * @ingroup   functions
+ */
+idl_api idl_utf8_t
+idl_options_get_depfile_target(idl_options_t options);
+
+/**
+ * @brief     Set depfile target.
+ * @details   Configures the target written as the depfile rule output instead of the output files.
+ * @param[in] options Target options.
+ * @param[in] target Depfile target (null to use output files).
+ * @sa        ::idl_options_get_depfile_target
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_depfile_target(idl_options_t options,
+                               idl_utf8_t target);
+
+/**
+ * @brief      Get the current trace callback.
+ * @details    Returns a callback if one has been configured.
+ * @param[in]  options Target options.
+ * @param[out] data Returning a callback user data pointer (may be null).
+ * @return     Returns a callback.
+ * @sa         ::idl_options_set_tracer
+ * @ingroup    functions
+ */
+idl_api idl_trace_callback_t
+idl_options_get_tracer(idl_options_t options,
+                       idl_data_t* data);
+
+/**
+ * @brief     Set trace callback.
+ * @details   Configures a callback to receive scoped trace events for the compilation, each imported
+ *            file, each semantic pass and each generator function.
+ * @param[in] options Target options.
+ * @param[in] callback Callback function (null to disable).
+ * @param[in] data Callback user data.
+ * @note      Tracing is disabled when the callback is null, in which case events are not timed.
+ * @sa        ::idl_options_get_tracer
+ * @ingroup   functions
+ */
+idl_api void
+idl_options_set_tracer(idl_options_t options,
+                       idl_trace_callback_t callback,
+                       idl_data_t data);
+
 /** @} */
 
 IDL_END
@@ -185,6 +185,29 @@ typedef struct
     idl_uint32_t column; /**< The column in which the warning or error was detected. */
 } idl_message_t;
 
+/**
+ * @brief   Compilation phase timing.
+ * @details Wall-clock time spent in one phase of compilation.
+ * @ingroup structs
+ */
+typedef struct
+{
+    idl_utf8_t    name; /**< Phase name. */
+    idl_float64_t milliseconds; /**< Elapsed time in milliseconds. */
+} idl_phase_time_t;
+
+/**
+ * @brief   Compilation statistics.
+ * @details Size of the syntax tree built during compilation.
+ * @ingroup structs
+ */
+typedef struct
+{
+    idl_uint32_t node_count; /**< Number of declarations in the syntax tree. */
+    idl_uint32_t symbol_count; /**< Number of declarations registered in the symbol table. */
+    idl_uint64_t arena_bytes; /**< Peak number of bytes allocated in the syntax tree arena. */
+} idl_stats_t;
+
 /**
  * @brief     Converts error code to descriptive string.
  * @details   Provides a text description for the result code.
@@ -255,6 +278,61 @@ idl_compilation_result_get_messages(idl_compilation_result_t compilation_result,
                                     idl_uint32_t* message_count,
                                     idl_message_t* messages);
 
+/**
+ * @brief         Returns output files written to disk.
+ * @details       Returns paths of output files that were written during compilation. If
+ *                ::idl_options_set_write_if_changed is enabled, files whose content has not changed are not included.
+ * @param[in]     compilation_result Target compilation result instance.
+ * @param[in,out] file_count Number of files.
+ * @param[out]    files Paths of changed files.
+ * @note          Output passed to the ::idl_options_set_writer callback is not reported.
+ * @ingroup       functions
+ */
+idl_api void
+idl_compilation_result_get_changed_files(idl_compilation_result_t compilation_result,
+                                         idl_uint32_t* file_count,
+                                         idl_utf8_t* files);
+
+/**
+ * @brief         Returns source files read from disk.
+ * @details       Returns paths of the input file and all imports resolved from the file system, in the order
+ *                they were imported. If compilation stopped on an error, files imported up to the error are returned.
+ * @param[in]     compilation_result Target compilation result instance.
+ * @param[in,out] file_count Number of files.
+ * @param[out]    files Paths of source files.
+ * @note          Sources from ::idl_options_set_importer and in-memory sources are not reported.
+ * @ingroup       functions
+ */
+idl_api void
+idl_compilation_result_get_dependencies(idl_compilation_result_t compilation_result,
+                                        idl_uint32_t* file_count,
+                                        idl_utf8_t* files);
+
+/**
+ * @brief         Returns compilation phase timings.
+ * @details       Returns phases in the order they were completed: parsing, each semantic pass, each generator and
+ *                generator stages. Generator stages may complete concurrently when several generators are used.
+ * @param[in]     compilation_result Target compilation result instance.
+ * @param[in,out] phase_count Number of phases.
+ * @param[out]    phases Phase timing array.
+ * @note          Results replayed from the ::idl_options_set_compile_cache cache have no phases.
+ * @ingroup       functions
+ */
+idl_api void
+idl_compilation_result_get_phase_times(idl_compilation_result_t compilation_result,
+                                       idl_uint32_t* phase_count,
+                                       idl_phase_time_t* phases);
+
+/**
+ * @brief     Returns compilation statistics.
+ * @details   Returns the size of the syntax tree built during compilation.
+ * @param[in] compilation_result Target compilation result instance.
+ * @return    Compilation statistics.
+ * @ingroup   functions
+ */
+idl_api const idl_stats_t*
+idl_compilation_result_get_stats(idl_compilation_result_t compilation_result);
+
 /** @} */
 
 IDL_END
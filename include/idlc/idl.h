@@ -53,6 +53,18 @@ typedef enum
     IDL_GENERATOR_MAX_ENUM    = 0x7FFFFFFF /**< Max value of enum (not used) */
 } idl_generator_t;
 
+/**
+ * @brief   Compilation job.
+ * @details Describes one compilation of a batch passed to ::idl_compiler_compile_batch.
+ * @ingroup structs
+ */
+typedef struct
+{
+    idl_generator_t generator; /**< Target of generator. */
+    idl_utf8_t      file; /**< Path to .idl file for compile. */
+    idl_options_t   options; /**< Compile options, may be null. */
+} idl_compile_job_t;
+
 /**
  * @brief   Current library version as packed 32-bit value.
  * @details Format: (major << 16) | (minor << 8) | micro.
@@ -127,9 +139,14 @@ idl_compiler_destroy(idl_compiler_t compiler);
  *             - ::idl_options_set_importer - import callback if specified;
  *             - *sources* - then the source code array, if specified;
  *             - ::idl_options_set_import_dirs - then in the paths to the import directories, if specified;
- *             - then the current working directory.
+ *             - then the directory of *file*, or ::idl_options_set_base_dir (the current working directory if not set).
  *             
  * @endparblock
+ * @parblock
+ * @note       One compiler may be used by several threads at once. The options passed to concurrent
+ *             compilations must not be modified while they run, and their callbacks must be thread-safe
+ *             if the options are shared.
+ * @endparblock
  * @ingroup    functions
  */
 idl_api idl_result_t
@@ -141,6 +158,90 @@ idl_compiler_compile(idl_compiler_t compiler,
                      idl_options_t options,
                      idl_compilation_result_t* result);
 
+/**
+ * @brief      Compile IDL for several generators.
+ * @details    Parses and validates the sources once, then runs each generator from *generators* on the
+ *             same declarations. Independent generators run in parallel threads.
+ * @param[in]  compiler Target compiler.
+ * @param[in]  generator_count Number of generators.
+ * @param[in]  generators Targets of generators.
+ * @param[in]  file Path to .idl file for compile.
+ * @param[in]  source_count Number of sources.
+ * @param[in]  sources Sources.
+ * @param[in]  options Compile options, may be null.
+ * @param[out] result Compilation result.
+ * @return     Compilation result.
+ * @note       If a writer is set with ::idl_options_set_writer, it is called from the calling thread after all
+ *             generators are finished, in the order of *generators*.
+ * @sa         ::idl_compiler_compile
+ * @ingroup    functions
+ */
+idl_api idl_result_t
+idl_compiler_compile_multi(idl_compiler_t compiler,
+                           idl_uint32_t generator_count,
+                           const idl_generator_t* generators,
+                           idl_utf8_t file,
+                           idl_uint32_t source_count,
+                           const idl_source_t* sources,
+                           idl_options_t options,
+                           idl_compilation_result_t* result);
+
+/**
+ * @brief      Compile several IDL files.
+ * @details    Compiles each job of *jobs* as ::idl_compiler_compile would, using a pool of worker threads. Jobs
+ *             share the import directory index and the compile cache of the compiler, and an import used by
+ *             several jobs is lexed once. The batch uses as many threads as the largest number of jobs of its
+ *             options (see ::idl_options_set_jobs), and each job is compiled on a single thread.
+ * @param[in]  compiler Target compiler.
+ * @param[in]  job_count Number of jobs.
+ * @param[in]  jobs Jobs to compile.
+ * @param[out] results Compilation result of each job.
+ * @return     Result of the first failed job in the order of *jobs*, or success.
+ * @note       Callbacks of job options (importer, writer, tracer) may be called concurrently from
+ *             several threads. Each job receives its own compilation result.
+ * @sa         ::idl_compiler_compile
+ * @ingroup    functions
+ */
+idl_api idl_result_t
+idl_compiler_compile_batch(idl_compiler_t compiler,
+                           idl_uint32_t job_count,
+                           const idl_compile_job_t* jobs,
+                           idl_compilation_result_t* results);
+
+/**
+ * @brief     Invalidate compile cache.
+ * @details   Removes cached compilations that depend on *file*, or all cached compilations if *file* is null.
+ * @param[in] compiler Target compiler.
+ * @param[in] file Path to changed .idl file, may be null.
+ * @sa        ::idl_options_set_compile_cache
+ * @ingroup   functions
+ */
+idl_api void
+idl_compiler_invalidate_cache(idl_compiler_t compiler,
+                              idl_utf8_t file);
+
+/**
+ * @brief     Number of cache hits.
+ * @details   Returns the number of compilations whose outputs were taken from the compile cache.
+ * @param[in] compiler Target compiler.
+ * @return    Number of cache hits.
+ * @sa        ::idl_options_set_compile_cache
+ * @ingroup   functions
+ */
+idl_api idl_uint32_t
+idl_compiler_get_cache_hits(idl_compiler_t compiler);
+
+/**
+ * @brief     Number of cache misses.
+ * @details   Returns the number of compilations performed with the compile cache enabled that were not found in it.
+ * @param[in] compiler Target compiler.
+ * @return    Number of cache misses.
+ * @sa        ::idl_options_set_compile_cache
+ * @ingroup   functions
+ */
+idl_api idl_uint32_t
+idl_compiler_get_cache_misses(idl_compiler_t compiler);
+
 /** @} */
 
 IDL_END
@@ -0,0 +1,63 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "idl.hpp"
+
+namespace idl {
+
+class Arena final : public std::pmr::memory_resource {
+public:
+    class Scope final {
+    public:
+        explicit Scope(Arena& arena) noexcept : _prev(_current) {
+            _current = &arena;
+        }
+
+        ~Scope() {
+            _current = _prev;
+        }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* _prev;
+    };
+
+    explicit Arena(size_t initialSize = 64 * 1024) : _resource(initialSize) {
+    }
+
+    Arena(const Arena&)            = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    size_t bytesUsed() const noexcept {
+        return _bytesUsed;
+    }
+
+    static std::pmr::memory_resource* current() noexcept {
+        return _current ? _current : std::pmr::get_default_resource();
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto ptr = _resource.allocate(bytes, alignment);
+        _bytesUsed += bytes;
+        return ptr;
+    }
+
+    void do_deallocate(void*, size_t, size_t) noexcept override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource _resource;
+    size_t _bytesUsed{};
+
+    static inline thread_local Arena* _current{};
+};
+
+} // namespace idl
+
+#endif
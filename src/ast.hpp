@@ -1,77 +1,213 @@
 #ifndef AST_HPP
 #define AST_HPP
 
-#include "idl.hpp"
+#include "arena.hpp"
 #include "location.hh"
 
 namespace idl {
 
 struct Visitor;
 
+enum class ASTKind : uint8_t {
+    LiteralBool,
+    LiteralInt,
+    LiteralConsts,
+    LiteralStr,
+    Doc,
+    AttrPlatform,
+    AttrFlags,
+    AttrHex,
+    AttrValue,
+    AttrType,
+    AttrStatic,
+    AttrCtor,
+    AttrThis,
+    AttrGet,
+    AttrSet,
+    AttrHandle,
+    AttrCName,
+    AttrArray,
+    AttrDataSize,
+    AttrConst,
+    AttrRef,
+    AttrRefInc,
+    AttrUserData,
+    AttrErrorCode,
+    AttrNoError,
+    AttrResult,
+    AttrDestroy,
+    AttrIn,
+    AttrOut,
+    AttrOptional,
+    AttrTokenizer,
+    AttrVersion,
+    Year,
+    Major,
+    Minor,
+    Micro,
+    DocBool,
+    Int8,
+    Uint8,
+    Int16,
+    Uint16,
+    Int32,
+    Uint32,
+    Int64,
+    Uint64,
+    Float32,
+    Float64,
+    Void,
+    Char,
+    Str,
+    Bool,
+    Data,
+    ConstData,
+    Enum,
+    Struct,
+    Interface,
+    Handle,
+    Callback,
+    EnumConst,
+    Field,
+    Arg,
+    Method,
+    Property,
+    Event,
+    Func,
+    File,
+    Api,
+    DeclRef
+};
+
+template <typename T>
+using ASTVector = std::pmr::vector<T>;
+using ASTString = std::pmr::string;
+
 struct ASTNode {
+    static constexpr auto kindFirst = ASTKind::LiteralBool;
+    static constexpr auto kindLast  = ASTKind::DeclRef;
+
     virtual ~ASTNode() = default;
 
     virtual void accept(Visitor& visitor) = 0;
 
     template <typename Node>
-    bool is() noexcept {
+    bool is() const noexcept {
         static_assert(std::is_base_of<ASTNode, Node>::value, "Node must be inherited from ASTNode");
-        return dynamic_cast<Node*>(this) != nullptr;
+        return kind >= Node::kindFirst && kind <= Node::kindLast;
     }
 
     template <typename Node>
     Node* as() noexcept {
         static_assert(std::is_base_of<ASTNode, Node>::value, "Node must be inherited from ASTNode");
-        return dynamic_cast<Node*>(this);
+        return is<Node>() ? static_cast<Node*>(this) : nullptr;
     }
 
+    const ASTKind kind;
     ASTNode* parent{};
     idl::location location{};
+
+protected:
+    explicit ASTNode(ASTKind kind) noexcept : kind(kind) {
+    }
 };
 
-struct ASTLiteral : ASTNode {};
+struct ASTLiteral : ASTNode {
+    static constexpr auto kindFirst = ASTKind::LiteralBool;
+    static constexpr auto kindLast  = ASTKind::LiteralStr;
+
+protected:
+    using ASTNode::ASTNode;
+};
 
 struct ASTLiteralBool : ASTLiteral {
+    static constexpr auto kindFirst = ASTKind::LiteralBool;
+    static constexpr auto kindLast  = ASTKind::LiteralBool;
+
+    ASTLiteralBool() : ASTLiteral(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    bool value;
+    bool value{};
 };
 
 struct ASTLiteralInt : ASTLiteral {
+    static constexpr auto kindFirst = ASTKind::LiteralInt;
+    static constexpr auto kindLast  = ASTKind::LiteralInt;
+
+    ASTLiteralInt() : ASTLiteral(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    int64_t value;
+    int64_t value{};
 };
 
 struct ASTLiteralConsts : ASTLiteral {
+    static constexpr auto kindFirst = ASTKind::LiteralConsts;
+    static constexpr auto kindLast  = ASTKind::LiteralConsts;
+
+    ASTLiteralConsts() : ASTLiteral(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<struct ASTDeclRef*> decls;
+    ASTVector<struct ASTDeclRef*> decls{ Arena::current() };
 };
 
 struct ASTLiteralStr : ASTLiteral {
+    static constexpr auto kindFirst = ASTKind::LiteralStr;
+    static constexpr auto kindLast  = ASTKind::LiteralStr;
+
+    ASTLiteralStr() : ASTLiteral(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::string value;
+    ASTString value{ Arena::current() };
 };
 
 struct ASTDoc : ASTNode {
+    static constexpr auto kindFirst = ASTKind::Doc;
+    static constexpr auto kindLast  = ASTKind::Doc;
+
+    ASTDoc() : ASTNode(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTNode*> brief;
-    std::vector<ASTNode*> detail;
-    std::vector<ASTNode*> ret;
-    std::vector<ASTNode*> copyright;
-    std::vector<ASTNode*> license;
-    std::vector<std::vector<ASTNode*>> authors;
-    std::vector<std::vector<ASTNode*>> see;
-    std::vector<std::vector<ASTNode*>> note;
-    std::vector<std::vector<ASTNode*>> warn;
+    ASTVector<ASTNode*> brief{ Arena::current() };
+    ASTVector<ASTNode*> detail{ Arena::current() };
+    ASTVector<ASTNode*> ret{ Arena::current() };
+    ASTVector<ASTNode*> copyright{ Arena::current() };
+    ASTVector<ASTNode*> license{ Arena::current() };
+    ASTVector<ASTVector<ASTNode*>> authors{ Arena::current() };
+    ASTVector<ASTVector<ASTNode*>> see{ Arena::current() };
+    ASTVector<ASTVector<ASTNode*>> note{ Arena::current() };
+    ASTVector<ASTVector<ASTNode*>> warn{ Arena::current() };
 };
 
-struct ASTAttr : ASTNode {};
+struct ASTAttr : ASTNode {
+    static constexpr auto kindFirst = ASTKind::AttrPlatform;
+    static constexpr auto kindLast  = ASTKind::AttrVersion;
+    static constexpr auto kindCount = size_t(kindLast) - size_t(kindFirst) + 1;
+
+    static constexpr size_t index(ASTKind kind) noexcept {
+        return size_t(kind) - size_t(kindFirst);
+    }
+
+protected:
+    using ASTNode::ASTNode;
+};
 
 struct ASTAttrPlatform : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrPlatform;
+    static constexpr auto kindLast  = ASTKind::AttrPlatform;
+
+    ASTAttrPlatform() : ASTAttr(kindFirst) {
+    }
+
     enum Type {
         Windows = 1,
         Linux   = 2,
@@ -83,64 +219,136 @@ struct ASTAttrPlatform : ASTAttr {
 
     void accept(Visitor& visitor) override;
 
-    Type platforms;
+    Type platforms{};
 };
 
 struct ASTAttrFlags : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrFlags;
+    static constexpr auto kindLast  = ASTKind::AttrFlags;
+
+    ASTAttrFlags() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrHex : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrHex;
+    static constexpr auto kindLast  = ASTKind::AttrHex;
+
+    ASTAttrHex() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrValue : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrValue;
+    static constexpr auto kindLast  = ASTKind::AttrValue;
+
+    ASTAttrValue() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    ASTLiteral* value;
+    ASTLiteral* value{};
 };
 
 struct ASTAttrType : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrType;
+    static constexpr auto kindLast  = ASTKind::AttrType;
+
+    ASTAttrType() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    struct ASTDeclRef* type;
+    struct ASTDeclRef* type{};
 };
 
 struct ASTAttrStatic : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrStatic;
+    static constexpr auto kindLast  = ASTKind::AttrStatic;
+
+    ASTAttrStatic() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrCtor : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrCtor;
+    static constexpr auto kindLast  = ASTKind::AttrCtor;
+
+    ASTAttrCtor() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrThis : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrThis;
+    static constexpr auto kindLast  = ASTKind::AttrThis;
+
+    ASTAttrThis() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrGet : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrGet;
+    static constexpr auto kindLast  = ASTKind::AttrGet;
+
+    ASTAttrGet() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     struct ASTDeclRef* decl{};
 };
 
 struct ASTAttrSet : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrSet;
+    static constexpr auto kindLast  = ASTKind::AttrSet;
+
+    ASTAttrSet() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     struct ASTDeclRef* decl{};
 };
 
 struct ASTAttrHandle : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrHandle;
+    static constexpr auto kindLast  = ASTKind::AttrHandle;
+
+    ASTAttrHandle() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrCName : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrCName;
+    static constexpr auto kindLast  = ASTKind::AttrCName;
+
+    ASTAttrCName() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::string name;
+    ASTString name{ Arena::current() };
 };
 
 struct ASTAttrArray : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrArray;
+    static constexpr auto kindLast  = ASTKind::AttrArray;
+
+    ASTAttrArray() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     bool ref{};
@@ -149,62 +357,146 @@ struct ASTAttrArray : ASTAttr {
 };
 
 struct ASTAttrDataSize : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrDataSize;
+    static constexpr auto kindLast  = ASTKind::AttrDataSize;
+
+    ASTAttrDataSize() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     struct ASTDeclRef* decl{};
 };
 
 struct ASTAttrConst : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrConst;
+    static constexpr auto kindLast  = ASTKind::AttrConst;
+
+    ASTAttrConst() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrRef : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrRef;
+    static constexpr auto kindLast  = ASTKind::AttrRef;
+
+    ASTAttrRef() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrRefInc : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrRefInc;
+    static constexpr auto kindLast  = ASTKind::AttrRefInc;
+
+    ASTAttrRefInc() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrUserData : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrUserData;
+    static constexpr auto kindLast  = ASTKind::AttrUserData;
+
+    ASTAttrUserData() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrErrorCode : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrErrorCode;
+    static constexpr auto kindLast  = ASTKind::AttrErrorCode;
+
+    ASTAttrErrorCode() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrNoError : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrNoError;
+    static constexpr auto kindLast  = ASTKind::AttrNoError;
+
+    ASTAttrNoError() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrResult : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrResult;
+    static constexpr auto kindLast  = ASTKind::AttrResult;
+
+    ASTAttrResult() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrDestroy : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrDestroy;
+    static constexpr auto kindLast  = ASTKind::AttrDestroy;
+
+    ASTAttrDestroy() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrIn : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrIn;
+    static constexpr auto kindLast  = ASTKind::AttrIn;
+
+    ASTAttrIn() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrOut : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrOut;
+    static constexpr auto kindLast  = ASTKind::AttrOut;
+
+    ASTAttrOut() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrOptional : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrOptional;
+    static constexpr auto kindLast  = ASTKind::AttrOptional;
+
+    ASTAttrOptional() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTAttrTokenizer : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrTokenizer;
+    static constexpr auto kindLast  = ASTKind::AttrTokenizer;
+
+    ASTAttrTokenizer() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<int> nums;
+    ASTVector<int> nums{ Arena::current() };
 };
 
 struct ASTAttrVersion : ASTAttr {
+    static constexpr auto kindFirst = ASTKind::AttrVersion;
+    static constexpr auto kindLast  = ASTKind::AttrVersion;
+
+    ASTAttrVersion() : ASTAttr(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     int major{};
@@ -213,154 +505,360 @@ struct ASTAttrVersion : ASTAttr {
 };
 
 struct ASTDecl : ASTNode {
-    std::string name;
-    std::vector<ASTAttr*> attrs;
+    static constexpr auto kindFirst = ASTKind::Year;
+    static constexpr auto kindLast  = ASTKind::Api;
+
+    ASTString name{ Arena::current() };
+    ASTVector<ASTAttr*> attrs{ Arena::current() };
     ASTDoc* doc{};
     struct ASTFile* file{};
+    uint32_t nameId{};
+    uint32_t scopeId{};
+
+    // Attributes are indexed by kind, so they must be added with addAttr.
+    // Returns false if the declaration already has an attribute of the kind.
+    bool addAttr(ASTAttr* attr) {
+        assert(attr->is<ASTAttr>() && attrs.size() < std::numeric_limits<uint8_t>::max());
+        const auto index = ASTAttr::index(attr->kind);
+        if (_attrMask & (uint32_t(1) << index)) {
+            return false;
+        }
+        _attrMask |= uint32_t(1) << index;
+        _attrIndex[index] = uint8_t(attrs.size());
+        attrs.push_back(attr);
+        return true;
+    }
 
     template <typename Attr>
     Attr* findAttr() noexcept {
         static_assert(std::is_base_of<ASTAttr, Attr>::value, "Attr must be inherited from ASTAttr");
-        auto it = std::find_if(attrs.begin(), attrs.end(), [](auto attr) {
-            return typeid(*attr) == typeid(Attr);
-        });
-        return it != attrs.end() ? (*it)->template as<Attr>() : nullptr;
-    }
-
-    std::string fullname() const {
-        assert(name.length() > 0);
-        std::string str{};
-        if (parent) {
-            if (auto parentDecl = parent->as<ASTDecl>()) {
-                str = parentDecl->fullname() + '.';
+        static_assert(Attr::kindFirst == Attr::kindLast, "Attr must be a concrete attribute");
+        constexpr auto index = ASTAttr::index(Attr::kindFirst);
+        return _attrMask & (uint32_t(1) << index) ? static_cast<Attr*>(attrs[_attrIndex[index]]) : nullptr;
+    }
+
+    std::string_view fullname() const {
+        if (_fullname.empty()) {
+            assert(name.length() > 0);
+            if (parent) {
+                if (auto parentDecl = parent->as<ASTDecl>()) {
+                    _fullname.append(parentDecl->fullname()).append(1, '.');
+                }
             }
+            _fullname.append(name);
+            _fullnameLower.assign(_fullname);
+            std::transform(_fullnameLower.begin(), _fullnameLower.end(), _fullnameLower.begin(), [](auto c) {
+                return std::tolower(c);
+            });
         }
-        return str + name;
+        return _fullname;
     }
 
-    std::string fullnameLowecase() const {
-        auto str = fullname();
-        std::transform(str.begin(), str.end(), str.begin(), [](auto c) {
-            return std::tolower(c);
-        });
-        return str;
+    std::string_view fullnameLowecase() const {
+        fullname();
+        return _fullnameLower;
     }
+
+protected:
+    using ASTNode::ASTNode;
+
+private:
+    static_assert(ASTAttr::kindCount <= 32, "attribute kinds must fit in the mask");
+
+    uint32_t _attrMask{};
+    std::array<uint8_t, ASTAttr::kindCount> _attrIndex{};
+    mutable ASTString _fullname{ Arena::current() };
+    mutable ASTString _fullnameLower{ Arena::current() };
 };
 
-struct ASTDocDecl : ASTDecl {};
+struct ASTDocDecl : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Year;
+    static constexpr auto kindLast  = ASTKind::DocBool;
+
+protected:
+    using ASTDecl::ASTDecl;
+};
 
 struct ASTYear : ASTDocDecl {
+    static constexpr auto kindFirst = ASTKind::Year;
+    static constexpr auto kindLast  = ASTKind::Year;
+
+    ASTYear() : ASTDocDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     int value{};
 };
 
 struct ASTMajor : ASTDocDecl {
+    static constexpr auto kindFirst = ASTKind::Major;
+    static constexpr auto kindLast  = ASTKind::Major;
+
+    ASTMajor() : ASTDocDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     int value{};
 };
 
 struct ASTMinor : ASTDocDecl {
+    static constexpr auto kindFirst = ASTKind::Minor;
+    static constexpr auto kindLast  = ASTKind::Minor;
+
+    ASTMinor() : ASTDocDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     int value{};
 };
 
 struct ASTMicro : ASTDocDecl {
+    static constexpr auto kindFirst = ASTKind::Micro;
+    static constexpr auto kindLast  = ASTKind::Micro;
+
+    ASTMicro() : ASTDocDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     int value{};
 };
 
 struct ASTDocBool : ASTDocDecl {
+    static constexpr auto kindFirst = ASTKind::DocBool;
+    static constexpr auto kindLast  = ASTKind::DocBool;
+
+    ASTDocBool() : ASTDocDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     bool value{};
 };
 
 struct ASTDeclRef : ASTNode {
+    static constexpr auto kindFirst = ASTKind::DeclRef;
+    static constexpr auto kindLast  = ASTKind::DeclRef;
+
+    ASTDeclRef() : ASTNode(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::string name;
+    ASTString name{ Arena::current() };
     ASTDecl* decl{};
 };
 
-struct ASTType : ASTDecl {};
+struct ASTType : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Int8;
+    static constexpr auto kindLast  = ASTKind::Callback;
+
+protected:
+    using ASTDecl::ASTDecl;
+};
+
+struct ASTTrivialType : ASTType {
+    static constexpr auto kindFirst = ASTKind::Int8;
+    static constexpr auto kindLast  = ASTKind::ConstData;
+
+protected:
+    using ASTType::ASTType;
+};
+
+struct ASTBuiltinType : ASTTrivialType {
+    static constexpr auto kindFirst = ASTKind::Int8;
+    static constexpr auto kindLast  = ASTKind::ConstData;
 
-struct ASTTrivialType : ASTType {};
+protected:
+    using ASTTrivialType::ASTTrivialType;
+};
+
+struct ASTIntegerType : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Int8;
+    static constexpr auto kindLast  = ASTKind::Uint64;
 
-struct ASTBuiltinType : ASTTrivialType {};
+protected:
+    using ASTBuiltinType::ASTBuiltinType;
+};
 
-struct ASTIntegerType : ASTBuiltinType {};
+struct ASTFloatType : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Float32;
+    static constexpr auto kindLast  = ASTKind::Float64;
 
-struct ASTFloatType : ASTBuiltinType {};
+protected:
+    using ASTBuiltinType::ASTBuiltinType;
+};
 
 struct ASTVoid : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Void;
+    static constexpr auto kindLast  = ASTKind::Void;
+
+    ASTVoid() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTChar : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Char;
+    static constexpr auto kindLast  = ASTKind::Char;
+
+    ASTChar() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTStr : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Str;
+    static constexpr auto kindLast  = ASTKind::Str;
+
+    ASTStr() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTBool : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Bool;
+    static constexpr auto kindLast  = ASTKind::Bool;
+
+    ASTBool() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTInt8 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Int8;
+    static constexpr auto kindLast  = ASTKind::Int8;
+
+    ASTInt8() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTUint8 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Uint8;
+    static constexpr auto kindLast  = ASTKind::Uint8;
+
+    ASTUint8() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTInt16 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Int16;
+    static constexpr auto kindLast  = ASTKind::Int16;
+
+    ASTInt16() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTUint16 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Uint16;
+    static constexpr auto kindLast  = ASTKind::Uint16;
+
+    ASTUint16() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTInt32 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Int32;
+    static constexpr auto kindLast  = ASTKind::Int32;
+
+    ASTInt32() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTUint32 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Uint32;
+    static constexpr auto kindLast  = ASTKind::Uint32;
+
+    ASTUint32() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTInt64 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Int64;
+    static constexpr auto kindLast  = ASTKind::Int64;
+
+    ASTInt64() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTUint64 : ASTIntegerType {
+    static constexpr auto kindFirst = ASTKind::Uint64;
+    static constexpr auto kindLast  = ASTKind::Uint64;
+
+    ASTUint64() : ASTIntegerType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTFloat32 : ASTFloatType {
+    static constexpr auto kindFirst = ASTKind::Float32;
+    static constexpr auto kindLast  = ASTKind::Float32;
+
+    ASTFloat32() : ASTFloatType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTFloat64 : ASTFloatType {
+    static constexpr auto kindFirst = ASTKind::Float64;
+    static constexpr auto kindLast  = ASTKind::Float64;
+
+    ASTFloat64() : ASTFloatType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTData : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::Data;
+    static constexpr auto kindLast  = ASTKind::Data;
+
+    ASTData() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTConstData : ASTBuiltinType {
+    static constexpr auto kindFirst = ASTKind::ConstData;
+    static constexpr auto kindLast  = ASTKind::ConstData;
+
+    ASTConstData() : ASTBuiltinType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTEnumConst : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::EnumConst;
+    static constexpr auto kindLast  = ASTKind::EnumConst;
+
+    ASTEnumConst() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
     bool evaluated{};
@@ -368,79 +866,157 @@ struct ASTEnumConst : ASTDecl {
 };
 
 struct ASTEnum : ASTType {
+    static constexpr auto kindFirst = ASTKind::Enum;
+    static constexpr auto kindLast  = ASTKind::Enum;
+
+    ASTEnum() : ASTType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTEnumConst*> consts;
+    ASTVector<ASTEnumConst*> consts{ Arena::current() };
 };
 
 struct ASTField : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Field;
+    static constexpr auto kindLast  = ASTKind::Field;
+
+    ASTField() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTStruct : ASTType {
+    static constexpr auto kindFirst = ASTKind::Struct;
+    static constexpr auto kindLast  = ASTKind::Struct;
+
+    ASTStruct() : ASTType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTField*> fields;
+    ASTVector<ASTField*> fields{ Arena::current() };
 };
 
 struct ASTArg : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Arg;
+    static constexpr auto kindLast  = ASTKind::Arg;
+
+    ASTArg() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTMethod : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Method;
+    static constexpr auto kindLast  = ASTKind::Method;
+
+    ASTMethod() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTArg*> args;
+    ASTVector<ASTArg*> args{ Arena::current() };
 };
 
 struct ASTProperty : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Property;
+    static constexpr auto kindLast  = ASTKind::Property;
+
+    ASTProperty() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTEvent : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Event;
+    static constexpr auto kindLast  = ASTKind::Event;
+
+    ASTEvent() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTInterface : ASTType {
+    static constexpr auto kindFirst = ASTKind::Interface;
+    static constexpr auto kindLast  = ASTKind::Interface;
+
+    ASTInterface() : ASTType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTMethod*> methods;
-    std::vector<ASTProperty*> props;
-    std::vector<ASTEvent*> events;
+    ASTVector<ASTMethod*> methods{ Arena::current() };
+    ASTVector<ASTProperty*> props{ Arena::current() };
+    ASTVector<ASTEvent*> events{ Arena::current() };
 };
 
 struct ASTHandle : ASTType {
+    static constexpr auto kindFirst = ASTKind::Handle;
+    static constexpr auto kindLast  = ASTKind::Handle;
+
+    ASTHandle() : ASTType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 };
 
 struct ASTFunc : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Func;
+    static constexpr auto kindLast  = ASTKind::Func;
+
+    ASTFunc() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTArg*> args;
+    ASTVector<ASTArg*> args{ Arena::current() };
 };
 
 struct ASTCallback : ASTType {
+    static constexpr auto kindFirst = ASTKind::Callback;
+    static constexpr auto kindLast  = ASTKind::Callback;
+
+    ASTCallback() : ASTType(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTArg*> args;
+    ASTVector<ASTArg*> args{ Arena::current() };
 };
 
 struct ASTFile : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::File;
+    static constexpr auto kindLast  = ASTKind::File;
+
+    ASTFile() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTDecl*> decls;
+    ASTVector<ASTDecl*> decls{ Arena::current() };
 };
 
 struct ASTApi : ASTDecl {
+    static constexpr auto kindFirst = ASTKind::Api;
+    static constexpr auto kindLast  = ASTKind::Api;
+
+    ASTApi() : ASTDecl(kindFirst) {
+    }
+
     void accept(Visitor& visitor) override;
 
-    std::vector<ASTEnum*> enums;
-    std::vector<ASTStruct*> structs;
-    std::vector<ASTCallback*> callbacks;
-    std::vector<ASTFunc*> funcs;
-    std::vector<ASTInterface*> interfaces;
-    std::vector<ASTHandle*> handles;
-    std::vector<ASTFile*> files;
+    ASTVector<ASTEnum*> enums{ Arena::current() };
+    ASTVector<ASTStruct*> structs{ Arena::current() };
+    ASTVector<ASTCallback*> callbacks{ Arena::current() };
+    ASTVector<ASTFunc*> funcs{ Arena::current() };
+    ASTVector<ASTInterface*> interfaces{ Arena::current() };
+    ASTVector<ASTHandle*> handles{ Arena::current() };
+    ASTVector<ASTFile*> files{ Arena::current() };
 };
 
 struct Visitor {
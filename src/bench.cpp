@@ -0,0 +1,849 @@
+#include "output_sink.hpp"
+
+#include <idlc/idl.h>
+
+#include <argparse/argparse.hpp>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+// Every allocation of the process is counted, including those made inside the
+// idl library (it is linked statically into the benchmark by default).
+static std::atomic<uint64_t> allocations{};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignment = std::max(size_t(align), sizeof(void*));
+    size           = (std::max(size, size_t(1)) + alignment - 1) / alignment * alignment;
+#ifdef _MSC_VER
+    auto ptr = _aligned_malloc(size, alignment);
+#else
+    auto ptr = std::aligned_alloc(alignment, size);
+#endif
+    if (ptr) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t align) noexcept {
+    operator delete(ptr, align);
+}
+
+struct Shape {
+    int depth      = 2;
+    int fanout     = 2;
+    int enums      = 8;
+    int consts     = 16;
+    int structs    = 8;
+    int fields     = 8;
+    int interfaces = 4;
+    int methods    = 8;
+    int props      = 4;
+    int events     = 2;
+    int docLines   = 1;
+};
+
+struct Corpus {
+    std::vector<std::string> names;
+    std::vector<std::string> datas;
+    size_t bytes;
+};
+
+static void doc(std::string& out, int indent, std::string_view brief, int lines) {
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "{:{}}@ {}\n", "", indent, brief);
+    if (lines <= 1) {
+        fmt::format_to(it, "{:{}}@ Synthetic declaration generated by idlc-bench. [detail]\n", "", indent);
+        return;
+    }
+    fmt::format_to(it, "{:{}}@ ```\n", "", indent);
+    for (int i = 1; i < lines; ++i) {
+        fmt::format_to(
+            it, "{:{}}Line {} of the detailed description of a synthetic declaration. \n", "", indent + 4, i);
+    }
+    fmt::format_to(it, "{:{}}Generated by idlc-bench.``` [detail]\n", "", indent + 4);
+}
+
+static void generateModule(std::string& out, const Shape& shape, int index, int files) {
+    auto it = std::back_inserter(out);
+    for (int i = 1; i <= shape.fanout; ++i) {
+        const auto child = index * shape.fanout + i;
+        if (child < files) {
+            doc(out, 0, fmt::format("Module {}.", child), shape.docLines);
+            fmt::format_to(it, "import M{}\n\n", child);
+        }
+    }
+    for (int e = 0; e < shape.enums; ++e) {
+        doc(out, 0, fmt::format("Enumeration {}.", e), shape.docLines);
+        fmt::format_to(it, "enum M{}Enum{}\n", index, e);
+        for (int c = 0; c < std::max(shape.consts, 1); ++c) {
+            fmt::format_to(it, "    const Value{} @ Value {}.\n", c, c);
+        }
+        out += '\n';
+    }
+    for (int s = 0; s < shape.structs; ++s) {
+        doc(out, 0, fmt::format("Structure {}.", s), shape.docLines);
+        fmt::format_to(it, "struct M{}Struct{}\n", index, s);
+        fmt::format_to(it, "    field Count {{Uint32}} @ Number of items.\n");
+        fmt::format_to(it, "    field Items {{Int32}} [const,array(Count)] @ Items.\n");
+        fmt::format_to(it, "    field Size {{Uint32}} @ Size of data in bytes.\n");
+        fmt::format_to(it, "    field Data {{Data}} [datasize(Size)] @ Data.\n");
+        for (int f = 0; f < shape.fields; ++f) {
+            fmt::format_to(it, "    field Field{} {{Float64}} @ Field {}.\n", f, f);
+        }
+        out += '\n';
+    }
+    for (int n = 0; n < shape.interfaces; ++n) {
+        const auto iface = fmt::format("M{}Object{}", index, n);
+        if (shape.events > 0) {
+            doc(out, 0, fmt::format("Callback of object {}.", n), shape.docLines);
+            fmt::format_to(it, "callback {}Handler\n", iface);
+            fmt::format_to(it, "    arg Value {{Int32}} @ New value.\n");
+            fmt::format_to(it, "    arg Data {{Data}} [userdata] @ User data.\n\n");
+        }
+        doc(out, 0, fmt::format("Object {}.", n), shape.docLines);
+        fmt::format_to(it, "interface {}\n", iface);
+        for (int p = 0; p < shape.props; ++p) {
+            fmt::format_to(it, "    prop Value{} [get(GetValue{}),set(SetValue{})] @ Property {}.\n", p, p, p, p);
+        }
+        for (int e = 0; e < shape.events; ++e) {
+            fmt::format_to(it, "    event Changed{} [get(GetChanged{}),set(SetChanged{})] @ Event {}.\n", e, e, e, e);
+        }
+        out += '\n';
+        doc(out, 4, "Increments reference count.", shape.docLines);
+        fmt::format_to(it, "    method Reference {{{}}} [refinc]\n", iface);
+        fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n\n", iface);
+        doc(out, 4, "Releases object.", shape.docLines);
+        fmt::format_to(it, "    method Destroy [destroy]\n");
+        fmt::format_to(it, "        arg Object {{{}}} [this] @ Object to destroy.\n\n", iface);
+        for (int p = 0; p < shape.props; ++p) {
+            doc(out, 4, fmt::format("Get value {}.", p), shape.docLines);
+            fmt::format_to(it, "    method GetValue{} {{Int32}} [const]\n", p);
+            fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n\n", iface);
+            doc(out, 4, fmt::format("Set value {}.", p), shape.docLines);
+            fmt::format_to(it, "    method SetValue{}\n", p);
+            fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n", iface);
+            fmt::format_to(it, "        arg Value {{Int32}} @ New value.\n\n");
+        }
+        for (int e = 0; e < shape.events; ++e) {
+            doc(out, 4, fmt::format("Get callback {}.", e), shape.docLines);
+            fmt::format_to(it, "    method GetChanged{} {{{}Handler}} [const]\n", e, iface);
+            fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n", iface);
+            fmt::format_to(it, "        arg Data {{Data}} [out,optional,userdata] @ User data.\n\n");
+            doc(out, 4, fmt::format("Set callback {}.", e), shape.docLines);
+            fmt::format_to(it, "    method SetChanged{}\n", e);
+            fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n", iface);
+            fmt::format_to(it, "        arg Callback {{{}Handler}} @ Callback function.\n", iface);
+            fmt::format_to(it, "        arg Data {{Data}} [optional,userdata] @ User data.\n\n");
+        }
+        for (int m = 0; m < shape.methods; ++m) {
+            doc(out, 4, fmt::format("Method {}.", m), shape.docLines);
+            fmt::format_to(it, "    method Call{} {{Int32}}\n", m);
+            fmt::format_to(it, "        arg Object {{{}}} [this] @ Target object.\n", iface);
+            fmt::format_to(it, "        arg Count {{Uint32}} @ Number of values.\n");
+            fmt::format_to(it, "        arg Values {{Int32}} [const,array(Count)] @ Values.\n\n");
+        }
+    }
+}
+
+static Corpus generateCorpus(const Shape& shape) {
+    int files = 0;
+    for (int level = 0, count = 1; level <= shape.depth; ++level, count *= std::max(shape.fanout, 1)) {
+        files += count;
+        if (shape.fanout < 1) {
+            break;
+        }
+    }
+    Corpus corpus{};
+    for (int i = 0; i < files; ++i) {
+        std::string data{};
+        if (i == 0) {
+            doc(data, 0, "Bench", shape.docLines);
+            data += "@ idlc-bench [author]\n";
+            data += "@ MIT License [copyright]\n";
+            data += "api Bench [version(1,0,0)]\n\n";
+        }
+        generateModule(data, shape, i, files);
+        corpus.bytes += data.size();
+        corpus.names.push_back(fmt::format("m{}.idl", i));
+        corpus.datas.push_back(std::move(data));
+    }
+    return corpus;
+}
+
+struct Phase {
+    std::string name;
+    std::string category;
+    double milliseconds;
+    uint64_t allocations;
+    bool sequential;
+};
+
+struct Run {
+    std::mutex mutex;
+    uint64_t start;
+    uint64_t last;
+    std::vector<Phase> phases;
+    uint64_t bytesOut;
+    uint32_t outputs;
+};
+
+static void trace(const idl_trace_event_t* event, idl_data_t data) {
+    auto run = static_cast<Run*>(data);
+    std::lock_guard lock(run->mutex);
+    // Top-level phases (parse, semantic passes, generators) do not overlap, so
+    // the allocations of each one are the difference to the previous top-level
+    // phase. Imports and generator stages are nested and only report time.
+    const std::string_view name = event->name;
+    const std::string_view cat  = event->category;
+    const auto now              = allocations.load(std::memory_order_relaxed);
+    const auto whole            = name == "compile";
+    const auto sequential       = !whole && cat != "import" && name.find('.') == std::string_view::npos;
+    uint64_t count{};
+    if (whole) {
+        count = now - run->start;
+    } else if (sequential) {
+        count     = now - run->last;
+        run->last = now;
+    }
+    run->phases.push_back({ event->name, event->category, event->duration / 1000.0, count, sequential || whole });
+}
+
+static void write(const idl_source_t* source, idl_data_t data) {
+    auto run = static_cast<Run*>(data);
+    std::lock_guard lock(run->mutex);
+    run->bytesOut += source->size;
+    ++run->outputs;
+}
+
+struct Result {
+    std::string generator;
+    bool supported;
+    double seconds;
+    uint32_t nodes;
+    uint32_t symbols;
+    uint64_t arenaBytes;
+    uint64_t bytesOut;
+    uint32_t outputs;
+    uint64_t allocations;
+    std::vector<Phase> phases;
+};
+
+static bool bench(idl_compiler_t compiler,
+                  idl_generator_t generator,
+                  const std::vector<idl_source_t>& sources,
+                  int warmup,
+                  int iterations,
+                  Result& result) {
+    idl_options_t options{};
+    if (idl_options_create(&options) != IDL_RESULT_SUCCESS) {
+        return false;
+    }
+    result.supported = true;
+    for (int i = -warmup; i < iterations; ++i) {
+        Run run{};
+        idl_options_set_writer(options, write, &run);
+        idl_options_set_tracer(options, trace, &run);
+
+        idl_compilation_result_t compilationResult{};
+        run.start = run.last = allocations.load(std::memory_order_relaxed);
+        const auto start     = std::chrono::steady_clock::now();
+        const auto code      = idl_compiler_compile(
+            compiler, generator, nullptr, (idl_uint32_t) sources.size(), sources.data(), options, &compilationResult);
+        const auto end   = std::chrono::steady_clock::now();
+        const auto count = allocations.load(std::memory_order_relaxed) - run.start;
+
+        if (code == IDL_RESULT_ERROR_NOT_SUPPORTED) {
+            result.supported = false;
+            break;
+        }
+        if (code != IDL_RESULT_SUCCESS || idl_compilation_result_has_errors(compilationResult)) {
+            idl_uint32_t num{};
+            idl_compilation_result_get_messages(compilationResult, &num, nullptr);
+            std::vector<idl_message_t> messages(num);
+            idl_compilation_result_get_messages(compilationResult, &num, messages.data());
+            for (const auto& message : messages) {
+                fmt::println(stderr, "{}:{}:{}: {}", message.filename, message.line, message.column, message.message);
+            }
+            idl_compilation_result_destroy(compilationResult);
+            idl_options_destroy(options);
+            return false;
+        }
+        if (i >= 0) {
+            const auto stats = idl_compilation_result_get_stats(compilationResult);
+            result.nodes      = stats->node_count;
+            result.symbols    = stats->symbol_count;
+            result.arenaBytes = stats->arena_bytes;
+            result.bytesOut   = run.bytesOut;
+            result.outputs    = run.outputs;
+            result.seconds += std::chrono::duration<double>(end - start).count();
+            result.allocations += count;
+            // Generator stages may run in parallel, so phases are matched by name
+            // rather than by the order in which they completed.
+            for (auto& phase : run.phases) {
+                auto it = std::find_if(result.phases.begin(), result.phases.end(), [&phase](const auto& item) {
+                    return item.name == phase.name && item.category == phase.category;
+                });
+                if (it != result.phases.end()) {
+                    it->milliseconds += phase.milliseconds;
+                    it->allocations += phase.allocations;
+                } else {
+                    result.phases.push_back(std::move(phase));
+                }
+            }
+        }
+        idl_compilation_result_destroy(compilationResult);
+    }
+    idl_options_destroy(options);
+    if (iterations > 0) {
+        result.seconds /= iterations;
+        result.allocations /= iterations;
+        for (auto& phase : result.phases) {
+            phase.milliseconds /= iterations;
+            phase.allocations /= iterations;
+        }
+    }
+    return true;
+}
+
+using Outputs = std::map<std::string, std::string>;
+
+static void collect(const idl_source_t* source, idl_data_t data) {
+    (*static_cast<Outputs*>(data))[source->name].assign(source->data, source->size);
+}
+
+// The JavaScript output embeds its generation time, and the C# solution gets
+// random GUIDs, so these are replaced before outputs are compared. The C
+// output is compared as is.
+static void mask(Outputs& outputs) {
+    static const std::regex time{ R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}Z)" };
+    static const std::regex guid{ "[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}" };
+    for (auto& [name, data] : outputs) {
+        data = std::regex_replace(std::regex_replace(data, time, "<time>"), guid, "<guid>");
+    }
+}
+
+static idl_result_t compileOutputs(idl_compiler_t compiler,
+                                   idl_generator_t generator,
+                                   const std::vector<idl_source_t>& sources,
+                                   bool compileCache,
+                                   Outputs& outputs) {
+    idl_options_t options{};
+    if (auto code = idl_options_create(&options); code != IDL_RESULT_SUCCESS) {
+        return code;
+    }
+    const auto baseDir = std::filesystem::temp_directory_path().string();
+    idl_options_set_base_dir(options, baseDir.c_str());
+    idl_options_set_compile_cache(options, compileCache ? 1 : 0);
+    idl_options_set_writer(options, collect, &outputs);
+    idl_compilation_result_t result{};
+    auto code = idl_compiler_compile(
+        compiler, generator, nullptr, (idl_uint32_t) sources.size(), sources.data(), options, &result);
+    if (code == IDL_RESULT_SUCCESS && idl_compilation_result_has_errors(result)) {
+        code = IDL_RESULT_ERROR_COMPILATION;
+    }
+    idl_compilation_result_destroy(result);
+    idl_options_destroy(options);
+    if (generator != IDL_GENERATOR_C) {
+        mask(outputs);
+    }
+    return code;
+}
+
+// Compiles the corpus on one shared compiler from several threads. Each thread
+// holds its own reference to the compiler and cycles through the generators
+// and four cache modes: two runs without the compile cache, one that may be
+// replayed from it, and one that clears the cache first, so that it is parsed
+// and generated while other threads read the cache. Outputs are compared with
+// a single-threaded reference by content, see mask.
+static bool stress(idl_compiler_t compiler,
+                   const std::vector<idl_generator_t>& generators,
+                   const std::vector<idl_source_t>& sources,
+                   int threads,
+                   int iterations) {
+    std::vector<idl_generator_t> supported{};
+    std::vector<Outputs> expected{};
+    for (auto generator : generators) {
+        Outputs outputs{};
+        const auto code = compileOutputs(compiler, generator, sources, false, outputs);
+        if (code == IDL_RESULT_ERROR_NOT_SUPPORTED) {
+            continue;
+        }
+        if (code != IDL_RESULT_SUCCESS) {
+            fmt::println(stderr, "reference compilation failed: {}", idl_result_to_string(code));
+            return false;
+        }
+        supported.push_back(generator);
+        expected.push_back(std::move(outputs));
+    }
+    if (supported.empty()) {
+        fmt::println(stderr, "no supported generators");
+        return false;
+    }
+
+    std::atomic<int> failures{};
+    std::atomic<int> compilations{};
+    std::vector<std::thread> workers{};
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t, compiler = idl_compiler_reference(compiler)]() {
+            for (int i = 0; i < iterations; ++i) {
+                const auto index = size_t(t + i) % supported.size();
+                const auto mode  = (size_t(t) + size_t(i) / supported.size()) % 4;
+                if (mode == 3) {
+                    idl_compiler_invalidate_cache(compiler, nullptr);
+                }
+                Outputs outputs{};
+                const auto code = compileOutputs(compiler, supported[index], sources, mode % 2 != 0, outputs);
+                ++compilations;
+                if (code != IDL_RESULT_SUCCESS || outputs != expected[index]) {
+                    ++failures;
+                }
+            }
+            idl_compiler_destroy(compiler);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fmt::println("stress: {} threads, {} compilations, {} failures, {:.3f} s",
+                 threads,
+                 compilations.load(),
+                 failures.load(),
+                 seconds);
+    return failures == 0;
+}
+
+static std::vector<std::string> compileFile(const std::filesystem::path& file, idl_uint32_t jobs, Outputs& outputs) {
+    std::vector<std::string> messages{};
+    idl_compiler_t compiler{};
+    idl_options_t options{};
+    if (idl_compiler_create(&compiler) != IDL_RESULT_SUCCESS || idl_options_create(&options) != IDL_RESULT_SUCCESS) {
+        idl_compiler_destroy(compiler);
+        return { "failed to create compiler" };
+    }
+    const auto filename = file.string();
+    idl_options_set_jobs(options, jobs);
+    idl_options_set_writer(options, collect, &outputs);
+    idl_compilation_result_t result{};
+    const auto code = idl_compiler_compile(compiler, IDL_GENERATOR_C, filename.c_str(), 0, nullptr, options, &result);
+    if (code != IDL_RESULT_SUCCESS) {
+        messages.push_back(idl_result_to_string(code));
+    } else {
+        idl_uint32_t count{};
+        idl_compilation_result_get_messages(result, &count, nullptr);
+        std::vector<idl_message_t> list(count);
+        idl_compilation_result_get_messages(result, &count, list.data());
+        for (const auto& message : list) {
+            messages.push_back(fmt::format("{}:{}:{}: {} {}",
+                                           message.filename,
+                                           message.line,
+                                           message.column,
+                                           (int) message.status,
+                                           message.message));
+        }
+    }
+    idl_compilation_result_destroy(result);
+    idl_options_destroy(options);
+    idl_compiler_destroy(compiler);
+    return messages;
+}
+
+// Compiles the corpus from files, as imports given as sources are not lexed
+// ahead of the parser, with one job and with the given number of jobs. The
+// second round appends an undocumented declaration to the last import, so that
+// the location of an error in an imported file is compared as well.
+static bool checkJobs(const Corpus& corpus, int jobs) {
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    const auto dir   = std::filesystem::temp_directory_path() / fmt::format("idlc-bench-{:x}", (uint64_t) stamp);
+    std::filesystem::create_directories(dir);
+    auto passed = true;
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < corpus.names.size(); ++i) {
+            std::ofstream stream(dir / corpus.names[i]);
+            stream << corpus.datas[i];
+            if (round > 0 && i + 1 == corpus.names.size()) {
+                stream << "struct Undocumented\n    field Value {Int32} @ Value.\n";
+            }
+        }
+        Outputs expectedOutputs{};
+        Outputs outputs{};
+        const auto expected = compileFile(dir / corpus.names.front(), 1, expectedOutputs);
+        const auto messages = compileFile(dir / corpus.names.front(), (idl_uint32_t) jobs, outputs);
+        const auto same     = messages == expected && outputs == expectedOutputs;
+        fmt::println("jobs check ({}): {}", round > 0 ? "error in import" : "clean", same ? "identical" : "different");
+        for (size_t i = 0; !same && i < std::max(expected.size(), messages.size()); ++i) {
+            fmt::println("  -j1: {}", i < expected.size() ? expected[i] : "");
+            fmt::println("  -j{}: {}", jobs, i < messages.size() ? messages[i] : "");
+        }
+        passed = passed && same && (round == 0 || !expected.empty());
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return passed;
+}
+
+// The microbenchmarks below measure internals of the library against the code
+// they replaced: a kind range check against dynamic_cast for ASTNode::is, and
+// OutputSink against fmt::println to a std::ostream for generator output.
+template <typename Func>
+static double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void benchKinds(int iterations) {
+    constexpr size_t count = 50000;
+    std::minstd_rand random{};
+    std::vector<std::unique_ptr<idl::ASTNode>> nodes{};
+    for (size_t i = 0; i < count; ++i) {
+        switch (random() % 6) {
+            case 0:
+                nodes.push_back(std::make_unique<idl::ASTInt32>());
+                break;
+            case 1:
+                nodes.push_back(std::make_unique<idl::ASTUint8>());
+                break;
+            case 2:
+                nodes.push_back(std::make_unique<idl::ASTFloat64>());
+                break;
+            case 3:
+                nodes.push_back(std::make_unique<idl::ASTStruct>());
+                break;
+            case 4:
+                nodes.push_back(std::make_unique<idl::ASTField>());
+                break;
+            default:
+                nodes.push_back(std::make_unique<idl::ASTLiteralInt>());
+                break;
+        }
+    }
+    size_t casts{};
+    size_t kinds{};
+    const auto castSeconds = measure(iterations, [&]() {
+        for (const auto& node : nodes) {
+            casts += dynamic_cast<const idl::ASTIntegerType*>(node.get()) ? 1 : 0;
+        }
+    });
+    const auto kindSeconds = measure(iterations, [&]() {
+        for (const auto& node : nodes) {
+            kinds += node->is<idl::ASTIntegerType>() ? 1 : 0;
+        }
+    });
+    fmt::println("is<ASTIntegerType> over {} nodes: dynamic_cast {:.3f} ms, kind check {:.3f} ms{}",
+                 count,
+                 castSeconds * 1000.0,
+                 kindSeconds * 1000.0,
+                 casts == kinds ? "" : " (results differ)");
+}
+
+static void printThroughput(std::string_view name, size_t bytes, double streamSeconds, double sinkSeconds) {
+    constexpr auto megabyte = 1024.0 * 1024.0;
+    fmt::println("{}: ostream {:.2f} MB/s, sink {:.2f} MB/s",
+                 name,
+                 bytes / streamSeconds / megabyte,
+                 bytes / sinkSeconds / megabyte);
+}
+
+static void benchSink(int iterations) {
+    constexpr auto lines = 200000;
+    const std::string brief{ "Returns the number of compilations whose outputs were taken from the compile cache." };
+    size_t streamBytes{};
+    size_t sinkBytes{};
+
+    auto streamSeconds = measure(iterations, [&]() {
+        std::ostringstream stream;
+        for (int i = 0; i < lines; ++i) {
+            fmt::println(stream, "    return IDL_RESULT_SUCCESS;");
+        }
+        streamBytes = (size_t) stream.tellp();
+    });
+    auto sinkSeconds = measure(iterations, [&]() {
+        idl::OutputSink sink{};
+        for (int i = 0; i < lines; ++i) {
+            idl::println(sink, "    return IDL_RESULT_SUCCESS;");
+        }
+        sinkBytes = sink.buffer().size();
+    });
+    printThroughput("literal lines", streamBytes, streamSeconds, sinkSeconds);
+
+    streamSeconds = measure(iterations, [&]() {
+        std::ostringstream stream;
+        for (int i = 0; i < lines; ++i) {
+            fmt::println(stream, " * @brief     {} ({})", brief, i);
+        }
+        streamBytes = (size_t) stream.tellp();
+    });
+    sinkSeconds = measure(iterations, [&]() {
+        idl::OutputSink sink{};
+        for (int i = 0; i < lines; ++i) {
+            idl::println(sink, " * @brief     {} ({})", brief, i);
+        }
+        sinkBytes = sink.buffer().size();
+    });
+    printThroughput("formatted lines", streamBytes, streamSeconds, sinkSeconds);
+    if (streamBytes != sinkBytes) {
+        fmt::println("output sizes differ: ostream {} bytes, sink {} bytes", streamBytes, sinkBytes);
+    }
+}
+
+static std::string jsonString(std::string_view str) {
+    std::string result = "\"";
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char) c < 0x20) {
+            result += fmt::format("\\u{:04x}", (int) c);
+        } else {
+            result += c;
+        }
+    }
+    return result + '"';
+}
+
+static void printJson(const Shape& shape, const Corpus& corpus, int iterations, const std::vector<Result>& results) {
+    fmt::println("{{");
+    fmt::println("  \"format\": 1,");
+    fmt::println("  \"version\": {},", jsonString(IDL_VERSION_STRING));
+    fmt::println("  \"iterations\": {},", iterations);
+    fmt::println("  \"corpus\": {{");
+    fmt::println("    \"files\": {},", corpus.names.size());
+    fmt::println("    \"bytes\": {},", corpus.bytes);
+    fmt::println("    \"depth\": {},", shape.depth);
+    fmt::println("    \"fanout\": {},", shape.fanout);
+    fmt::println("    \"enums\": {},", shape.enums);
+    fmt::println("    \"consts\": {},", shape.consts);
+    fmt::println("    \"structs\": {},", shape.structs);
+    fmt::println("    \"fields\": {},", shape.fields);
+    fmt::println("    \"interfaces\": {},", shape.interfaces);
+    fmt::println("    \"methods\": {},", shape.methods);
+    fmt::println("    \"props\": {},", shape.props);
+    fmt::println("    \"events\": {},", shape.events);
+    fmt::println("    \"doc_lines\": {}", shape.docLines);
+    fmt::println("  }},");
+    fmt::println("  \"generators\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        fmt::println("    {{");
+        fmt::println("      \"generator\": {},", jsonString(result.generator));
+        fmt::print("      \"supported\": {}", result.supported);
+        if (result.supported) {
+            fmt::println(",");
+            fmt::println("      \"seconds\": {:.6f},", result.seconds);
+            fmt::println("      \"decls\": {},", result.nodes);
+            fmt::println("      \"symbols\": {},", result.symbols);
+            fmt::println("      \"decls_per_second\": {:.1f},", result.nodes / result.seconds);
+            fmt::println("      \"outputs\": {},", result.outputs);
+            fmt::println("      \"bytes_out\": {},", result.bytesOut);
+            fmt::println("      \"bytes_out_per_second\": {:.1f},", result.bytesOut / result.seconds);
+            fmt::println("      \"arena_bytes\": {},", result.arenaBytes);
+            fmt::println("      \"allocations\": {},", result.allocations);
+            fmt::println("      \"phases\": [");
+            for (size_t p = 0; p < result.phases.size(); ++p) {
+                const auto& phase = result.phases[p];
+                fmt::print("        {{ \"name\": {}, \"category\": {}, \"milliseconds\": {:.6f}",
+                           jsonString(phase.name),
+                           jsonString(phase.category),
+                           phase.milliseconds);
+                if (phase.sequential) {
+                    fmt::print(", \"allocations\": {}", phase.allocations);
+                }
+                fmt::println(" }}{}", p + 1 < result.phases.size() ? "," : "");
+            }
+            fmt::println("      ]");
+        } else {
+            fmt::println("");
+        }
+        fmt::println("    }}{}", i + 1 < results.size() ? "," : "");
+    }
+    fmt::println("  ]");
+    fmt::println("}}");
+}
+
+static void printText(const Corpus& corpus, int iterations, const std::vector<Result>& results) {
+    fmt::println("corpus: {} files, {} bytes, {} iterations", corpus.names.size(), corpus.bytes, iterations);
+    for (const auto& result : results) {
+        if (!result.supported) {
+            fmt::println("\n{}: not supported", result.generator);
+            continue;
+        }
+        fmt::println("\n{}: {:.3f} ms, {} decls, {:.0f} decls/s, {} outputs, {} bytes out, {:.2f} MB/s",
+                     result.generator,
+                     result.seconds * 1000.0,
+                     result.nodes,
+                     result.nodes / result.seconds,
+                     result.outputs,
+                     result.bytesOut,
+                     result.bytesOut / result.seconds / (1024.0 * 1024.0));
+        fmt::println("  arena: {} bytes, allocations: {}", result.arenaBytes, result.allocations);
+        for (const auto& phase : result.phases) {
+            if (phase.sequential) {
+                fmt::println("  {:<40} {:>12.3f} ms {:>10} allocs", phase.name, phase.milliseconds, phase.allocations);
+            } else {
+                fmt::println("  {:<40} {:>12.3f} ms", phase.name, phase.milliseconds);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Shape shape{};
+    auto iterations = 10;
+    auto warmup     = 1;
+    auto json       = false;
+    auto threads    = 0;
+    auto jobs       = 0;
+    auto micro      = false;
+    std::string gens = "c,js,cs";
+    std::string dump;
+
+    argparse::ArgumentParser program("idlc-bench", IDL_VERSION_STRING);
+    program.add_argument("--depth").store_into(shape.depth).help("depth of the import tree");
+    program.add_argument("--fanout").store_into(shape.fanout).help("imports per file");
+    program.add_argument("--enums").store_into(shape.enums).help("enumerations per file");
+    program.add_argument("--consts").store_into(shape.consts).help("constants per enumeration");
+    program.add_argument("--structs").store_into(shape.structs).help("structures per file");
+    program.add_argument("--fields").store_into(shape.fields).help("extra fields per structure");
+    program.add_argument("--interfaces").store_into(shape.interfaces).help("interfaces per file");
+    program.add_argument("--methods").store_into(shape.methods).help("methods per interface");
+    program.add_argument("--props").store_into(shape.props).help("properties per interface");
+    program.add_argument("--events").store_into(shape.events).help("events per interface");
+    program.add_argument("--doc-lines").store_into(shape.docLines).help("lines of documentation per declaration");
+    program.add_argument("-n", "--iterations").store_into(iterations).help("measured iterations");
+    program.add_argument("--warmup").store_into(warmup).help("iterations run before measuring");
+    program.add_argument("-g", "--generators").store_into(gens).help("generators separated by commas (c, cs, js)");
+    program.add_argument("--json").store_into(json).help("print results as JSON");
+    program.add_argument("--dump").store_into(dump).help("write the generated corpus to a directory");
+    program.add_argument("--stress")
+        .store_into(threads)
+        .help("compile concurrently from the given number of threads on one compiler and check the outputs");
+    program.add_argument("--check-jobs")
+        .store_into(jobs)
+        .help("check that the corpus compiles to the same messages and outputs with one and the given jobs");
+    program.add_argument("--micro")
+        .store_into(micro)
+        .help("compare ASTNode::is with dynamic_cast, and OutputSink with std::ostream output");
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const std::exception& exc) {
+        std::cerr << exc.what() << std::endl;
+        std::cerr << program;
+        return EXIT_FAILURE;
+    }
+
+    const std::map<std::string, idl_generator_t> generators = {
+        { "c",  IDL_GENERATOR_C           },
+        { "js", IDL_GENERATOR_JAVA_SCRIPT },
+        { "cs", IDL_GENERATOR_CSHARP      }
+    };
+    std::vector<Result> results{};
+    std::istringstream stream(gens);
+    std::string gen;
+    while (std::getline(stream, gen, ',')) {
+        if (!generators.contains(gen)) {
+            std::cerr << "invalid generator '" << gen << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        results.push_back({ gen });
+    }
+
+    if (micro) {
+        benchKinds(iterations);
+        benchSink(iterations);
+        return EXIT_SUCCESS;
+    }
+
+    const auto corpus = generateCorpus(shape);
+    if (!dump.empty()) {
+        std::filesystem::create_directories(dump);
+        for (size_t i = 0; i < corpus.names.size(); ++i) {
+            std::ofstream(std::filesystem::path(dump) / corpus.names[i]) << corpus.datas[i];
+        }
+    }
+    std::vector<idl_source_t> sources{};
+    for (size_t i = 0; i < corpus.names.size(); ++i) {
+        const auto& data = corpus.datas[i];
+        sources.push_back({ corpus.names[i].c_str(), data.data(), (idl_uint32_t) data.size() });
+    }
+
+    if (jobs > 0) {
+        return checkJobs(corpus, jobs) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    idl_compiler_t compiler{};
+    if (idl_compiler_create(&compiler) != IDL_RESULT_SUCCESS) {
+        std::cerr << "failed to create compiler" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (threads > 0) {
+        std::vector<idl_generator_t> targets{};
+        for (const auto& result : results) {
+            targets.push_back(generators.at(result.generator));
+        }
+        const auto passed = stress(compiler, targets, sources, threads, iterations);
+        idl_compiler_destroy(compiler);
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    auto failed = false;
+    for (auto& result : results) {
+        if (!bench(compiler, generators.at(result.generator), sources, warmup, iterations, result)) {
+            std::cerr << "compilation failed (" << result.generator << ")" << std::endl;
+            failed = true;
+            break;
+        }
+    }
+    idl_compiler_destroy(compiler);
+    if (failed) {
+        return EXIT_FAILURE;
+    }
+
+    if (json) {
+        printJson(shape, corpus, iterations, results);
+    } else {
+        printText(corpus, iterations, results);
+    }
+    return EXIT_SUCCESS;
+}
@@ -29,7 +29,7 @@ inline std::string& upper(std::string& str) {
     return str;
 }
 
-inline std::vector<std::string> tokenize(const std::string& str) {
+inline std::vector<std::string> tokenize(std::string_view str) {
     std::vector<std::string> tokens;
     std::ostringstream ss;
     char prevC = '\0';
@@ -49,7 +49,7 @@ inline std::vector<std::string> tokenize(const std::string& str) {
     return tokens;
 }
 
-inline std::vector<std::string> tokenize(const std::string& str, const std::vector<int>& nums) {
+inline std::vector<std::string> tokenize(std::string_view str, std::span<const int> nums) {
     std::vector<std::string> tokens;
     size_t pos = 0;
     for (int num : nums) {
@@ -62,17 +62,17 @@ inline std::vector<std::string> tokenize(const std::string& str, const std::vect
         } else if (num > 0) {
             auto take   = size_t(num);
             auto endPos = std::min(pos + take, str.length());
-            tokens.push_back(str.substr(pos, endPos - pos));
+            tokens.emplace_back(str.substr(pos, endPos - pos));
             pos = endPos;
         }
     }
     if (pos < str.length()) {
-        tokens.push_back(str.substr(pos));
+        tokens.emplace_back(str.substr(pos));
     }
     return tokens;
 }
 
-inline std::string convert(const std::string& str, Case caseConvention, const std::vector<int>* nums = nullptr) {
+inline std::string convert(std::string_view str, Case caseConvention, const std::pmr::vector<int>* nums = nullptr) {
     auto tokens = nums ? tokenize(str, *nums) : tokenize(str);
 
     char prevSymbol = '\0';
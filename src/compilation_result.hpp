@@ -19,6 +19,7 @@ public:
     }
 
     void addMessage(const Exception& exc, bool isError = true) {
+        std::lock_guard lock(_mutex);
         _messages.push_back({});
         auto& message    = _messages.back();
         message.status   = exc.status();
@@ -34,6 +35,62 @@ public:
         }
     }
 
+    void addPhase(std::string_view name, double milliseconds) {
+        std::lock_guard lock(_mutex);
+        _phases.push_back({ getStr(std::string(name)), milliseconds });
+    }
+
+    void getPhaseTimes(idl_uint32_t& phaseCount, idl_phase_time_t* phases) const noexcept {
+        if (phases) {
+            phaseCount = std::min(phaseCount, (idl_uint32_t) _phases.size());
+            for (idl_uint32_t i = 0; i < phaseCount; ++i) {
+                phases[i] = _phases[i];
+            }
+        } else {
+            phaseCount = (idl_uint32_t) _phases.size();
+        }
+    }
+
+    const idl_stats_t* getStats() const noexcept {
+        return &_stats;
+    }
+
+    void setStats(const idl_stats_t& stats) noexcept {
+        _stats = stats;
+    }
+
+    void addChangedFile(const std::string& file) {
+        std::lock_guard lock(_mutex);
+        _changedFiles.push_back(getStr(file));
+    }
+
+    void getChangedFiles(idl_uint32_t& fileCount, idl_utf8_t* files) const noexcept {
+        if (files) {
+            fileCount = std::min(fileCount, (idl_uint32_t) _changedFiles.size());
+            for (idl_uint32_t i = 0; i < fileCount; ++i) {
+                files[i] = _changedFiles[i];
+            }
+        } else {
+            fileCount = (idl_uint32_t) _changedFiles.size();
+        }
+    }
+
+    void addDependency(const std::string& file) {
+        std::lock_guard lock(_mutex);
+        _dependencies.push_back(getStr(file));
+    }
+
+    void getDependencies(idl_uint32_t& fileCount, idl_utf8_t* files) const noexcept {
+        if (files) {
+            fileCount = std::min(fileCount, (idl_uint32_t) _dependencies.size());
+            for (idl_uint32_t i = 0; i < fileCount; ++i) {
+                files[i] = _dependencies[i];
+            }
+        } else {
+            fileCount = (idl_uint32_t) _dependencies.size();
+        }
+    }
+
     void getMessages(idl_uint32_t& messageCount, idl_message_t* messages) const noexcept {
         if (messages) {
             messageCount = std::min(messageCount, (idl_uint32_t) _messages.size());
@@ -55,6 +112,11 @@ private:
     bool _hasErrors{};
     std::vector<std::unique_ptr<std::string>> _strPool{};
     std::vector<idl_message_t> _messages{};
+    std::vector<idl_utf8_t> _changedFiles{};
+    std::vector<idl_utf8_t> _dependencies{};
+    std::vector<idl_phase_time_t> _phases{};
+    idl_stats_t _stats{};
+    std::mutex _mutex{};
 };
 
 } // namespace idl
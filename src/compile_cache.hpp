@@ -0,0 +1,172 @@
+#ifndef COMPILE_CACHE_HPP
+#define COMPILE_CACHE_HPP
+
+#include "compilation_result.hpp"
+#include "scanner.hpp"
+
+namespace idl {
+
+class CompileCache final {
+public:
+    struct Output {
+        std::string name;
+        std::string data;
+    };
+
+    struct Message {
+        idl_status_t status;
+        bool isError;
+        std::string message;
+        std::string filename;
+        idl_uint32_t line;
+        idl_uint32_t column;
+    };
+
+    struct Entry {
+        std::vector<Scanner::Dependency> dependencies{};
+        std::vector<Scanner::Directory> directories{};
+        std::vector<Output> outputs{};
+        std::vector<Message> messages{};
+    };
+
+    static uint64_t key(std::span<const idl_generator_t> generators,
+                        const std::filesystem::path& file,
+                        std::span<const idl_source_t> sources,
+                        Options& options,
+                        bool withMessages) {
+        std::string str =
+            fmt::format("{}\n{}\n{}\n", file.string(), options.basePath().string(), options.getOutputDir());
+        for (auto generator : generators) {
+            str += fmt::format("-g{}\n", (int) generator);
+        }
+        for (const auto& source : sources) {
+            str += fmt::format("{}:{:x}\n", source.name, XXH64(source.data, source.size, 0));
+        }
+        idl_uint32_t num{};
+        options.getImportDirs(num, nullptr);
+        std::vector<idl_utf8_t> strs(num);
+        options.getImportDirs(num, strs.data());
+        for (auto dir : strs) {
+            str += fmt::format("-I{}\n", dir);
+        }
+        options.getAdditions(num, nullptr);
+        strs.resize(num);
+        options.getAdditions(num, strs.data());
+        for (auto addition : strs) {
+            str += fmt::format("+{}\n", addition);
+        }
+        if (auto version = options.getVersion()) {
+            str += fmt::format("{}.{}.{}\n", version->major, version->minor, version->micro);
+        }
+        str += options.getWarningsAsErrors() ? "W" : "w";
+        str += withMessages ? "M" : "m";
+        return XXH64(str.c_str(), str.length(), 0);
+    }
+
+    std::shared_ptr<const Entry> find(uint64_t key, const Options& options) {
+        std::shared_ptr<const Entry> entry{};
+        {
+            std::lock_guard lock(_mutex);
+            if (auto it = _entries.find(key); it != _entries.end()) {
+                entry = it->second;
+            }
+        }
+        // Dependencies are re-hashed outside the lock so that concurrent
+        // compilations do not wait for each other's file reads.
+        if (!entry || !valid(*entry, options)) {
+            std::lock_guard lock(_mutex);
+            if (auto it = _entries.find(key); entry && it != _entries.end() && it->second == entry) {
+                _entries.erase(it);
+            }
+            ++_misses;
+            return nullptr;
+        }
+        ++_hits;
+        return entry;
+    }
+
+    void insert(uint64_t key, Entry&& entry) {
+        auto ptr = std::make_shared<const Entry>(std::move(entry));
+        std::lock_guard lock(_mutex);
+        _entries.insert_or_assign(key, std::move(ptr));
+    }
+
+    void invalidate(idl_utf8_t file) {
+        std::lock_guard lock(_mutex);
+        if (!file) {
+            _entries.clear();
+            return;
+        }
+        const auto path = std::filesystem::path(file).lexically_normal();
+        std::erase_if(_entries, [&path](const auto& item) {
+            const auto& deps = item.second->dependencies;
+            return std::any_of(deps.begin(), deps.end(), [&path](const auto& dep) {
+                return dep.path.lexically_normal() == path;
+            });
+        });
+    }
+
+    idl_uint32_t hits() const noexcept {
+        return _hits;
+    }
+
+    idl_uint32_t misses() const noexcept {
+        return _misses;
+    }
+
+    static void capture(const idl_source_t* source, idl_data_t data) {
+        auto entry = static_cast<Entry*>(data);
+        entry->outputs.push_back({ source->name, std::string(source->data, source->size) });
+    }
+
+private:
+    static bool valid(const Entry& entry, const Options& options) {
+        // A file added to, removed from or renamed in a directory searched for
+        // imports may change how they resolve.
+        for (const auto& dir : entry.directories) {
+            std::error_code ec;
+            if (std::filesystem::last_write_time(dir.path, ec) != dir.time) {
+                return false;
+            }
+        }
+        for (const auto& dep : entry.dependencies) {
+            if (dep.fromSources) {
+                continue;
+            }
+            if (dep.fromImporter) {
+                idl_data_t data{};
+                auto importer = options.getImporter(&data);
+                auto source   = importer ? importer(dep.path.string().c_str(), 1, data) : nullptr;
+                if (!source) {
+                    return false;
+                }
+                const auto hash = XXH64(source->data, source->size, 0);
+                if (auto release = options.getReleaseImport(&data)) {
+                    release(source, data);
+                }
+                if (hash != dep.hash) {
+                    return false;
+                }
+            } else {
+                MappedFile mapped;
+                if (!mapped.map(dep.path)) {
+                    return false;
+                }
+                const auto input = mapped.data();
+                if (XXH64(input.data(), input.size(), 0) != dep.hash) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::unordered_map<uint64_t, std::shared_ptr<const Entry>> _entries{};
+    std::atomic<idl_uint32_t> _hits{};
+    std::atomic<idl_uint32_t> _misses{};
+    std::mutex _mutex{};
+};
+
+} // namespace idl
+
+#endif
@@ -1,7 +1,13 @@
 #include "compilation_result.hpp"
+#include "compile_cache.hpp"
+#include "depfile.hpp"
 #include "options.hpp"
+#include "output_sink.hpp"
 #include "parser.hpp"
+#include "pass_manager.hpp"
 #include "scanner.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 void generateC(idl::Context& ctx,
                const std::filesystem::path& out,
@@ -26,19 +32,53 @@ namespace idl {
 
 class Compiler final : public _idl_compiler {
 public:
-    idl_result_t compile(idl_generator_t generator,
+    idl_result_t compile(std::span<const idl_generator_t> generators,
                          idl_utf8_t file,
                          std::span<const idl_source_t> sources,
                          Options* options,
-                         CompilationResult* result) noexcept {
+                         CompilationResult* result,
+                         DirectoryIndex* sharedIndex = nullptr,
+                         ModuleStore* sharedModules  = nullptr) noexcept {
+        std::vector<idl_generator_t> targets{};
+        for (auto generator : generators) {
+            if (!supported(generator)) {
+                return IDL_RESULT_ERROR_NOT_SUPPORTED;
+            }
+            if (std::find(targets.begin(), targets.end(), generator) == targets.end()) {
+                targets.push_back(generator);
+            }
+        }
+        PhaseTimer timer(options, nullptr, "compile", "compile");
         try {
+            const auto useCache = options && options->getCompileCache();
+            uint64_t cacheKey{};
+            if (useCache) {
+                cacheKey = CompileCache::key(targets, file ? file : "", sources, *options, result != nullptr);
+                if (auto entry = _cache.find(cacheKey, *options)) {
+                    replay(*entry, options, result);
+                    return IDL_RESULT_SUCCESS;
+                }
+            }
+
             Context context{ options, result };
-            Scanner scanner{ context, options, sources, file ? file : "" };
+            DirectoryIndex localIndex{};
+            auto& dirIndex = options && options->getImportCache() ? _dirIndex : sharedIndex ? *sharedIndex : localIndex;
+            auto modules   = sharedModules ? sharedModules : useCache ? &_modules : nullptr;
+            Scanner scanner{ context, dirIndex, options, sources, file ? file : "", modules };
             Parser parser{ scanner };
 #if YYDEBUG
             parser.set_debug_level(options && options->getDebugMode() ? 1 : 0);
 #endif
-            auto code = parser.parse();
+            const auto jobs = availableJobs(options ? options->jobs() : 1);
+            if (jobs > 1) {
+                PhaseTimer timer(options, result, "compile", "prelex");
+                scanner.prelex(jobs);
+            }
+            int code{};
+            {
+                PhaseTimer timer(options, result, "compile", "parse");
+                code = parser.parse();
+            }
 
             if (code != 0) {
                 if (result) {
@@ -50,23 +90,16 @@ public:
                 }
             }
 
-            context.prepareEnumConsts();
-            context.prepareStructs();
-            context.prepareCallbacks();
-            context.prepareFunctions();
-            context.prepareMethods();
-            context.prepareProperties();
-            context.prepareEvents();
-            context.prepareInterfaces();
-            context.prepareHandles();
-            context.prepareDocumentation();
+            PassManager passes{ context, options, result, jobs };
+            addSemanticPasses(passes);
+            passes.run();
 
             auto output = std::filesystem::current_path();
             idl_write_callback_t writer{};
             idl_data_t writerData{};
             std::vector<idl_utf8_t> additions{};
             if (options) {
-                output = options->getOutputDir();
+                output = options->resolve(options->getOutputDir());
                 writer = options->getWriter(&writerData);
                 idl_uint32_t num{};
                 options->getAdditions(num, nullptr);
@@ -77,27 +110,56 @@ public:
                 }
             }
 
-            switch (generator) {
-                case IDL_GENERATOR_C:
-                    generateC(context, output, writer, writerData, std::span{ additions.data(), additions.size() });
-                    break;
-                case IDL_GENERATOR_JAVA_SCRIPT:
-#ifdef IDLC_SUPPORTED_JS
-                    generateJs(context, output, writer, writerData);
-                    break;
-#else
-                    return IDL_RESULT_ERROR_NOT_SUPPORTED;
-#endif
-                case IDL_GENERATOR_CSHARP:
-#ifdef IDLC_SUPPORTED_CS
-                    generateCs(context, output, writer, writerData, std::span{ additions.data(), additions.size() });
-                    break;
-#else
-                    return IDL_RESULT_ERROR_NOT_SUPPORTED;
-#endif
-                default:
-                    assert(!"unreachable code");
-                    break;
+            if (useCache && scanner.hashable()) {
+                context.fileCache(&_fileCache, fileKeys(context, scanner));
+            }
+
+            const auto buffered = useCache || (writer && targets.size() > 1);
+            std::vector<CompileCache::Entry> buffers(buffered ? targets.size() : 0);
+            auto run = [&](size_t index) {
+                if (buffered) {
+                    generate(targets[index], context, output, CompileCache::capture, &buffers[index], additions);
+                } else {
+                    generate(targets[index], context, output, writer, writerData, additions);
+                }
+            };
+
+            parallelFor(targets.size(), jobs, run);
+            if (result) {
+                result->setStats({ idl_uint32_t(context.nodeCount()),
+                                   idl_uint32_t(context.symbolCount()),
+                                   idl_uint64_t(context.arenaBytes()) });
+            }
+
+            CompileCache::Entry entry{};
+            for (auto& buffer : buffers) {
+                std::move(buffer.outputs.begin(), buffer.outputs.end(), std::back_inserter(entry.outputs));
+            }
+            auto files = context.outputs();
+            if (buffered) {
+                PhaseTimer timer(options, result, "compile", "write");
+                files = write(entry.outputs, options, result);
+            }
+            depfile(options, files, scanner.dependencies());
+
+            if (useCache && scanner.hashable() && !(result && result->hasErrors())) {
+                entry.dependencies = scanner.dependencies();
+                entry.directories  = scanner.directories();
+                if (result) {
+                    idl_uint32_t num{};
+                    result->getMessages(num, nullptr);
+                    std::vector<idl_message_t> messages(num);
+                    result->getMessages(num, messages.data());
+                    for (const auto& message : messages) {
+                        entry.messages.push_back({ message.status,
+                                                   message.is_error != 0,
+                                                   message.message,
+                                                   message.filename,
+                                                   message.line,
+                                                   message.column });
+                    }
+                }
+                _cache.insert(cacheKey, std::move(entry));
             }
         } catch (const Exception& exc) {
             if (result) {
@@ -122,6 +184,252 @@ public:
         }
         return IDL_RESULT_SUCCESS;
     }
+
+    idl_result_t compileBatch(std::span<const idl_compile_job_t> jobs,
+                              std::span<idl_compilation_result_t> results) noexcept {
+        // Jobs share one directory index and the modules of their imports, so
+        // each import directory is listed and each import is lexed once per
+        // batch rather than once per job. Jobs run on as many threads as the
+        // largest jobs option allows, and each job then runs on one thread.
+        try {
+            DirectoryIndex dirIndex{};
+            ModuleStore modules{};
+            size_t threads = 1;
+            for (const auto& job : jobs) {
+                if (job.options) {
+                    threads = std::max(threads, job.options->as<Options>()->jobs());
+                }
+            }
+            std::vector<idl_result_t> codes(jobs.size(), IDL_RESULT_SUCCESS);
+            parallelFor(jobs.size(), threads, [this, jobs, results, &dirIndex, &modules, &codes](size_t i) {
+                const auto& job       = jobs[i];
+                auto options          = job.options ? job.options->as<Options>() : nullptr;
+                auto result           = results[i]->as<CompilationResult>();
+                const auto generators = std::span{ &job.generator, 1 };
+                codes[i]              = compile(generators, job.file, {}, options, result, &dirIndex, &modules);
+            });
+            for (auto code : codes) {
+                if (code != IDL_RESULT_SUCCESS) {
+                    return code;
+                }
+            }
+        } catch (const std::bad_alloc&) {
+            return IDL_RESULT_ERROR_OUT_OF_MEMORY;
+        } catch (...) {
+            return IDL_RESULT_ERROR_UNKNOWN;
+        }
+        return IDL_RESULT_SUCCESS;
+    }
+
+    void invalidateCache(idl_utf8_t file) {
+        _cache.invalidate(file);
+        if (!file) {
+            _fileCache.clear();
+        }
+    }
+
+    idl_uint32_t getCacheHits() const noexcept {
+        return _cache.hits();
+    }
+
+    idl_uint32_t getCacheMisses() const noexcept {
+        return _cache.misses();
+    }
+
+private:
+    static bool supported(idl_generator_t generator) noexcept {
+        switch (generator) {
+            case IDL_GENERATOR_C:
+                return true;
+            case IDL_GENERATOR_JAVA_SCRIPT:
+#ifdef IDLC_SUPPORTED_JS
+                return true;
+#else
+                return false;
+#endif
+            case IDL_GENERATOR_CSHARP:
+#ifdef IDLC_SUPPORTED_CS
+                return true;
+#else
+                return false;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    static const char* generatorName(idl_generator_t generator) noexcept {
+        switch (generator) {
+            case IDL_GENERATOR_C:
+                return "generateC";
+            case IDL_GENERATOR_JAVA_SCRIPT:
+                return "generateJs";
+            case IDL_GENERATOR_CSHARP:
+                return "generateCs";
+            default:
+                return "generate";
+        }
+    }
+
+    static void generate(idl_generator_t generator,
+                         Context& context,
+                         const std::filesystem::path& output,
+                         idl_write_callback_t writer,
+                         idl_data_t writerData,
+                         std::vector<idl_utf8_t>& additions) {
+        PhaseTimer timer(context.options(), context.result(), "generator", generatorName(generator));
+        switch (generator) {
+            case IDL_GENERATOR_C:
+                generateC(context, output, writer, writerData, std::span{ additions.data(), additions.size() });
+                break;
+#ifdef IDLC_SUPPORTED_JS
+            case IDL_GENERATOR_JAVA_SCRIPT:
+                generateJs(context, output, writer, writerData);
+                break;
+#endif
+#ifdef IDLC_SUPPORTED_CS
+            case IDL_GENERATOR_CSHARP:
+                generateCs(context, output, writer, writerData, std::span{ additions.data(), additions.size() });
+                break;
+#endif
+            default:
+                assert(!"unreachable code");
+                break;
+        }
+    }
+
+    // Keys the output of each file by the content of the files it is generated
+    // from: the files of its marker and declarations, the files these import,
+    // and the files of the declarations referenced from any of them. Every
+    // output documents the API of the input file, so the content of the input
+    // file and the version are part of every key.
+    static std::unordered_map<const ASTFile*, uint64_t> fileKeys(Context& context, const Scanner& scanner) {
+        using Edges         = std::unordered_map<std::string_view, std::set<std::string_view>>;
+        const auto& sources = scanner.imported();
+        Edges imports{};
+        for (const auto& [name, source] : sources) {
+            imports[name].insert(source.imports.begin(), source.imports.end());
+        }
+        Edges refs{};
+        context.filter<ASTDeclRef>([&refs](ASTDeclRef* ref) {
+            if (ref->decl && ref->location.begin.filename && ref->decl->location.begin.filename) {
+                refs[*ref->location.begin.filename].insert(*ref->decl->location.begin.filename);
+            }
+        });
+        auto close = [](std::set<std::string_view>& files, const Edges& edges) {
+            std::vector<std::string_view> pending(files.begin(), files.end());
+            while (!pending.empty()) {
+                const auto name = pending.back();
+                pending.pop_back();
+                if (auto it = edges.find(name); it != edges.end()) {
+                    for (auto next : it->second) {
+                        if (files.insert(next).second) {
+                            pending.push_back(next);
+                        }
+                    }
+                }
+            }
+        };
+        // Built-in declarations have no file, they hash to zero.
+        auto hash = [&sources](std::string_view name) {
+            auto it = sources.find(std::string(name));
+            return it != sources.end() ? it->second.hash : 0;
+        };
+
+        std::string base{};
+        if (auto filename = context.api()->location.begin.filename) {
+            base = fmt::format("{:x}\n", hash(*filename));
+        }
+        if (const auto& version = context.apiVersion()) {
+            base += fmt::format("{}.{}.{}\n", version->major, version->minor, version->micro);
+        }
+        context.filter<ASTYear>([&base](ASTYear* node) {
+            base += fmt::format("{}\n", node->value);
+            return false;
+        });
+
+        std::unordered_map<const ASTFile*, uint64_t> keys{};
+        for (auto file : context.api()->files) {
+            std::set<std::string_view> files{};
+            if (file->location.begin.filename) {
+                files.insert(*file->location.begin.filename);
+            }
+            for (auto decl : file->decls) {
+                if (decl->location.begin.filename) {
+                    files.insert(*decl->location.begin.filename);
+                }
+            }
+            close(files, imports);
+            close(files, refs);
+
+            auto str = base;
+            for (auto name : files) {
+                str += fmt::format("{}:{:x}\n", name, hash(name));
+            }
+            keys.emplace(file, XXH64(str.c_str(), str.length(), 0));
+        }
+        return keys;
+    }
+
+    static void replay(const CompileCache::Entry& entry, Options* options, CompilationResult* result) {
+        depfile(options, write(entry.outputs, options, result), entry.dependencies);
+        if (result) {
+            for (const auto& dep : entry.dependencies) {
+                if (!dep.fromImporter && !dep.fromSources) {
+                    result->addDependency(dep.path.string());
+                }
+            }
+            for (const auto& message : entry.messages) {
+                Exception exc(message.status, message.filename, message.line, message.column, message.message);
+                result->addMessage(exc, message.isError);
+            }
+        }
+    }
+
+    static std::vector<std::filesystem::path> write(const std::vector<CompileCache::Output>& outputs,
+                                                    Options* options,
+                                                    CompilationResult* result) {
+        idl_data_t writerData{};
+        if (auto writer = options->getWriter(&writerData)) {
+            for (const auto& output : outputs) {
+                idl_source_t source{ output.name.c_str(), output.data.c_str(), (idl_uint32_t) output.data.length() };
+                writer(&source, writerData);
+            }
+            return {};
+        }
+        const auto out = options->resolve(options->getOutputDir());
+        std::filesystem::create_directories(out);
+        const std::string str = "<input>";
+        const auto loc        = idl::location(idl::position(&str, 1, 1));
+        std::vector<std::filesystem::path> files{};
+        for (const auto& output : outputs) {
+            writeOutput(loc, options, result, out / output.name, output.data);
+            files.push_back(out / output.name);
+        }
+        return files;
+    }
+
+    static void depfile(const Options* options,
+                        std::span<const std::filesystem::path> files,
+                        std::span<const Scanner::Dependency> dependencies) {
+        if (!options || !options->getDepfile()) {
+            return;
+        }
+        const std::string str = "<input>";
+        const auto loc        = idl::location(idl::position(&str, 1, 1));
+        const auto path = options->resolve(options->getDepfile());
+        if (auto target = options->getDepfileTarget()) {
+            const auto targetPath = options->resolve(target);
+            writeDepfile(loc, path, std::span{ &targetPath, 1 }, dependencies);
+        } else if (!files.empty()) {
+            writeDepfile(loc, path, files, dependencies);
+        }
+    }
+
+    DirectoryIndex _dirIndex{};
+    CompileCache _cache{};
+    ModuleStore _modules{};
+    FileCache _fileCache{};
 };
 
 }; // namespace idl
@@ -202,6 +510,26 @@ void idl_options_set_output_dir(idl_options_t options, idl_utf8_t dir) {
     options->as<idl::Options>()->setOutputDir(dir);
 }
 
+idl_utf8_t idl_options_get_base_dir(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getBaseDir();
+}
+
+void idl_options_set_base_dir(idl_options_t options, idl_utf8_t dir) {
+    assert(options);
+    options->as<idl::Options>()->setBaseDir(dir);
+}
+
+idl_uint32_t idl_options_get_jobs(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getJobs();
+}
+
+void idl_options_set_jobs(idl_options_t options, idl_uint32_t jobs) {
+    assert(options);
+    options->as<idl::Options>()->setJobs(jobs);
+}
+
 void idl_options_get_import_dirs(idl_options_t options, idl_uint32_t* dir_count, idl_utf8_t* dirs) {
     assert(options);
     assert(dir_count);
@@ -264,6 +592,66 @@ void idl_options_set_version(idl_options_t options, const idl_api_version_t* ver
     options->as<idl::Options>()->setVersion(version);
 }
 
+idl_bool_t idl_options_get_import_cache(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getImportCache() ? 1 : 0;
+}
+
+void idl_options_set_import_cache(idl_options_t options, idl_bool_t enable) {
+    assert(options);
+    options->as<idl::Options>()->setImportCache(enable);
+}
+
+idl_bool_t idl_options_get_compile_cache(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getCompileCache() ? 1 : 0;
+}
+
+void idl_options_set_compile_cache(idl_options_t options, idl_bool_t enable) {
+    assert(options);
+    options->as<idl::Options>()->setCompileCache(enable);
+}
+
+idl_bool_t idl_options_get_write_if_changed(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getWriteIfChanged() ? 1 : 0;
+}
+
+void idl_options_set_write_if_changed(idl_options_t options, idl_bool_t enable) {
+    assert(options);
+    options->as<idl::Options>()->setWriteIfChanged(enable);
+}
+
+idl_utf8_t idl_options_get_depfile(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getDepfile();
+}
+
+void idl_options_set_depfile(idl_options_t options, idl_utf8_t file) {
+    assert(options);
+    options->as<idl::Options>()->setDepfile(file);
+}
+
+idl_utf8_t idl_options_get_depfile_target(idl_options_t options) {
+    assert(options);
+    return options->as<idl::Options>()->getDepfileTarget();
+}
+
+void idl_options_set_depfile_target(idl_options_t options, idl_utf8_t target) {
+    assert(options);
+    options->as<idl::Options>()->setDepfileTarget(target);
+}
+
+idl_trace_callback_t idl_options_get_tracer(idl_options_t options, idl_data_t* data) {
+    assert(options);
+    return options->as<idl::Options>()->getTracer(data);
+}
+
+void idl_options_set_tracer(idl_options_t options, idl_trace_callback_t callback, idl_data_t data) {
+    assert(options);
+    return options->as<idl::Options>()->setTracer(callback, data);
+}
+
 idl_result_t idl_compiler_create(idl_compiler_t* compiler) {
     assert(compiler);
     return idl::Object::create<idl::Compiler>(*compiler);
@@ -294,13 +682,69 @@ idl_result_t idl_compiler_compile(idl_compiler_t compiler,
             return resultCode;
         }
     }
-    return compiler->as<idl::Compiler>()->compile(generator,
+    return compiler->as<idl::Compiler>()->compile(std::span{ &generator, 1 },
                                                   file,
                                                   std::span{ sources, source_count },
                                                   options ? options->as<idl::Options>() : nullptr,
                                                   result ? (*result)->as<idl::CompilationResult>() : nullptr);
 }
 
+idl_result_t idl_compiler_compile_multi(idl_compiler_t compiler,
+                                        idl_uint32_t generator_count,
+                                        const idl_generator_t* generators,
+                                        idl_utf8_t file,
+                                        idl_uint32_t source_count,
+                                        const idl_source_t* sources,
+                                        idl_options_t options,
+                                        idl_compilation_result_t* result) {
+    if (result) {
+        const auto resultCode = idl::Object::create<idl::CompilationResult>(*result);
+        if (resultCode != IDL_RESULT_SUCCESS) {
+            return resultCode;
+        }
+    }
+    return compiler->as<idl::Compiler>()->compile(std::span{ generators, generator_count },
+                                                  file,
+                                                  std::span{ sources, source_count },
+                                                  options ? options->as<idl::Options>() : nullptr,
+                                                  result ? (*result)->as<idl::CompilationResult>() : nullptr);
+}
+
+idl_result_t idl_compiler_compile_batch(idl_compiler_t compiler,
+                                        idl_uint32_t job_count,
+                                        const idl_compile_job_t* jobs,
+                                        idl_compilation_result_t* results) {
+    assert(compiler);
+    assert(jobs || job_count == 0);
+    assert(results || job_count == 0);
+    for (idl_uint32_t i = 0; i < job_count; ++i) {
+        const auto resultCode = idl::Object::create<idl::CompilationResult>(results[i]);
+        if (resultCode != IDL_RESULT_SUCCESS) {
+            for (idl_uint32_t j = 0; j < i; ++j) {
+                idl_compilation_result_destroy(results[j]);
+                results[j] = nullptr;
+            }
+            return resultCode;
+        }
+    }
+    return compiler->as<idl::Compiler>()->compileBatch(std::span{ jobs, job_count }, std::span{ results, job_count });
+}
+
+void idl_compiler_invalidate_cache(idl_compiler_t compiler, idl_utf8_t file) {
+    assert(compiler);
+    compiler->as<idl::Compiler>()->invalidateCache(file);
+}
+
+idl_uint32_t idl_compiler_get_cache_hits(idl_compiler_t compiler) {
+    assert(compiler);
+    return compiler->as<idl::Compiler>()->getCacheHits();
+}
+
+idl_uint32_t idl_compiler_get_cache_misses(idl_compiler_t compiler) {
+    assert(compiler);
+    return compiler->as<idl::Compiler>()->getCacheMisses();
+}
+
 idl_compilation_result_t idl_compilation_result_reference(idl_compilation_result_t compilation_result) {
     assert(compilation_result);
     compilation_result->reference();
@@ -330,3 +774,32 @@ void idl_compilation_result_get_messages(idl_compilation_result_t compilation_re
     assert(message_count);
     return compilation_result->as<idl::CompilationResult>()->getMessages(*message_count, messages);
 }
+
+void idl_compilation_result_get_changed_files(idl_compilation_result_t compilation_result,
+                                              idl_uint32_t* file_count,
+                                              idl_utf8_t* files) {
+    assert(compilation_result);
+    assert(file_count);
+    return compilation_result->as<idl::CompilationResult>()->getChangedFiles(*file_count, files);
+}
+
+void idl_compilation_result_get_dependencies(idl_compilation_result_t compilation_result,
+                                             idl_uint32_t* file_count,
+                                             idl_utf8_t* files) {
+    assert(compilation_result);
+    assert(file_count);
+    return compilation_result->as<idl::CompilationResult>()->getDependencies(*file_count, files);
+}
+
+void idl_compilation_result_get_phase_times(idl_compilation_result_t compilation_result,
+                                            idl_uint32_t* phase_count,
+                                            idl_phase_time_t* phases) {
+    assert(compilation_result);
+    assert(phase_count);
+    return compilation_result->as<idl::CompilationResult>()->getPhaseTimes(*phase_count, phases);
+}
+
+const idl_stats_t* idl_compilation_result_get_stats(idl_compilation_result_t compilation_result) {
+    assert(compilation_result);
+    return compilation_result->as<idl::CompilationResult>()->getStats();
+}
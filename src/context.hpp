@@ -3,6 +3,8 @@
 
 #include "ast.hpp"
 #include "errors.hpp"
+#include "file_cache.hpp"
+#include "symbol_pool.hpp"
 #include "visitors.hpp"
 
 namespace idl {
@@ -12,10 +14,33 @@ public:
     Context(Options* options, CompilationResult* result) noexcept : _options(options), _result(result) {
     }
 
-    ~Context() {
-        for (auto node : _nodes) {
-            delete node;
-        }
+    size_t arenaBytes() const noexcept {
+        return _arena.bytesUsed();
+    }
+
+    size_t nodeCount() const noexcept {
+        return _nodes.size();
+    }
+
+    size_t symbolCount() const noexcept {
+        return _symbols.size();
+    }
+
+    Options* options() const noexcept {
+        return _options;
+    }
+
+    CompilationResult* result() const noexcept {
+        return _result;
+    }
+
+    void addOutput(const std::filesystem::path& path) {
+        std::lock_guard lock(_outputsMutex);
+        _outputs.push_back(path);
+    }
+
+    const std::vector<std::filesystem::path>& outputs() const noexcept {
+        return _outputs;
     }
 
     ASTApi* api() noexcept {
@@ -25,14 +50,18 @@ public:
     template <typename Node>
     Node* allocNode(const idl::location& loc) {
         static_assert(std::is_base_of<ASTNode, Node>::value, "Node must be inherited from ASTNode");
-        auto node = new (std::nothrow) Node{};
-        if (!node) {
+        Node* node{};
+        try {
+            Arena::Scope scope(_arena);
+            node = new (_arena.allocate(sizeof(Node), alignof(Node))) Node{};
+        } catch (const std::bad_alloc&) {
             err<IDL_STATUS_E2045>(loc);
         }
         if constexpr (std::is_same<Node, ASTApi>::value) {
             _api = node;
         }
         node->location = loc;
+        _kindNodes[size_t(node->kind)].push_back(uint32_t(_nodes.size()));
         _nodes.push_back(node);
         return node;
     }
@@ -50,11 +79,12 @@ public:
     }
 
     void addSymbol(ASTDecl* decl) {
-        const auto fullname = decl->fullnameLowecase();
-        if (_symbols.contains(fullname)) {
+        auto parent  = decl->parent ? decl->parent->as<ASTDecl>() : nullptr;
+        decl->nameId = _names.intern(decl->name);
+        if (!_symbols.try_emplace(symbolKey(parent ? scopeId(parent) : 0, decl->nameId), decl).second) {
             err<IDL_STATUS_E2030>(decl->location, decl->fullname());
         }
-        _symbols[fullname] = decl;
+        scopeId(decl);
         if (!_files.empty()) {
             decl->file = _files.back();
             _files.back()->decls.push_back(decl);
@@ -62,32 +92,26 @@ public:
     }
 
     void addDocSymbol(ASTDocDecl* decl) {
-        const auto fullname = decl->fullnameLowecase();
-        if (_docSymbols.contains(fullname)) {
+        decl->nameId = _names.intern(decl->fullname());
+        if (!_docSymbols.try_emplace(decl->nameId, decl).second) {
             err<IDL_STATUS_E2030>(decl->location, decl->fullname());
         }
-        _docSymbols[fullname] = decl;
     }
 
-    ASTDecl* findSymbol(ASTDecl* decl, const idl::location& loc, const std::string& name, bool onlyType = false) {
-        auto nameLower = name;
-        std::transform(nameLower.begin(), nameLower.end(), nameLower.begin(), [](auto c) {
-            return std::tolower(c);
-        });
+    ASTDecl* findSymbol(ASTDecl* decl, const idl::location& loc, std::string_view name, bool onlyType = false) {
         while (decl) {
-            const auto fullname = decl->fullnameLowecase() + '.' + nameLower;
-            if (auto it = _symbols.find(fullname); it != _symbols.end()) {
-                const auto actualName   = decl->fullname() + '.' + name;
-                const auto expectedName = it->second->fullname();
-                if (actualName != expectedName) {
-                    err<IDL_STATUS_E2037>(loc, actualName, expectedName);
+            bool exactCase{};
+            if (auto symbol = lookupSymbol(decl, name, exactCase)) {
+                if (!exactCase) {
+                    const auto actualName = std::string(decl->fullname()).append(1, '.').append(name);
+                    err<IDL_STATUS_E2037>(loc, actualName, symbol->fullname());
                 }
                 if (onlyType) {
-                    if (it->second->is<ASTType>()) {
-                        return it->second;
+                    if (symbol->is<ASTType>()) {
+                        return symbol;
                     }
                 } else {
-                    return it->second;
+                    return symbol;
                 }
             }
             decl = decl->parent ? decl->parent->as<ASTDecl>() : nullptr;
@@ -96,22 +120,20 @@ public:
     }
 
     ASTDecl* findSymbol(ASTDecl* decl, const idl::location& loc, ASTDeclRef* declRef, bool onlyType = false) {
-        if (!declRef->decl) {
-            auto symbol   = findSymbol(decl, loc, declRef->name, onlyType);
-            declRef->decl = symbol;
+        // A reference may be resolved by checks running on several threads
+        // (see PassManager), all of which resolve it to the same symbol.
+        std::atomic_ref<ASTDecl*> resolved(declRef->decl);
+        if (auto symbol = resolved.load(std::memory_order_relaxed)) {
             return symbol;
-        } else {
-            return declRef->decl;
         }
+        auto symbol = findSymbol(decl, loc, declRef->name, onlyType);
+        resolved.store(symbol, std::memory_order_relaxed);
+        return symbol;
     }
 
     ASTDecl* findDocSymbol(ASTDeclRef* declRef) {
         if (!declRef->decl) {
-            auto nameLower = declRef->name;
-            std::transform(nameLower.begin(), nameLower.end(), nameLower.begin(), [](auto c) {
-                return std::tolower(c);
-            });
-            auto it       = _docSymbols.find(nameLower);
+            auto it       = _docSymbols.find(_names.find(declRef->name));
             declRef->decl = it != _docSymbols.end() ? it->second : nullptr;
             return declRef->decl;
         } else {
@@ -168,13 +190,13 @@ public:
             node->name        = std::move(name);
             node->parent      = _api;
             node->doc         = allocNode<ASTDoc>(loc);
-            node->doc->detail = std::move(doc);
+            node->doc->detail.assign(doc.begin(), doc.end());
             node->doc->parent = node;
 
             auto attr    = allocNode<ASTAttrCName>(loc);
             attr->name   = cname;
             attr->parent = node;
-            node->attrs.push_back(attr);
+            node->addAttr(attr);
 
             addSymbol(node);
         };
@@ -202,7 +224,7 @@ public:
 #ifdef IDL_PLATFORM_WINDOWS
         gmtime_s(&buf, &now);
 #else
-        buf = *std::gmtime(&now);
+        gmtime_r(&now, &buf);
 #endif
         auto year   = allocNode<ASTYear>(loc);
         year->name  = "Year";
@@ -238,15 +260,12 @@ public:
     }
 
     void addAttrs(ASTDecl* node, const std::vector<ASTAttr*>& attrs) {
-        node->attrs.insert(node->attrs.end(), attrs.begin(), attrs.end());
-        std::set<std::type_index> uniqueAttrs;
-        for (auto attr : node->attrs) {
-            if (uniqueAttrs.contains(typeid(*attr))) {
+        for (auto attr : attrs) {
+            if (!node->addAttr(attr)) {
                 AttrName name;
                 attr->accept(name);
                 err<IDL_STATUS_E2013>(attr->location, name.str);
             }
-            uniqueAttrs.insert(typeid(*attr));
         }
         AllowedAttrs allowAttrs{};
         node->accept(allowAttrs);
@@ -267,732 +286,708 @@ public:
         }
     }
 
-    void prepareEnumConsts() {
-        std::vector<ASTEnumConst*> needAddTypeAttrs{};
-        filter<ASTEnum>([this, &needAddTypeAttrs](ASTEnum* en) {
-            if (en->consts.empty()) {
-                err<IDL_STATUS_E2026>(en->location, en->name);
-                return false;
+    // The semantic analysis is split into passes over the declarations of
+    // one kind, which are scheduled by PassManager (see addSemanticPasses).
+    // The checks of a pass do not change the AST: the implicit attributes
+    // they find and the warnings they report are staged, and committed by
+    // commitStaged once every declaration of the pass has been checked. This
+    // lets PassManager check the declarations of a pass on several threads.
+
+    void prepareEnumConsts(ASTEnum* en) {
+        if (en->consts.empty()) {
+            err<IDL_STATUS_E2026>(en->location, en->name);
+            return;
+        }
+        for (auto ec : en->consts) {
+            if (!ec->findAttr<ASTAttrType>()) {
+                stageType(0, ec, "Int32");
             }
-            for (auto ec : en->consts) {
-                if (!ec->findAttr<ASTAttrType>()) {
-                    needAddTypeAttrs.push_back(ec);
-                }
-                if (ec->findAttr<ASTAttrNoError>() && !en->findAttr<ASTAttrErrorCode>()) {
-                    err<IDL_STATUS_E2072>(ec->location, ec->name, en->fullname());
-                }
+            if (ec->findAttr<ASTAttrNoError>() && !en->findAttr<ASTAttrErrorCode>()) {
+                err<IDL_STATUS_E2072>(ec->location, ec->name, en->fullname());
             }
-            return true;
-        });
-        for (auto ec : needAddTypeAttrs) {
-            auto attr          = allocNode<ASTAttrType>(ec->location);
-            attr->parent       = ec;
-            attr->type         = allocNode<ASTDeclRef>(ec->location);
-            attr->type->name   = "Int32";
-            attr->type->parent = attr;
-            ec->attrs.push_back(attr);
         }
+    }
 
-        std::vector<ASTEnumConst*> needAddValueAttrs{};
-        filter<ASTEnum>([this, &needAddValueAttrs](ASTEnum* en) {
-            std::vector<ASTEnumConst*> deps;
-            for (auto ec : en->consts) {
-                calcEnumConst(ec, deps);
-                if (!ec->findAttr<ASTAttrValue>()) {
-                    needAddValueAttrs.push_back(ec);
-                }
+    void prepareEnumValues(ASTEnum* en) {
+        std::vector<ASTEnumConst*> deps;
+        for (auto ec : en->consts) {
+            calcEnumConst(ec, deps);
+            if (!ec->findAttr<ASTAttrValue>()) {
+                stageValue(0, ec);
             }
-            return true;
-        });
-        for (auto ec : needAddValueAttrs) {
-            auto attr    = allocNode<ASTAttrValue>(ec->location);
-            attr->parent = ec;
-            attr->value  = internInt(ec->location, (int64_t) ec->value);
-            ec->attrs.push_back(attr);
         }
     }
 
-    void prepareStructs() {
-        std::vector<ASTField*> needAddType{};
-        std::vector<ASTField*> needAddRef{};
-        filter<ASTStruct>([this, &needAddType, &needAddRef](ASTStruct* node) {
-            if (node->fields.empty()) {
-                err<IDL_STATUS_E2081>(node->location, node->fullname());
+    void prepareStruct(ASTStruct* node) {
+        if (node->fields.empty()) {
+            err<IDL_STATUS_E2081>(node->location, node->fullname());
+        }
+        for (auto field : node->fields) {
+            if (!field->findAttr<ASTAttrType>()) {
+                stageType(0, field, "Int32");
             }
-            for (auto field : node->fields) {
-                if (!field->findAttr<ASTAttrType>()) {
-                    needAddType.push_back(field);
-                }
-                if (auto attr = field->findAttr<ASTAttrArray>()) {
-                    if (attr->ref) {
-                        if (field->findAttr<ASTAttrRef>() == nullptr) {
-                            needAddRef.push_back(field);
-                        }
-                    } else if (attr->size < 1) {
-                        err<IDL_STATUS_E2077>(field->location, field->name, node->fullname());
+            if (auto attr = field->findAttr<ASTAttrArray>()) {
+                if (attr->ref) {
+                    if (field->findAttr<ASTAttrRef>() == nullptr) {
+                        stageAttr<ASTAttrRef>(1, field);
                     }
+                } else if (attr->size < 1) {
+                    err<IDL_STATUS_E2077>(field->location, field->name, node->fullname());
                 }
-                if (field->findAttr<ASTAttrArray>() && field->findAttr<ASTAttrDataSize>()) {
-                    err<IDL_STATUS_E2124>(field->location, field->fullname());
-                }
-                if (auto value = field->findAttr<ASTAttrValue>()) {
-                    if (auto literalConsts = value->value->as<ASTLiteralConsts>()) {
-                        std::set<ASTDecl*> uniqueDecls;
-                        for (auto declRef : literalConsts->decls) {
-                            auto decl = findSymbol(node, declRef->location, declRef);
-                            if (uniqueDecls.contains(decl)) {
-                                err<IDL_STATUS_E2039>(decl->location, decl->fullname());
-                            }
-                            uniqueDecls.insert(decl);
+            }
+            if (field->findAttr<ASTAttrArray>() && field->findAttr<ASTAttrDataSize>()) {
+                err<IDL_STATUS_E2124>(field->location, field->fullname());
+            }
+            if (auto value = field->findAttr<ASTAttrValue>()) {
+                if (auto literalConsts = value->value->as<ASTLiteralConsts>()) {
+                    std::set<ASTDecl*> uniqueDecls;
+                    for (auto declRef : literalConsts->decls) {
+                        auto decl = findSymbol(node, declRef->location, declRef);
+                        if (uniqueDecls.contains(decl)) {
+                            err<IDL_STATUS_E2039>(decl->location, decl->fullname());
                         }
+                        uniqueDecls.insert(decl);
                     }
                 }
             }
-        });
-        for (auto field : needAddType) {
-            auto attr          = allocNode<ASTAttrType>(field->location);
-            attr->parent       = field;
-            attr->type         = allocNode<ASTDeclRef>(field->location);
-            attr->type->name   = "Int32";
-            attr->type->parent = attr;
-            field->attrs.push_back(attr);
         }
-        for (auto field : needAddRef) {
-            auto attr    = allocNode<ASTAttrRef>(field->location);
-            attr->parent = field;
-            field->attrs.push_back(attr);
-        }
-        filter<ASTStruct>([this](ASTStruct* node) {
-            for (auto field : node->fields) {
-                auto attr = field->findAttr<ASTAttrType>();
-                if (resolveType(attr->type)->is<ASTVoid>()) {
-                    err<IDL_STATUS_E2068>(field->location, field->name, node->fullname());
-                }
+    }
+
+    void checkStructFieldTypes(ASTStruct* node) {
+        for (auto field : node->fields) {
+            auto attr = field->findAttr<ASTAttrType>();
+            if (resolveType(attr->type)->is<ASTVoid>()) {
+                err<IDL_STATUS_E2068>(field->location, field->name, node->fullname());
             }
-        });
-        filter<ASTStruct>([this](ASTStruct* node) {
-            for (auto field : node->fields) {
-                if (auto attr = field->findAttr<ASTAttrArray>(); attr && attr->ref) {
-                    auto symbol = findSymbol(node, attr->location, attr->decl);
-                    if (auto sizeField = symbol->as<ASTField>()) {
-                        auto parent1 = node;
-                        auto parent2 = symbol;
-                        while (true) {
-                            auto st = parent1->parent->as<ASTStruct>();
-                            if (st == nullptr) {
-                                break;
-                            }
-                            parent1 = st;
-                        }
-                        while (true) {
-                            auto st = parent2->parent->as<ASTStruct>();
-                            if (st == nullptr) {
-                                break;
-                            }
-                            parent2 = st;
-                        }
-                        if (parent1 != parent2) {
-                            err<IDL_STATUS_E2079>(field->location);
+        }
+    }
+
+    void checkStructArrays(ASTStruct* node) {
+        for (auto field : node->fields) {
+            if (auto attr = field->findAttr<ASTAttrArray>(); attr && attr->ref) {
+                auto symbol = findSymbol(node, attr->location, attr->decl);
+                if (auto sizeField = symbol->as<ASTField>()) {
+                    auto parent1 = node;
+                    auto parent2 = symbol;
+                    while (true) {
+                        auto st = parent1->parent->as<ASTStruct>();
+                        if (st == nullptr) {
+                            break;
                         }
-                        auto type = resolveType(sizeField->findAttr<ASTAttrType>()->type);
-                        if (!type->is<ASTIntegerType>()) {
-                            err<IDL_STATUS_E2080>(attr->location, field->fullname());
+                        parent1 = st;
+                    }
+                    while (true) {
+                        auto st = parent2->parent->as<ASTStruct>();
+                        if (st == nullptr) {
+                            break;
                         }
-                    } else {
-                        err<IDL_STATUS_E2078>(attr->location, field->fullname());
+                        parent2 = st;
                     }
-                }
-                if (auto attr = field->findAttr<ASTAttrDataSize>()) {
-                    auto dataType = resolveType(field->findAttr<ASTAttrType>()->type);
-                    if (!dataType->is<ASTData>() && !dataType->is<ASTConstData>()) {
-                        err<IDL_STATUS_E2119>(attr->location, field->name, node->fullname());
+                    if (parent1 != parent2) {
+                        err<IDL_STATUS_E2079>(field->location);
                     }
-                    auto symbol = findSymbol(node, attr->location, attr->decl);
-                    if (auto sizeField = symbol->as<ASTField>()) {
-                        auto parent1 = node;
-                        auto parent2 = symbol;
-                        while (true) {
-                            auto st = parent1->parent->as<ASTStruct>();
-                            if (st == nullptr) {
-                                break;
-                            }
-                            parent1 = st;
-                        }
-                        while (true) {
-                            auto st = parent2->parent->as<ASTStruct>();
-                            if (st == nullptr) {
-                                break;
-                            }
-                            parent2 = st;
-                        }
-                        if (parent1 != parent2) {
-                            err<IDL_STATUS_E2118>(field->location);
+                    auto type = resolveType(sizeField->findAttr<ASTAttrType>()->type);
+                    if (!type->is<ASTIntegerType>()) {
+                        err<IDL_STATUS_E2080>(attr->location, field->fullname());
+                    }
+                } else {
+                    err<IDL_STATUS_E2078>(attr->location, field->fullname());
+                }
+            }
+            if (auto attr = field->findAttr<ASTAttrDataSize>()) {
+                auto dataType = resolveType(field->findAttr<ASTAttrType>()->type);
+                if (!dataType->is<ASTData>() && !dataType->is<ASTConstData>()) {
+                    err<IDL_STATUS_E2119>(attr->location, field->name, node->fullname());
+                }
+                auto symbol = findSymbol(node, attr->location, attr->decl);
+                if (auto sizeField = symbol->as<ASTField>()) {
+                    auto parent1 = node;
+                    auto parent2 = symbol;
+                    while (true) {
+                        auto st = parent1->parent->as<ASTStruct>();
+                        if (st == nullptr) {
+                            break;
                         }
-                        auto type = resolveType(sizeField->findAttr<ASTAttrType>()->type);
-                        if (!type->is<ASTIntegerType>()) {
-                            err<IDL_STATUS_E2114>(attr->location, field->fullname());
+                        parent1 = st;
+                    }
+                    while (true) {
+                        auto st = parent2->parent->as<ASTStruct>();
+                        if (st == nullptr) {
+                            break;
                         }
-                    } else {
-                        err<IDL_STATUS_E2113>(attr->location, field->fullname());
+                        parent2 = st;
+                    }
+                    if (parent1 != parent2) {
+                        err<IDL_STATUS_E2118>(field->location);
                     }
+                    auto type = resolveType(sizeField->findAttr<ASTAttrType>()->type);
+                    if (!type->is<ASTIntegerType>()) {
+                        err<IDL_STATUS_E2114>(attr->location, field->fullname());
+                    }
+                } else {
+                    err<IDL_STATUS_E2113>(attr->location, field->fullname());
                 }
             }
-        });
+        }
     }
 
     template <typename T>
-    void prepareInvokable() {
-        std::vector<T*> needAddRetType{};
-        std::vector<T*> needAddStatic{};
-        std::vector<ASTArg*> needAddArgType{};
-        std::vector<ASTArg*> needAddArgIn{};
-        std::vector<ASTArg*> needAddArgOut{};
-        std::vector<ASTArg*> needAddRef{};
-        std::vector<ASTDecl*> needAddOptional{};
-        filter<T>([this,
-                   &needAddRetType,
-                   &needAddStatic,
-                   &needAddArgType,
-                   &needAddArgIn,
-                   &needAddArgOut,
-                   &needAddRef,
-                   &needAddOptional](T* node) {
-            const auto isMethod = std::is_same_v<T, ASTMethod>;
-            const auto isStatic = isMethod && node->template findAttr<ASTAttrStatic>();
-            const auto isCtor   = isMethod && node->template findAttr<ASTAttrCtor>();
-            if (!node->template findAttr<ASTAttrType>()) {
-                needAddRetType.push_back(node);
-            }
-            if (isCtor && !isStatic) {
-                needAddStatic.push_back(node);
-            }
-            if (isCtor || isStatic) {
-                for (auto arg : node->args) {
-                    if (arg->template findAttr<ASTAttrThis>()) {
-                        if (isCtor) {
-                            err<IDL_STATUS_E2047>(arg->location, node->fullname(), arg->name);
-                        } else {
-                            err<IDL_STATUS_E2046>(arg->location, node->fullname(), arg->name);
-                        }
+    void prepareInvokable(T* node) {
+        const auto isMethod = std::is_same_v<T, ASTMethod>;
+        const auto isStatic = isMethod && node->template findAttr<ASTAttrStatic>();
+        const auto isCtor   = isMethod && node->template findAttr<ASTAttrCtor>();
+        if (!node->template findAttr<ASTAttrType>()) {
+            stageType(0, node, "Void");
+        }
+        if (isCtor && !isStatic) {
+            stageAttr<ASTAttrStatic>(1, node);
+        }
+        if (isCtor || isStatic) {
+            for (auto arg : node->args) {
+                if (arg->template findAttr<ASTAttrThis>()) {
+                    if (isCtor) {
+                        err<IDL_STATUS_E2047>(arg->location, node->fullname(), arg->name);
+                    } else {
+                        err<IDL_STATUS_E2046>(arg->location, node->fullname(), arg->name);
                     }
                 }
             }
-            if (isMethod && !isCtor && !isStatic) {
-                int countThis = 0;
-                for (auto arg : node->args) {
-                    countThis += arg->template findAttr<ASTAttrThis>() ? 1 : 0;
-                }
-                if (countThis != 1) {
-                    err<IDL_STATUS_E2048>(node->location, node->fullname());
-                }
-            }
-            int countUserData = 0;
-            int countResult   = 0;
+        }
+        if (isMethod && !isCtor && !isStatic) {
+            int countThis = 0;
             for (auto arg : node->args) {
-                if (!arg->template findAttr<ASTAttrType>()) {
-                    needAddArgType.push_back(arg);
-                }
-                auto hasOut = arg->template findAttr<ASTAttrOut>() != nullptr;
-                if (arg->template findAttr<ASTAttrResult>() && !hasOut) {
-                    needAddArgOut.push_back(arg);
-                    hasOut = true;
-                }
-                if (!hasOut && !arg->template findAttr<ASTAttrIn>()) {
-                    needAddArgIn.push_back(arg);
-                }
-                if (!isMethod && arg->template findAttr<ASTAttrThis>()) {
-                    if constexpr (std::is_same_v<T, ASTCallback>) {
-                        err<IDL_STATUS_E2083>(arg->location, node->fullname(), arg->name);
-                    } else if constexpr (std::is_same_v<T, ASTFunc>) {
-                        err<IDL_STATUS_E2073>(arg->location, node->fullname(), arg->name);
-                    }
-                }
-                countUserData += arg->template findAttr<ASTAttrUserData>() ? 1 : 0;
-                countResult += arg->template findAttr<ASTAttrResult>() ? 1 : 0;
-                if (countUserData > 1) {
-                    err<IDL_STATUS_E2082>(arg->location);
-                }
-                if (countResult > 1) {
-                    err<IDL_STATUS_E2084>(arg->location);
+                countThis += arg->template findAttr<ASTAttrThis>() ? 1 : 0;
+            }
+            if (countThis != 1) {
+                err<IDL_STATUS_E2048>(node->location, node->fullname());
+            }
+        }
+        int countUserData = 0;
+        int countResult   = 0;
+        for (auto arg : node->args) {
+            if (!arg->template findAttr<ASTAttrType>()) {
+                stageType(2, arg, "Int32");
+            }
+            auto hasOut = arg->template findAttr<ASTAttrOut>() != nullptr;
+            if (arg->template findAttr<ASTAttrResult>() && !hasOut) {
+                stageAttr<ASTAttrOut>(4, arg);
+                hasOut = true;
+            }
+            if (!hasOut && !arg->template findAttr<ASTAttrIn>()) {
+                stageAttr<ASTAttrIn>(3, arg);
+            }
+            if (!isMethod && arg->template findAttr<ASTAttrThis>()) {
+                if constexpr (std::is_same_v<T, ASTCallback>) {
+                    err<IDL_STATUS_E2083>(arg->location, node->fullname(), arg->name);
+                } else if constexpr (std::is_same_v<T, ASTFunc>) {
+                    err<IDL_STATUS_E2073>(arg->location, node->fullname(), arg->name);
                 }
-                if (auto attr = arg->template findAttr<ASTAttrArray>()) {
-                    if (attr->ref) {
-                        if (arg->template findAttr<ASTAttrRef>() == nullptr) {
-                            needAddRef.push_back(arg);
-                        }
-                    } else {
-                        err<IDL_STATUS_E2102>(arg->location, arg->name, node->fullname());
+            }
+            countUserData += arg->template findAttr<ASTAttrUserData>() ? 1 : 0;
+            countResult += arg->template findAttr<ASTAttrResult>() ? 1 : 0;
+            if (countUserData > 1) {
+                err<IDL_STATUS_E2082>(arg->location);
+            }
+            if (countResult > 1) {
+                err<IDL_STATUS_E2084>(arg->location);
+            }
+            if (auto attr = arg->template findAttr<ASTAttrArray>()) {
+                if (attr->ref) {
+                    if (arg->template findAttr<ASTAttrRef>() == nullptr) {
+                        stageAttr<ASTAttrRef>(5, arg);
                     }
-                }
-                if (arg->template findAttr<ASTAttrArray>() && arg->template findAttr<ASTAttrDataSize>()) {
-                    err<IDL_STATUS_E2124>(arg->location, arg->fullname());
+                } else {
+                    err<IDL_STATUS_E2102>(arg->location, arg->name, node->fullname());
                 }
             }
-        });
-        for (auto node : needAddRetType) {
-            auto attr          = allocNode<ASTAttrType>(node->location);
-            attr->parent       = node;
-            attr->type         = allocNode<ASTDeclRef>(node->location);
-            attr->type->name   = "Void";
-            attr->type->parent = attr;
-            node->attrs.push_back(attr);
-        }
-        for (auto node : needAddStatic) {
-            auto attr    = allocNode<ASTAttrStatic>(node->location);
-            attr->parent = node;
-            node->attrs.push_back(attr);
-        }
-        for (auto node : needAddArgType) {
-            auto attr          = allocNode<ASTAttrType>(node->location);
-            attr->parent       = node;
-            attr->type         = allocNode<ASTDeclRef>(node->location);
-            attr->type->name   = "Int32";
-            attr->type->parent = attr;
-            node->attrs.push_back(attr);
-        }
-        for (auto node : needAddArgIn) {
-            auto attr    = allocNode<ASTAttrIn>(node->location);
-            attr->parent = node;
-            node->attrs.push_back(attr);
-        }
-        for (auto node : needAddArgOut) {
-            auto attr    = allocNode<ASTAttrOut>(node->location);
-            attr->parent = node;
-            node->attrs.push_back(attr);
+            if (arg->template findAttr<ASTAttrArray>() && arg->template findAttr<ASTAttrDataSize>()) {
+                err<IDL_STATUS_E2124>(arg->location, arg->fullname());
+            }
         }
-        for (auto node : needAddRef) {
-            auto attr    = allocNode<ASTAttrRef>(node->location);
-            attr->parent = node;
-            node->attrs.push_back(attr);
+    }
+
+    template <typename T>
+    void checkInvokable(T* node) {
+        auto attr    = node->template findAttr<ASTAttrType>();
+        auto retType = resolveType(attr->type);
+        if (retType->template is<ASTCallback>() && !node->template findAttr<ASTAttrOptional>()) {
+            stageAttr<ASTAttrOptional>(0, node);
         }
-        filter<T>([this, &needAddOptional](T* node) {
-            auto attr    = node->template findAttr<ASTAttrType>();
-            auto retType = resolveType(attr->type);
-            if (retType->template is<ASTCallback>() && !node->template findAttr<ASTAttrOptional>()) {
-                needAddOptional.push_back(node);
-            }
-            for (auto arg : node->args) {
-                auto argAttr = arg->template findAttr<ASTAttrType>();
-                if (resolveType(argAttr->type)->template is<ASTVoid>()) {
-                    if constexpr (std::is_same_v<T, ASTMethod>) {
-                        err<IDL_STATUS_E2051>(arg->location, arg->name, node->fullname());
-                    } else {
-                        err<IDL_STATUS_E2074>(arg->location, arg->name, node->fullname());
-                    }
+        for (auto arg : node->args) {
+            auto argAttr = arg->template findAttr<ASTAttrType>();
+            if (resolveType(argAttr->type)->template is<ASTVoid>()) {
+                if constexpr (std::is_same_v<T, ASTMethod>) {
+                    err<IDL_STATUS_E2051>(arg->location, arg->name, node->fullname());
+                } else {
+                    err<IDL_STATUS_E2074>(arg->location, arg->name, node->fullname());
                 }
-                if (auto attr = arg->template findAttr<ASTAttrArray>(); attr) {
-                    assert(attr->ref);
-                    auto symbol = findSymbol(node, attr->location, attr->decl);
-                    if (auto sizeField = symbol->template as<ASTArg>()) {
-                        if (arg->parent != sizeField->parent) {
-                            if constexpr (std::is_same_v<T, ASTCallback>) {
-                                err<IDL_STATUS_E2107>(arg->location);
-                            } else if constexpr (std::is_same_v<T, ASTFunc>) {
-                                err<IDL_STATUS_E2105>(arg->location);
-                            } else if constexpr (std::is_same_v<T, ASTMethod>) {
-                                err<IDL_STATUS_E2103>(arg->location);
-                            } else {
-                                assert(!"unknown invokable");
-                            }
-                        }
-                        auto type = resolveType(sizeField->template findAttr<ASTAttrType>()->type);
-                        if (!type->template is<ASTIntegerType>()) {
-                            err<IDL_STATUS_E2080>(attr->location, arg->fullname());
-                        }
-                    } else {
+            }
+            if (auto attr = arg->template findAttr<ASTAttrArray>(); attr) {
+                assert(attr->ref);
+                auto symbol = findSymbol(node, attr->location, attr->decl);
+                if (auto sizeField = symbol->template as<ASTArg>()) {
+                    if (arg->parent != sizeField->parent) {
                         if constexpr (std::is_same_v<T, ASTCallback>) {
-                            err<IDL_STATUS_E2108>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2107>(arg->location);
                         } else if constexpr (std::is_same_v<T, ASTFunc>) {
-                            err<IDL_STATUS_E2106>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2105>(arg->location);
                         } else if constexpr (std::is_same_v<T, ASTMethod>) {
-                            err<IDL_STATUS_E2104>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2103>(arg->location);
                         } else {
                             assert(!"unknown invokable");
                         }
                     }
-                }
-                if (auto attr = arg->template findAttr<ASTAttrDataSize>(); attr) {
-                    auto symbol   = findSymbol(node, attr->location, attr->decl);
-                    auto dataType = resolveType(arg->template findAttr<ASTAttrType>()->type);
-                    if (!dataType->template is<ASTData>() && !dataType->template is<ASTConstData>()) {
-                        err<IDL_STATUS_E2121>(attr->location, arg->name, node->fullname());
+                    auto type = resolveType(sizeField->template findAttr<ASTAttrType>()->type);
+                    if (!type->template is<ASTIntegerType>()) {
+                        err<IDL_STATUS_E2080>(attr->location, arg->fullname());
                     }
-                    if (auto sizeField = symbol->template as<ASTArg>()) {
-                        if (arg->parent != sizeField->parent) {
-                            if constexpr (std::is_same_v<T, ASTCallback>) {
-                                err<IDL_STATUS_E2120>(arg->location);
-                            } else if constexpr (std::is_same_v<T, ASTFunc>) {
-                                err<IDL_STATUS_E2122>(arg->location);
-                            } else if constexpr (std::is_same_v<T, ASTMethod>) {
-                                err<IDL_STATUS_E2123>(attr->location, arg->fullname());
-                            } else {
-                                assert(!"unknown invokable");
-                            }
-                        }
-                        auto type = resolveType(sizeField->template findAttr<ASTAttrType>()->type);
-                        if (!type->template is<ASTIntegerType>()) {
-                            err<IDL_STATUS_E2114>(attr->location, arg->fullname());
-                        }
+                } else {
+                    if constexpr (std::is_same_v<T, ASTCallback>) {
+                        err<IDL_STATUS_E2108>(attr->location, arg->fullname());
+                    } else if constexpr (std::is_same_v<T, ASTFunc>) {
+                        err<IDL_STATUS_E2106>(attr->location, arg->fullname());
+                    } else if constexpr (std::is_same_v<T, ASTMethod>) {
+                        err<IDL_STATUS_E2104>(attr->location, arg->fullname());
                     } else {
+                        assert(!"unknown invokable");
+                    }
+                }
+            }
+            if (auto attr = arg->template findAttr<ASTAttrDataSize>(); attr) {
+                auto symbol   = findSymbol(node, attr->location, attr->decl);
+                auto dataType = resolveType(arg->template findAttr<ASTAttrType>()->type);
+                if (!dataType->template is<ASTData>() && !dataType->template is<ASTConstData>()) {
+                    err<IDL_STATUS_E2121>(attr->location, arg->name, node->fullname());
+                }
+                if (auto sizeField = symbol->template as<ASTArg>()) {
+                    if (arg->parent != sizeField->parent) {
                         if constexpr (std::is_same_v<T, ASTCallback>) {
-                            err<IDL_STATUS_E2117>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2120>(arg->location);
                         } else if constexpr (std::is_same_v<T, ASTFunc>) {
-                            err<IDL_STATUS_E2116>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2122>(arg->location);
                         } else if constexpr (std::is_same_v<T, ASTMethod>) {
-                            err<IDL_STATUS_E2115>(attr->location, arg->fullname());
+                            err<IDL_STATUS_E2123>(attr->location, arg->fullname());
                         } else {
                             assert(!"unknown invokable");
                         }
                     }
-                }
-                if (resolveType(argAttr->type)->template is<ASTCallback>() &&
-                    !arg->template findAttr<ASTAttrOptional>()) {
-                    needAddOptional.push_back(arg);
+                    auto type = resolveType(sizeField->template findAttr<ASTAttrType>()->type);
+                    if (!type->template is<ASTIntegerType>()) {
+                        err<IDL_STATUS_E2114>(attr->location, arg->fullname());
+                    }
+                } else {
+                    if constexpr (std::is_same_v<T, ASTCallback>) {
+                        err<IDL_STATUS_E2117>(attr->location, arg->fullname());
+                    } else if constexpr (std::is_same_v<T, ASTFunc>) {
+                        err<IDL_STATUS_E2116>(attr->location, arg->fullname());
+                    } else if constexpr (std::is_same_v<T, ASTMethod>) {
+                        err<IDL_STATUS_E2115>(attr->location, arg->fullname());
+                    } else {
+                        assert(!"unknown invokable");
+                    }
                 }
             }
-            if (node->template findAttr<ASTAttrErrorCode>()) {
-                if (!std::is_same_v<T, ASTFunc>) {
-                    err<IDL_STATUS_E2125>(node->location, node->fullname());
-                }
-                auto argType        = node->args[0]->template findAttr<ASTAttrType>()->type->decl;
-                auto argIsErrorCode = argType->template findAttr<ASTAttrErrorCode>() != nullptr;
-                if (!retType->template is<ASTStr>() || node->args.size() != 1 || !argIsErrorCode) {
-                    err<IDL_STATUS_E2085>(node->location);
-                }
+            if (resolveType(argAttr->type)->template is<ASTCallback>() &&
+                !arg->template findAttr<ASTAttrOptional>()) {
+                stageAttr<ASTAttrOptional>(0, arg);
             }
-            if (node->template findAttr<ASTAttrRefInc>()) {
-                if (!std::is_same_v<T, ASTMethod>) {
-                    err<IDL_STATUS_E2126>(node->location, node->fullname());
-                }
-                if (node->template findAttr<ASTAttrStatic>() || node->args.size() != 1) {
-                    err<IDL_STATUS_E2086>(node->location);
-                }
+        }
+        if (node->template findAttr<ASTAttrErrorCode>()) {
+            if (!std::is_same_v<T, ASTFunc>) {
+                err<IDL_STATUS_E2125>(node->location, node->fullname());
             }
-            if (node->template findAttr<ASTAttrDestroy>()) {
-                if (!std::is_same_v<T, ASTMethod>) {
-                    err<IDL_STATUS_E2127>(node->location, node->fullname());
-                }
-                if (node->template findAttr<ASTAttrStatic>() || node->args.size() != 1) {
-                    err<IDL_STATUS_E2087>(node->location);
-                }
+            auto argType        = node->args[0]->template findAttr<ASTAttrType>()->type->decl;
+            auto argIsErrorCode = argType->template findAttr<ASTAttrErrorCode>() != nullptr;
+            if (!retType->template is<ASTStr>() || node->args.size() != 1 || !argIsErrorCode) {
+                err<IDL_STATUS_E2085>(node->location);
+            }
+        }
+        if (node->template findAttr<ASTAttrRefInc>()) {
+            if (!std::is_same_v<T, ASTMethod>) {
+                err<IDL_STATUS_E2126>(node->location, node->fullname());
+            }
+            if (node->template findAttr<ASTAttrStatic>() || node->args.size() != 1) {
+                err<IDL_STATUS_E2086>(node->location);
+            }
+        }
+        if (node->template findAttr<ASTAttrDestroy>()) {
+            if (!std::is_same_v<T, ASTMethod>) {
+                err<IDL_STATUS_E2127>(node->location, node->fullname());
+            }
+            if (node->template findAttr<ASTAttrStatic>() || node->args.size() != 1) {
+                err<IDL_STATUS_E2087>(node->location);
             }
-        });
-        for (auto node : needAddOptional) {
-            auto attr    = allocNode<ASTAttrOptional>(node->location);
-            attr->parent = node;
-            node->attrs.push_back(attr);
         }
     }
 
     template <typename T>
-    void prepareGetterSetter() {
-        std::vector<std::pair<T*, std::string>> needAddType{};
-        filter<T>([this, &needAddType](T* node) {
-            auto getter = node->template findAttr<ASTAttrGet>();
-            auto setter = node->template findAttr<ASTAttrSet>();
-            if (!getter && !setter) {
-                if constexpr (std::is_same_v<T, ASTProperty>) {
-                    err<IDL_STATUS_E2052>(node->location, node->fullname());
-                } else {
-                    err<IDL_STATUS_E2091>(node->location, node->fullname());
-                }
+    void prepareGetterSetter(T* node) {
+        auto getter = node->template findAttr<ASTAttrGet>();
+        auto setter = node->template findAttr<ASTAttrSet>();
+        if (!getter && !setter) {
+            if constexpr (std::is_same_v<T, ASTProperty>) {
+                err<IDL_STATUS_E2052>(node->location, node->fullname());
+            } else {
+                err<IDL_STATUS_E2091>(node->location, node->fullname());
             }
-            auto isStaticProp       = node->template findAttr<ASTAttrStatic>() != nullptr;
-            ASTType* getterType     = nullptr;
-            ASTType* setterType     = nullptr;
-            ASTMethod* getterMethod = nullptr;
-            ASTMethod* setterMethod = nullptr;
-            if (getter) {
-                auto decl = findSymbol(node, getter->location, getter->decl);
-                if (auto method = decl->template as<ASTMethod>()) {
-                    getterMethod = method;
-                    if (method->parent != node->parent) {
-                        auto iface             = node->parent->template as<ASTInterface>()->fullname();
-                        auto otherIface        = method->parent->template as<ASTInterface>()->fullname();
-                        constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2054 : IDL_STATUS_E2092;
-                        err<errCode>(getter->location, node->name, iface, method->name, otherIface);
-                    }
-                    auto isStaticGetter = method->template findAttr<ASTAttrStatic>() != nullptr;
-                    if (isStaticProp != isStaticGetter) {
-                        constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2055 : IDL_STATUS_E2093;
-                        err<errCode>(getter->location, method->fullname(), node->fullname());
-                    }
-                    getterType          = resolveType(method->template findAttr<ASTAttrType>()->type);
-                    const auto argCount = method->args.size();
-
-                    if constexpr (std::is_same_v<T, ASTProperty>) {
-                        if (getterType->is<ASTVoid>()) {
-                            bool isValidProp = false;
-                            auto count       = isStaticProp ? 2 : 3;
-                            if (argCount == count) {
-                                auto res = std::find_if(method->args.begin(), method->args.end(), [](ASTArg* arg) {
-                                    return arg->findAttr<ASTAttrResult>() != nullptr;
-                                });
-                                auto arrAttr =
-                                    res != method->args.end() ? (*res)->template findAttr<ASTAttrArray>() : nullptr;
-                                if (arrAttr) {
-                                    auto arrDecl = findSymbol(node, arrAttr->location, arrAttr->decl);
-                                    if (arrDecl->template findAttr<ASTAttrOut>()) {
-                                        isValidProp = true;
-                                        if ((*res)->template findAttr<ASTAttrType>()) {
-                                            getterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
-                                        }
-                                    }
-                                }
-                                auto datasizeAttr =
-                                    res != method->args.end() ? (*res)->template findAttr<ASTAttrDataSize>() : nullptr;
-                                if (datasizeAttr) {
-                                    auto datasizeDecl = findSymbol(node, datasizeAttr->location, datasizeAttr->decl);
-                                    if (datasizeDecl->template findAttr<ASTAttrOut>()) {
-                                        isValidProp = true;
-                                        if ((*res)->template findAttr<ASTAttrType>()) {
-                                            getterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
-                                        }
-                                    }
-                                }
-                            }
-                            if (!isValidProp) {
-                                err<IDL_STATUS_E2058>(getter->location, method->fullname());
-                            }
-                        } else {
-                            if (isStaticProp && argCount != 0) {
-                                err<IDL_STATUS_E2056>(getter->location, method->fullname());
-                            } else if (!isStaticProp && argCount != 1) {
-                                err<IDL_STATUS_E2057>(getter->location, method->fullname());
-                            }
-                        }
-                    } else if (std::is_same_v<T, ASTEvent>) {
-                        if (isStaticProp) {
-                            if ((argCount == 1 && !method->args[0]->template findAttr<ASTAttrUserData>()) ||
-                                argCount > 1) {
-                                err<IDL_STATUS_E2094>(getter->location, method->fullname());
-                            }
-                        } else {
-                            if (argCount == 2 && (!method->args[0]->template findAttr<ASTAttrUserData>() &&
-                                                  !method->args[1]->template findAttr<ASTAttrUserData>())) {
-                                err<IDL_STATUS_E2095>(getter->location, method->fullname());
-                            } else if (argCount > 2) {
-                                err<IDL_STATUS_E2095>(getter->location, method->fullname());
-                            }
-                        }
-                        getterType = resolveType(method->template findAttr<ASTAttrType>()->type);
-                        if (getterType->is<ASTVoid>()) {
-                            err<IDL_STATUS_E2058>(getter->location, method->fullname());
-                        }
-                    }
-                } else {
-                    err<IDL_STATUS_E2053>(getter->location, decl->fullname());
+        }
+        auto isStaticProp       = node->template findAttr<ASTAttrStatic>() != nullptr;
+        ASTType* getterType     = nullptr;
+        ASTType* setterType     = nullptr;
+        ASTMethod* getterMethod = nullptr;
+        ASTMethod* setterMethod = nullptr;
+        if (getter) {
+            auto decl = findSymbol(node, getter->location, getter->decl);
+            if (auto method = decl->template as<ASTMethod>()) {
+                getterMethod = method;
+                if (method->parent != node->parent) {
+                    auto iface             = node->parent->template as<ASTInterface>()->fullname();
+                    auto otherIface        = method->parent->template as<ASTInterface>()->fullname();
+                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2054 : IDL_STATUS_E2092;
+                    err<errCode>(getter->location, node->name, iface, method->name, otherIface);
                 }
-            }
-            if (setter) {
-                auto decl = findSymbol(node, setter->location, setter->decl);
-                if (auto method = decl->template as<ASTMethod>()) {
-                    setterMethod = method;
-                    if (method->parent != node->parent) {
-                        auto iface             = node->parent->template as<ASTInterface>()->fullname();
-                        auto otherIface        = method->parent->template as<ASTInterface>()->fullname();
-                        constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2061 : IDL_STATUS_E2096;
-                        err<errCode>(setter->location, node->name, iface, method->name, otherIface);
-                    }
-                    auto isStaticSetter = method->template findAttr<ASTAttrStatic>() != nullptr;
-                    if (isStaticProp != isStaticSetter) {
-                        constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2060 : IDL_STATUS_E2097;
-                        err<errCode>(setter->location, method->fullname(), node->fullname());
-                    }
-                    auto isValid        = false;
-                    const auto argCount = method->args.size();
+                auto isStaticGetter = method->template findAttr<ASTAttrStatic>() != nullptr;
+                if (isStaticProp != isStaticGetter) {
+                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2055 : IDL_STATUS_E2093;
+                    err<errCode>(getter->location, method->fullname(), node->fullname());
+                }
+                getterType          = resolveType(method->template findAttr<ASTAttrType>()->type);
+                const auto argCount = method->args.size();
 
-                    if constexpr (std::is_same_v<T, ASTProperty>) {
-                        if (argCount == (isStaticProp ? 2 : 3)) {
+                if constexpr (std::is_same_v<T, ASTProperty>) {
+                    if (getterType->is<ASTVoid>()) {
+                        bool isValidProp = false;
+                        auto count       = isStaticProp ? 2 : 3;
+                        if (argCount == count) {
                             auto res = std::find_if(method->args.begin(), method->args.end(), [](ASTArg* arg) {
-                                return arg->findAttr<ASTAttrArray>() != nullptr;
+                                return arg->findAttr<ASTAttrResult>() != nullptr;
                             });
                             auto arrAttr =
                                 res != method->args.end() ? (*res)->template findAttr<ASTAttrArray>() : nullptr;
                             if (arrAttr) {
-                                auto arrDecl  = findSymbol(node, arrAttr->location, arrAttr->decl);
-                                auto sizeType = resolveType(arrDecl->template findAttr<ASTAttrType>()->type);
-                                if (sizeType->template is<ASTIntegerType>()) {
-                                    isValid = true;
+                                auto arrDecl = findSymbol(node, arrAttr->location, arrAttr->decl);
+                                if (arrDecl->template findAttr<ASTAttrOut>()) {
+                                    isValidProp = true;
                                     if ((*res)->template findAttr<ASTAttrType>()) {
-                                        setterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
+                                        getterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
                                     }
                                 }
                             }
-                            res = std::find_if(method->args.begin(), method->args.end(), [](ASTArg* arg) {
-                                return arg->findAttr<ASTAttrDataSize>() != nullptr;
-                            });
                             auto datasizeAttr =
                                 res != method->args.end() ? (*res)->template findAttr<ASTAttrDataSize>() : nullptr;
                             if (datasizeAttr) {
                                 auto datasizeDecl = findSymbol(node, datasizeAttr->location, datasizeAttr->decl);
-                                auto sizeType     = resolveType(datasizeDecl->template findAttr<ASTAttrType>()->type);
-                                if (sizeType->template is<ASTIntegerType>()) {
-                                    isValid = true;
+                                if (datasizeDecl->template findAttr<ASTAttrOut>()) {
+                                    isValidProp = true;
                                     if ((*res)->template findAttr<ASTAttrType>()) {
-                                        setterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
+                                        getterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
                                     }
                                 }
                             }
                         }
-                        if (!isValid) {
-                            if (isStaticProp && argCount != 1) {
-                                err<IDL_STATUS_E2062>(setter->location, method->fullname());
-                            } else if (!isStaticProp && argCount != 2) {
-                                err<IDL_STATUS_E2063>(setter->location, method->fullname());
+                        if (!isValidProp) {
+                            err<IDL_STATUS_E2058>(getter->location, method->fullname());
+                        }
+                    } else {
+                        if (isStaticProp && argCount != 0) {
+                            err<IDL_STATUS_E2056>(getter->location, method->fullname());
+                        } else if (!isStaticProp && argCount != 1) {
+                            err<IDL_STATUS_E2057>(getter->location, method->fullname());
+                        }
+                    }
+                } else if (std::is_same_v<T, ASTEvent>) {
+                    if (isStaticProp) {
+                        if ((argCount == 1 && !method->args[0]->template findAttr<ASTAttrUserData>()) ||
+                            argCount > 1) {
+                            err<IDL_STATUS_E2094>(getter->location, method->fullname());
+                        }
+                    } else {
+                        if (argCount == 2 && (!method->args[0]->template findAttr<ASTAttrUserData>() &&
+                                              !method->args[1]->template findAttr<ASTAttrUserData>())) {
+                            err<IDL_STATUS_E2095>(getter->location, method->fullname());
+                        } else if (argCount > 2) {
+                            err<IDL_STATUS_E2095>(getter->location, method->fullname());
+                        }
+                    }
+                    getterType = resolveType(method->template findAttr<ASTAttrType>()->type);
+                    if (getterType->is<ASTVoid>()) {
+                        err<IDL_STATUS_E2058>(getter->location, method->fullname());
+                    }
+                }
+            } else {
+                err<IDL_STATUS_E2053>(getter->location, decl->fullname());
+            }
+        }
+        if (setter) {
+            auto decl = findSymbol(node, setter->location, setter->decl);
+            if (auto method = decl->template as<ASTMethod>()) {
+                setterMethod = method;
+                if (method->parent != node->parent) {
+                    auto iface             = node->parent->template as<ASTInterface>()->fullname();
+                    auto otherIface        = method->parent->template as<ASTInterface>()->fullname();
+                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2061 : IDL_STATUS_E2096;
+                    err<errCode>(setter->location, node->name, iface, method->name, otherIface);
+                }
+                auto isStaticSetter = method->template findAttr<ASTAttrStatic>() != nullptr;
+                if (isStaticProp != isStaticSetter) {
+                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2060 : IDL_STATUS_E2097;
+                    err<errCode>(setter->location, method->fullname(), node->fullname());
+                }
+                auto isValid        = false;
+                const auto argCount = method->args.size();
+
+                if constexpr (std::is_same_v<T, ASTProperty>) {
+                    if (argCount == (isStaticProp ? 2 : 3)) {
+                        auto res = std::find_if(method->args.begin(), method->args.end(), [](ASTArg* arg) {
+                            return arg->findAttr<ASTAttrArray>() != nullptr;
+                        });
+                        auto arrAttr =
+                            res != method->args.end() ? (*res)->template findAttr<ASTAttrArray>() : nullptr;
+                        if (arrAttr) {
+                            auto arrDecl  = findSymbol(node, arrAttr->location, arrAttr->decl);
+                            auto sizeType = resolveType(arrDecl->template findAttr<ASTAttrType>()->type);
+                            if (sizeType->template is<ASTIntegerType>()) {
+                                isValid = true;
+                                if ((*res)->template findAttr<ASTAttrType>()) {
+                                    setterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
+                                }
                             }
                         }
-                        if (!setterType) {
-                            for (auto arg : method->args) {
-                                if (arg->template findAttr<ASTAttrThis>() == nullptr) {
-                                    setterType = resolveType(arg->template findAttr<ASTAttrType>()->type);
-                                    break;
+                        res = std::find_if(method->args.begin(), method->args.end(), [](ASTArg* arg) {
+                            return arg->findAttr<ASTAttrDataSize>() != nullptr;
+                        });
+                        auto datasizeAttr =
+                            res != method->args.end() ? (*res)->template findAttr<ASTAttrDataSize>() : nullptr;
+                        if (datasizeAttr) {
+                            auto datasizeDecl = findSymbol(node, datasizeAttr->location, datasizeAttr->decl);
+                            auto sizeType     = resolveType(datasizeDecl->template findAttr<ASTAttrType>()->type);
+                            if (sizeType->template is<ASTIntegerType>()) {
+                                isValid = true;
+                                if ((*res)->template findAttr<ASTAttrType>()) {
+                                    setterType = resolveType((*res)->template findAttr<ASTAttrType>()->type);
                                 }
                             }
                         }
-                    } else if constexpr (std::is_same_v<T, ASTEvent>) {
+                    }
+                    if (!isValid) {
                         if (isStaticProp && argCount != 1) {
-                            if ((argCount == 2 && !method->args[0]->template findAttr<ASTAttrUserData>() &&
-                                 !method->args[1]->template findAttr<ASTAttrUserData>()) ||
-                                argCount > 2) {
-                                err<IDL_STATUS_E2098>(getter->location, method->fullname());
-                            }
-                        } else if (!isStaticProp) {
-                            if (argCount == 3 && (!method->args[0]->template findAttr<ASTAttrUserData>() &&
-                                                  !method->args[1]->template findAttr<ASTAttrUserData>() &&
-                                                  !method->args[2]->template findAttr<ASTAttrUserData>())) {
-                                err<IDL_STATUS_E2099>(getter->location, method->fullname());
-                            } else if (argCount > 3) {
-                                err<IDL_STATUS_E2099>(getter->location, method->fullname());
-                            }
+                            err<IDL_STATUS_E2062>(setter->location, method->fullname());
+                        } else if (!isStaticProp && argCount != 2) {
+                            err<IDL_STATUS_E2063>(setter->location, method->fullname());
                         }
+                    }
+                    if (!setterType) {
                         for (auto arg : method->args) {
-                            if (arg->template findAttr<ASTAttrThis>() == nullptr &&
-                                arg->template findAttr<ASTAttrUserData>() == nullptr) {
+                            if (arg->template findAttr<ASTAttrThis>() == nullptr) {
                                 setterType = resolveType(arg->template findAttr<ASTAttrType>()->type);
                                 break;
                             }
                         }
                     }
-                    assert(setterType);
-                } else {
-                    err<IDL_STATUS_E2059>(setter->location, decl->fullname());
+                } else if constexpr (std::is_same_v<T, ASTEvent>) {
+                    if (isStaticProp && argCount != 1) {
+                        if ((argCount == 2 && !method->args[0]->template findAttr<ASTAttrUserData>() &&
+                             !method->args[1]->template findAttr<ASTAttrUserData>()) ||
+                            argCount > 2) {
+                            err<IDL_STATUS_E2098>(getter->location, method->fullname());
+                        }
+                    } else if (!isStaticProp) {
+                        if (argCount == 3 && (!method->args[0]->template findAttr<ASTAttrUserData>() &&
+                                              !method->args[1]->template findAttr<ASTAttrUserData>() &&
+                                              !method->args[2]->template findAttr<ASTAttrUserData>())) {
+                            err<IDL_STATUS_E2099>(getter->location, method->fullname());
+                        } else if (argCount > 3) {
+                            err<IDL_STATUS_E2099>(getter->location, method->fullname());
+                        }
+                    }
+                    for (auto arg : method->args) {
+                        if (arg->template findAttr<ASTAttrThis>() == nullptr &&
+                            arg->template findAttr<ASTAttrUserData>() == nullptr) {
+                            setterType = resolveType(arg->template findAttr<ASTAttrType>()->type);
+                            break;
+                        }
+                    }
                 }
+                assert(setterType);
+            } else {
+                err<IDL_STATUS_E2059>(setter->location, decl->fullname());
+            }
+        }
+        if (getterType && setterType && getterType != setterType) {
+            err<IDL_STATUS_E2064>(node->location,
+                                  getterType->fullname(),
+                                  getterMethod->fullname(),
+                                  setterType->fullname(),
+                                  setterMethod->fullname());
+        }
+        if (auto attr = node->template findAttr<ASTAttrType>()) {
+            auto type = resolveType(attr->type);
+            if (getterType && getterType != type) {
+                constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2065 : IDL_STATUS_E2100;
+                err<errCode>(attr->location, type->fullname(), getterType->fullname(), getterMethod->fullname());
             }
-            if (getterType && setterType && getterType != setterType) {
-                err<IDL_STATUS_E2064>(node->location,
-                                      getterType->fullname(),
-                                      getterMethod->fullname(),
-                                      setterType->fullname(),
-                                      setterMethod->fullname());
+            if (setterType && setterType != type) {
+                constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2066 : IDL_STATUS_E2101;
+                err<errCode>(attr->location, type->fullname(), setterMethod->fullname(), setterType->fullname());
             }
-            if (auto attr = node->template findAttr<ASTAttrType>()) {
-                auto type = resolveType(attr->type);
-                if (getterType && getterType != type) {
-                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2065 : IDL_STATUS_E2100;
-                    err<errCode>(attr->location, type->fullname(), getterType->fullname(), getterMethod->fullname());
-                }
-                if (setterType && setterType != type) {
-                    constexpr auto errCode = std::is_same_v<T, ASTProperty> ? IDL_STATUS_E2066 : IDL_STATUS_E2101;
-                    err<errCode>(attr->location, type->fullname(), setterMethod->fullname(), setterType->fullname());
+        } else {
+            stageType(0, node, std::string(getterType ? getterType->name : setterType->name));
+        }
+    }
+
+    void prepareInterface(ASTInterface* node) {
+        int refMethodCount     = 0;
+        int destroyMethodCount = 0;
+        for (auto method : node->methods) {
+            refMethodCount += method->findAttr<ASTAttrRef>() ? 1 : 0;
+            destroyMethodCount += method->findAttr<ASTAttrDestroy>() ? 1 : 0;
+            if (refMethodCount > 1) {
+                err<IDL_STATUS_E2088>(method->location);
+            }
+            if (destroyMethodCount > 1) {
+                err<IDL_STATUS_E2089>(method->location);
+            }
+        }
+    }
+
+    void prepareHandle(ASTHandle* node) {
+        if (auto attr = node->findAttr<ASTAttrType>()) {
+            if (auto type = resolveType(attr->type); type->is<ASTStruct>()) {
+                if (!type->findAttr<ASTAttrHandle>()) {
+                    err<IDL_STATUS_E2071>(node->location, type->fullname(), node->fullname());
                 }
             } else {
-                needAddType.emplace_back(node, getterType ? getterType->name : setterType->name);
+                err<IDL_STATUS_E2070>(node->location, node->fullname());
             }
-            return true;
-        });
-        for (auto& [node, type] : needAddType) {
-            auto attr          = allocNode<ASTAttrType>(node->location);
-            attr->parent       = node;
-            attr->type         = allocNode<ASTDeclRef>(node->location);
-            attr->type->name   = type;
-            attr->type->parent = attr;
-            node->attrs.push_back(attr);
+        } else {
+            err<IDL_STATUS_E2069>(node->location, node->fullname());
         }
     }
 
-    void prepareCallbacks() {
-        prepareInvokable<ASTCallback>();
+    void prepareDocumentation(ASTDecl* node) {
+        if (node->doc) {
+            DocValidator validator(_options, [this](const Exception& exc) {
+                warn(exc);
+            });
+            node->accept(validator);
+            auto prepare = [this, node](const ASTVector<ASTNode*>& nodes) {
+                for (auto doc : nodes) {
+                    if (auto declRef = doc->as<ASTDeclRef>()) {
+                        findDocSymbol(declRef);
+                        findSymbol(node, declRef->location, declRef);
+                    }
+                }
+            };
+            auto prepares = [&prepare](const ASTVector<ASTVector<ASTNode*>>& nodes) {
+                for (auto& node : nodes) {
+                    prepare(node);
+                }
+            };
+            prepare(node->doc->brief);
+            prepare(node->doc->detail);
+            prepare(node->doc->ret);
+            prepare(node->doc->copyright);
+            prepare(node->doc->license);
+            prepares(node->doc->authors);
+            prepares(node->doc->note);
+            prepares(node->doc->warn);
+            prepares(node->doc->see);
+        }
     }
 
-    void prepareFunctions() {
-        prepareInvokable<ASTFunc>();
+    void cacheFullname(ASTDecl* decl) {
+        decl->fullname();
+        decl->fullnameLowecase();
     }
 
-    void prepareMethods() {
-        prepareInvokable<ASTMethod>();
-    }
+    // The changes and warnings staged by the checks of one thread. Each
+    // staged item records the order of the declaration being checked, so
+    // that commitStaged does not depend on how declarations were scheduled.
+    struct Staging {
+        struct Change {
+            int step;
+            size_t order;
+            std::function<void()> apply;
+        };
+
+        size_t order{};
+        bool failed{};
+        std::vector<Change> changes{};
+        std::vector<std::pair<size_t, Exception>> warnings{};
 
-    void prepareProperties() {
-        prepareGetterSetter<ASTProperty>();
+        static inline thread_local Staging* current{};
+    };
+
+    template <typename Attr>
+    void stageAttr(int step, ASTDecl* decl) {
+        stage(step, [this, decl]() {
+            auto attr    = allocNode<Attr>(decl->location);
+            attr->parent = decl;
+            decl->addAttr(attr);
+        });
     }
 
-    void prepareEvents() {
-        prepareGetterSetter<ASTEvent>();
+    void stageType(int step, ASTDecl* decl, std::string type) {
+        stage(step, [this, decl, type = std::move(type)]() {
+            auto attr          = allocNode<ASTAttrType>(decl->location);
+            attr->parent       = decl;
+            attr->type         = allocNode<ASTDeclRef>(decl->location);
+            attr->type->name   = type;
+            attr->type->parent = attr;
+            decl->addAttr(attr);
+        });
     }
 
-    void prepareInterfaces() {
-        filter<ASTInterface>([this](ASTInterface* node) {
-            int refMethodCount     = 0;
-            int destroyMethodCount = 0;
-            for (auto method : node->methods) {
-                refMethodCount += method->findAttr<ASTAttrRef>() ? 1 : 0;
-                destroyMethodCount += method->findAttr<ASTAttrDestroy>() ? 1 : 0;
-                if (refMethodCount > 1) {
-                    err<IDL_STATUS_E2088>(method->location);
-                }
-                if (destroyMethodCount > 1) {
-                    err<IDL_STATUS_E2089>(method->location);
-                }
-            }
+    void stageValue(int step, ASTEnumConst* ec) {
+        stage(step, [this, ec]() {
+            auto attr    = allocNode<ASTAttrValue>(ec->location);
+            attr->parent = ec;
+            attr->value  = internInt(ec->location, (int64_t) ec->value);
+            ec->addAttr(attr);
         });
     }
 
-    void prepareHandles() {
-        filter<ASTHandle>([this](ASTHandle* node) {
-            if (auto attr = node->findAttr<ASTAttrType>()) {
-                if (auto type = resolveType(attr->type); type->is<ASTStruct>()) {
-                    if (!type->findAttr<ASTAttrHandle>()) {
-                        err<IDL_STATUS_E2071>(node->location, type->fullname(), node->fullname());
-                    }
-                } else {
-                    err<IDL_STATUS_E2070>(node->location, node->fullname());
+    void warn(const Exception& exc) {
+        assert(Staging::current);
+        Staging::current->warnings.emplace_back(Staging::current->order, exc);
+    }
+
+    void commitWarnings(std::span<Staging> stagings, size_t last = std::numeric_limits<size_t>::max()) {
+        std::vector<const std::pair<size_t, Exception>*> warnings{};
+        for (const auto& staging : stagings) {
+            for (const auto& warning : staging.warnings) {
+                if (warning.first <= last) {
+                    warnings.push_back(&warning);
                 }
-            } else {
-                err<IDL_STATUS_E2069>(node->location, node->fullname());
             }
+        }
+        std::stable_sort(warnings.begin(), warnings.end(), [](auto lhs, auto rhs) {
+            return lhs->first < rhs->first;
         });
+        for (auto warning : warnings) {
+            if (_result) {
+                _result->addMessage(warning->second, false);
+            }
+        }
     }
 
-    void prepareDocumentation() {
-        filter<ASTDecl>([this](ASTDecl* node) {
-            if (node->doc) {
-                DocValidator validator(_options, _result);
-                node->accept(validator);
-                auto prepare = [this, node](const std::vector<ASTNode*>& nodes) {
-                    for (auto doc : nodes) {
-                        if (auto declRef = doc->as<ASTDeclRef>()) {
-                            findDocSymbol(declRef);
-                            findSymbol(node, declRef->location, declRef);
-                        }
-                    }
-                };
-                auto prepares = [&prepare](const std::vector<std::vector<ASTNode*>>& nodes) {
-                    for (auto node : nodes) {
-                        prepare(node);
-                    }
-                };
-                prepare(node->doc->brief);
-                prepare(node->doc->detail);
-                prepare(node->doc->ret);
-                prepare(node->doc->copyright);
-                prepare(node->doc->license);
-                prepares(node->doc->authors);
-                prepares(node->doc->note);
-                prepares(node->doc->warn);
-                prepares(node->doc->see);
+    void commitStaged(std::span<Staging> stagings) {
+        commitWarnings(stagings);
+
+        // Changes are applied by step, and in the order of their declarations
+        // within a step.
+        std::vector<Staging::Change*> changes{};
+        for (auto& staging : stagings) {
+            for (auto& change : staging.changes) {
+                changes.push_back(&change);
             }
+        }
+        std::stable_sort(changes.begin(), changes.end(), [](auto lhs, auto rhs) {
+            return std::tie(lhs->step, lhs->order) < std::tie(rhs->step, rhs->order);
         });
+        for (auto change : changes) {
+            change->apply();
+        }
     }
 
     const std::optional<idl_api_version_t>& apiVersion() const noexcept {
@@ -1015,6 +1010,32 @@ public:
         });
     }
 
+    // Sets the cache the outputs of files are reused from, and the key of each
+    // file, which covers the content of the files its output depends on.
+    void fileCache(FileCache* cache, std::unordered_map<const ASTFile*, uint64_t>&& keys) noexcept {
+        _fileCache = cache;
+        _fileKeys  = std::move(keys);
+    }
+
+    // Generates the output of a file, unless the output in the slot was
+    // generated for the same key and the same generator inputs.
+    template <typename Generate>
+    void generateFile(const ASTFile* file,
+                      const std::string& slot,
+                      const std::string& inputs,
+                      idl_write_callback_t writer,
+                      idl_data_t writerData,
+                      Generate&& generate) {
+        auto it = _fileKeys.find(file);
+        if (!_fileCache || it == _fileKeys.end()) {
+            generate(writer, writerData);
+            return;
+        }
+        const auto str = fmt::format("{:x}\n{}", it->second, inputs);
+        const auto key = XXH64(str.c_str(), str.length(), 0);
+        _fileCache->generate(slot, key, writer, writerData, std::forward<Generate>(generate));
+    }
+
     void pushFile(ASTFile* file) {
         _files.push_back(file);
     }
@@ -1027,14 +1048,36 @@ public:
     bool filter(Pred&& pred) {
         static_assert(std::is_base_of<ASTNode, Node>::value, "Node must be inherited from ASTNode");
         constexpr auto isVoid = std::is_same_v<decltype(pred((Node*) nullptr)), void>;
-        for (auto node : _nodes) {
-            if (auto ptr = node->as<Node>()) {
-                if constexpr (isVoid) {
-                    pred(ptr);
-                } else {
-                    if (!pred(ptr)) {
-                        return false;
-                    }
+        constexpr auto first  = size_t(Node::kindFirst);
+        constexpr auto last   = size_t(Node::kindLast);
+
+        // Node and its subclasses occupy the kind range [first, last]; merge
+        // their buckets by node index to visit them in creation order.
+        std::array<size_t, last - first + 1> cursors{};
+        std::array<size_t, last - first + 1> sizes{};
+        for (size_t kind = first; kind <= last; ++kind) {
+            sizes[kind - first] = _kindNodes[kind].size();
+        }
+        while (true) {
+            auto index = std::numeric_limits<uint32_t>::max();
+            size_t next{};
+            for (size_t i = 0; i < sizes.size(); ++i) {
+                if (cursors[i] < sizes[i] && _kindNodes[first + i][cursors[i]] < index) {
+                    index = _kindNodes[first + i][cursors[i]];
+                    next  = i;
+                }
+            }
+            if (index == std::numeric_limits<uint32_t>::max()) {
+                break;
+            }
+            ++cursors[next];
+
+            auto ptr = static_cast<Node*>(_nodes[index]);
+            if constexpr (isVoid) {
+                pred(ptr);
+            } else {
+                if (!pred(ptr)) {
+                    return false;
                 }
             }
         }
@@ -1042,6 +1085,42 @@ public:
     }
 
 private:
+    static uint64_t symbolKey(uint32_t scopeId, uint32_t nameId) noexcept {
+        return (uint64_t(scopeId) << 32) | nameId;
+    }
+
+    void stage(int step, std::function<void()> apply) {
+        assert(Staging::current);
+        auto staging = Staging::current;
+        staging->changes.push_back({ step, staging->order, std::move(apply) });
+    }
+
+    uint32_t scopeId(ASTDecl* decl) noexcept {
+        if (!decl->scopeId) {
+            decl->scopeId = ++_lastScopeId;
+        }
+        return decl->scopeId;
+    }
+
+    ASTDecl* lookupSymbol(ASTDecl* scope, std::string_view name, bool& exactCase) const noexcept {
+        exactCase = true;
+        while (scope->scopeId) {
+            const auto dot  = name.find('.');
+            const auto part = name.substr(0, dot);
+            const auto it   = _symbols.find(symbolKey(scope->scopeId, _names.find(part)));
+            if (it == _symbols.end()) {
+                return nullptr;
+            }
+            scope     = it->second;
+            exactCase = exactCase && scope->name == part;
+            if (dot == std::string_view::npos) {
+                return scope;
+            }
+            name = name.substr(dot + 1);
+        }
+        return nullptr;
+    }
+
     template <typename Node, typename Value>
     ASTLiteral* internLiteral(const idl::location& loc, const std::string& keyStr, const Value& value) {
         const auto key = XXH64(keyStr.c_str(), keyStr.length(), 0);
@@ -1130,11 +1209,19 @@ private:
     CompilationResult* _result;
     std::optional<idl_api_version_t> _version{};
     ASTApi* _api{};
+    Arena _arena{};
     std::vector<ASTNode*> _nodes{};
-    std::unordered_map<std::string, struct ASTDecl*> _symbols{};
-    std::unordered_map<std::string, struct ASTDocDecl*> _docSymbols{};
+    std::array<std::vector<uint32_t>, size_t(ASTNode::kindLast) + 1> _kindNodes{};
+    SymbolPool _names{ &_arena };
+    std::unordered_map<uint64_t, struct ASTDecl*> _symbols{};
+    std::unordered_map<uint32_t, struct ASTDocDecl*> _docSymbols{};
+    uint32_t _lastScopeId{};
     std::unordered_map<uint64_t, ASTLiteral*> _literals{};
     std::vector<ASTFile*> _files{};
+    FileCache* _fileCache{};
+    std::unordered_map<const ASTFile*, uint64_t> _fileKeys{};
+    std::vector<std::filesystem::path> _outputs{};
+    std::mutex _outputsMutex{};
     bool _declaring{};
 };
 
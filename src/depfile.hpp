@@ -0,0 +1,54 @@
+#ifndef DEPFILE_HPP
+#define DEPFILE_HPP
+
+#include "scanner.hpp"
+
+namespace idl {
+
+inline std::string escapeDepfilePath(const std::filesystem::path& path) {
+    std::string result;
+    for (auto c : path.generic_string()) {
+        if (c == ' ' || c == '#') {
+            result += '\\';
+        } else if (c == '$') {
+            result += '$';
+        }
+        result += c;
+    }
+    return result;
+}
+
+inline void writeDepfile(const idl::location& loc,
+                         const std::filesystem::path& path,
+                         std::span<const std::filesystem::path> targets,
+                         std::span<const Scanner::Dependency> dependencies) {
+    std::string str;
+    for (const auto& target : targets) {
+        if (!str.empty()) {
+            str += ' ';
+        }
+        str += escapeDepfilePath(std::filesystem::absolute(target));
+    }
+    str += ':';
+    for (const auto& dep : dependencies) {
+        if (!dep.fromImporter && !dep.fromSources) {
+            str += " \\\n  ";
+            str += escapeDepfilePath(std::filesystem::absolute(dep.path));
+        }
+    }
+    str += '\n';
+
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream stream(path);
+    stream.write(str.data(), (std::streamsize) str.length());
+    stream.flush();
+    if (stream.fail()) {
+        err<IDL_STATUS_E2067>(loc, path.string());
+    }
+}
+
+} // namespace idl
+
+#endif
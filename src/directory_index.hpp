@@ -0,0 +1,68 @@
+#ifndef DIRECTORY_INDEX_HPP
+#define DIRECTORY_INDEX_HPP
+
+#include "case_converter.hpp"
+
+namespace idl {
+
+class DirectoryIndex final {
+public:
+    std::optional<std::filesystem::path> find(const std::filesystem::path& path) {
+        std::lock_guard lock(_mutex);
+        const auto& entries = directory(path.parent_path());
+        const auto name     = path.filename().string();
+
+        auto key = name;
+        auto it  = entries.find(lower(key));
+        if (it == entries.end()) {
+            return std::nullopt;
+        }
+        for (const auto& entry : it->second) {
+            if (entry.filename() == name) {
+                return entry;
+            }
+        }
+        return it->second.front();
+    }
+
+    void clear() noexcept {
+        std::lock_guard lock(_mutex);
+        _dirs.clear();
+    }
+
+private:
+    using Entries = std::unordered_map<std::string, std::vector<std::filesystem::path>>;
+
+    struct Directory {
+        std::filesystem::file_time_type time{};
+        Entries entries{};
+    };
+
+    // A directory is listed again when its modification time changes, which
+    // happens whenever a file is added to, removed from or renamed in it.
+    const Entries& directory(const std::filesystem::path& dir) {
+        std::error_code ec;
+        const auto time     = std::filesystem::last_write_time(dir, ec);
+        auto [it, inserted] = _dirs.try_emplace(dir.lexically_normal().string());
+        if (inserted || it->second.time != time) {
+            it->second.time = time;
+            it->second.entries.clear();
+            std::filesystem::directory_iterator iter(dir, ec);
+            for (; !ec && iter != std::filesystem::directory_iterator(); iter.increment(ec)) {
+                std::error_code fileEc;
+                if (iter->is_regular_file(fileEc)) {
+                    auto name = iter->path().filename().string();
+                    it->second.entries[lower(name)].push_back(iter->path());
+                }
+            }
+        }
+        return it->second.entries;
+    }
+
+    std::unordered_map<std::string, Directory> _dirs{};
+    std::mutex _mutex{};
+};
+
+} // namespace idl
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef FILE_CACHE_HPP
+#define FILE_CACHE_HPP
+
+#include "idl.hpp"
+
+namespace idl {
+
+// Outputs generated for single files, kept across the compilations of one
+// compiler so that a rebuild only generates the outputs a change affects. A
+// slot names one output of a generator and holds the output generated last,
+// together with the key of everything its generation read.
+class FileCache final {
+public:
+    template <typename Generate>
+    void generate(const std::string& slot,
+                  uint64_t key,
+                  idl_write_callback_t writer,
+                  idl_data_t writerData,
+                  Generate&& generate) {
+        std::shared_ptr<const Output> output{};
+        {
+            std::lock_guard lock(_mutex);
+            if (auto it = _slots.find(slot); it != _slots.end() && it->second.key == key) {
+                output = it->second.output;
+            }
+        }
+        if (!output) {
+            auto generated = std::make_shared<Output>();
+            generate(capture, generated.get());
+            output = generated;
+
+            std::lock_guard lock(_mutex);
+            _slots.insert_or_assign(slot, Slot{ key, output });
+        }
+        idl_source_t source{ output->name.c_str(), output->data.c_str(), (idl_uint32_t) output->data.length() };
+        writer(&source, writerData);
+    }
+
+    void clear() noexcept {
+        std::lock_guard lock(_mutex);
+        _slots.clear();
+    }
+
+private:
+    struct Output {
+        std::string name;
+        std::string data;
+    };
+
+    struct Slot {
+        uint64_t key{};
+        std::shared_ptr<const Output> output{};
+    };
+
+    static void capture(const idl_source_t* source, idl_data_t data) {
+        static_cast<Output*>(data)->name = source->name;
+        static_cast<Output*>(data)->data.assign(source->data, source->size);
+    }
+
+    std::unordered_map<std::string, Slot> _slots{};
+    std::mutex _mutex{};
+};
+
+} // namespace idl
+
+#endif
@@ -1,18 +1,21 @@
 
 #include "case_converter.hpp"
 #include "context.hpp"
+#include "output_sink.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 using namespace idl;
 
 struct Header {
-    std::ostream& stream;
-    std::unique_ptr<std::ofstream> fstream;
-    std::unique_ptr<std::ostringstream> sstream;
-    std::string filename;
+    OutputSink stream;
     std::string includeGuard;
     bool externC;
-    idl_write_callback_t writer;
-    idl_data_t writerData;
+};
+
+struct Output {
+    std::string name;
+    std::string data;
 };
 
 struct DocRef : Visitor {
@@ -91,21 +94,8 @@ static Header createHeader(idl::Context& ctx,
                            bool externC,
                            idl_write_callback_t writer,
                            idl_data_t writerData) {
-    std::filesystem::create_directories(out);
-    auto header = out / headerStr(ctx, postfix);
-    auto guard  = includeGuardStr(ctx, postfix);
-    if (writer) {
-        auto stream = std::make_unique<std::ostringstream>();
-        auto ptr    = stream.get();
-        return { *ptr, nullptr, std::move(stream), header.filename().string(), guard, externC, writer, writerData };
-    } else {
-        auto stream = std::make_unique<std::ofstream>(std::ofstream(header));
-        if (stream->fail()) {
-            idl::err<IDL_STATUS_E2067>(ctx.api()->location, header.string());
-        }
-        auto ptr = stream.get();
-        return { *ptr, std::move(stream), nullptr, header.filename().string(), guard, externC };
-    }
+    auto stream = OutputSink(ctx, out, headerStr(ctx, postfix), writer, writerData);
+    return { std::move(stream), includeGuardStr(ctx, postfix), externC };
 }
 
 static std::string getApiPrefix(idl::Context& ctx, bool upper) {
@@ -197,62 +187,58 @@ static void printInclude(idl::Context& ctx, Header& header, const Include& inc)
     } else {
         const std::string str = inc;
         if (str.length() > 0) {
-            fmt::println(header.stream, "#include \"{}\"", headerStr(ctx, str));
+            idl::println(header.stream, "#include \"{}\"", headerStr(ctx, str));
         }
     }
 }
 
 template <typename... Includes>
 static void beginHeader(idl::Context& ctx, Header& header, const Includes&... includes) {
-    fmt::println(header.stream, "#ifndef {}", header.includeGuard);
-    fmt::println(header.stream, "#define {}", header.includeGuard);
-    fmt::println(header.stream, "");
+    idl::println(header.stream, "#ifndef {}", header.includeGuard);
+    idl::println(header.stream, "#define {}", header.includeGuard);
+    idl::println(header.stream, "");
     if (sizeof...(includes) > 0) {
         (printInclude(ctx, header, includes), ...);
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "");
     }
     if (header.externC) {
-        fmt::println(header.stream, "{}_BEGIN", convert(ctx.api()->name, Case::ScreamingSnakeCase));
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "{}_BEGIN", convert(ctx.api()->name, Case::ScreamingSnakeCase));
+        idl::println(header.stream, "");
     }
 }
 
 static void endHeader(idl::Context& ctx, Header& header) {
     if (header.externC) {
-        fmt::println(header.stream, "{}_END", convert(ctx.api()->name, Case::ScreamingSnakeCase));
-        fmt::println(header.stream, "");
-    }
-    fmt::println(header.stream, "#endif /* {} */", header.includeGuard);
-    if (header.writer) {
-        const std::string data = header.sstream->str();
-        idl_source_t source{ header.filename.c_str(), data.c_str(), (idl_uint32_t) data.length() };
-        header.writer(&source, header.writerData);
+        idl::println(header.stream, "{}_END", convert(ctx.api()->name, Case::ScreamingSnakeCase));
+        idl::println(header.stream, "");
     }
+    idl::println(header.stream, "#endif /* {} */", header.includeGuard);
+    header.stream.flush();
 }
 
 static void generateDocField(Header& header,
-                             const std::vector<ASTNode*>& nodes,
+                             const ASTVector<ASTNode*>& nodes,
                              size_t indents,
                              const std::string& prefix,
                              bool inlineDoc = false) {
     bool first = true;
     for (auto node : nodes) {
         if (auto str = node->as<ASTLiteralStr>()) {
-            fmt::print(header.stream, "{}", str->value);
+            idl::print(header.stream, "{}", str->value);
             if (str->value == "\n") {
-                fmt::print(header.stream, " *{:<{}}{}", ' ', indents, prefix);
+                idl::print(header.stream, " *{:<{}}{}", ' ', indents, prefix);
             }
         } else if (auto ref = node->as<ASTDeclRef>()) {
             DocRef docRef;
             ref->decl->accept(docRef);
-            fmt::print(header.stream, "{}", docRef.str);
+            idl::print(header.stream, "{}", docRef.str);
         } else {
             assert(!"unreachable code");
         }
         first = false;
     }
     if (!inlineDoc) {
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "");
     }
 }
 
@@ -261,7 +247,7 @@ static void generateDoc(Header& header,
                         std::string_view group,
                         bool printLicense                = false,
                         ASTFile* fileDecl                = nullptr,
-                        const std::vector<ASTArg*>* args = nullptr) {
+                        const ASTVector<ASTArg*>* args = nullptr) {
     if (!node->doc) {
         return;
     }
@@ -276,12 +262,12 @@ static void generateDoc(Header& header,
     };
 
     auto printDocField = [&header, &maxLength](std::string_view field,
-                                               const std::vector<ASTNode*>& nodes,
+                                               const ASTVector<ASTNode*>& nodes,
                                                const std::string prefix  = "",
                                                const std::string argName = "") {
         if (!nodes.empty()) {
             auto at = field.length() > 0 ? "@" : "";
-            fmt::print(header.stream,
+            idl::print(header.stream,
                        " * {}{:<{}}{}{}",
                        at,
                        field,
@@ -293,15 +279,15 @@ static void generateDoc(Header& header,
     };
 
     auto printDocFields = [&header, &printDocField](std::string_view field,
-                                                    const std::vector<std::vector<ASTNode*>>& nodes,
+                                                    const ASTVector<ASTVector<ASTNode*>>& nodes,
                                                     bool parblock = false) {
         for (const auto& node : nodes) {
             if (parblock && nodes.size() > 1) {
-                fmt::println(header.stream, " * @parblock");
+                idl::println(header.stream, " * @parblock");
             }
             printDocField(field, node);
             if (parblock && nodes.size() > 1) {
-                fmt::println(header.stream, " * @endparblock");
+                idl::println(header.stream, " * @endparblock");
             }
         }
     };
@@ -320,7 +306,7 @@ static void generateDoc(Header& header,
     std::string_view sa         = "sa";
     std::string_view ingroup    = "ingroup";
 
-    std::vector<ASTNode*> groupNodes;
+    ASTVector<ASTNode*> groupNodes;
     ASTLiteralStr ingroupStr;
     if (!group.empty()) {
         ingroupStr.value = group;
@@ -355,12 +341,12 @@ static void generateDoc(Header& header,
             }
         }
     }
-    fmt::println(header.stream, "/**");
+    idl::println(header.stream, "/**");
     if (node->is<ASTApi>()) {
         if (file.length() > maxLength) {
             maxLength = file.length();
         }
-        fmt::println(header.stream, " * @{:<{}} {}", file, maxLength, header.filename);
+        idl::println(header.stream, " * @{:<{}} {}", file, maxLength, header.stream.filename());
     }
     printDocField(brief, briefNodes);
     printDocField(details, detailNodes);
@@ -389,32 +375,32 @@ static void generateDoc(Header& header,
     printDocField(copyright, node->doc->copyright);
     if (printLicense && !node->doc->copyright.empty()) {
         maxLength = 0;
-        fmt::println(header.stream, " *");
+        idl::println(header.stream, " *");
         // add 4 spaces to the beginning of lines so doxygen will consider it a block
         std::string indent4 = "    ";
         printDocField("", node->doc->license, indent4);
     }
-    fmt::println(header.stream, " */");
+    idl::println(header.stream, " */");
 }
 
 static void generateInlineDoc(Header& header, ASTDecl* node, bool includeBrief = false, bool briefOnly = false) {
     if (node->doc && !node->doc->detail.empty()) {
-        fmt::print(header.stream, " /**< ");
+        idl::print(header.stream, " /**< ");
         if (includeBrief && !node->doc->brief.empty()) {
             generateDocField(header, node->doc->brief, 0, "", true);
             if (auto str = node->doc->brief.back()->as<ASTLiteralStr>()) {
                 if (!std::ispunct(str->value.back())) {
-                    fmt::print(header.stream, ".");
+                    idl::print(header.stream, ".");
                 }
                 if (!briefOnly) {
-                    fmt::print(header.stream, " ");
+                    idl::print(header.stream, " ");
                 }
             }
         }
         if (!briefOnly) {
             generateDocField(header, node->doc->detail, 0, "", true);
         }
-        fmt::print(header.stream, " */");
+        idl::print(header.stream, " */");
     }
 }
 
@@ -452,24 +438,24 @@ struct DeclGenerator : Visitor {
             maxLength = name.length();
         }
         generateDoc(header, node, grouping ? "enums" : "");
-        fmt::println(header.stream, "typedef enum");
-        fmt::println(header.stream, "{{");
+        idl::println(header.stream, "typedef enum");
+        idl::println(header.stream, "{{");
         for (const auto& [key, value, decl] : consts) {
-            fmt::print(header.stream, "{:<{}}{:<{}} = {}", ' ', 4, key, maxLength, value);
+            idl::print(header.stream, "{:<{}}{:<{}} = {}", ' ', 4, key, maxLength, value);
             if (decl) {
                 generateInlineDoc(header, decl);
             } else {
-                fmt::print(header.stream, " /**< Max value of enum (not used) */");
+                idl::print(header.stream, " /**< Max value of enum (not used) */");
             }
-            fmt::println(header.stream, "");
+            idl::println(header.stream, "");
         }
         name = getDeclCName(node);
-        fmt::println(header.stream, "}} {};", name);
+        idl::println(header.stream, "}} {};", name);
         if (node->findAttr<ASTAttrFlags>()) {
             auto API = getApiPrefix(ctx, true);
-            fmt::println(header.stream, "{}_FLAGS({})", API, name);
+            idl::println(header.stream, "{}_FLAGS({})", API, name);
         }
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "");
     }
 
     void visit(ASTStruct* node) override {
@@ -486,15 +472,15 @@ struct DeclGenerator : Visitor {
                 }
             }
             generateDoc(header, node, grouping ? "structs" : "");
-            fmt::println(header.stream, "typedef struct");
-            fmt::println(header.stream, "{{");
+            idl::println(header.stream, "typedef struct");
+            idl::println(header.stream, "{{");
             for (const auto& [key, value, decl] : typeNames) {
-                fmt::print(header.stream, "{:<{}}{:<{}} {};", ' ', 4, key, maxLength, value);
+                idl::print(header.stream, "{:<{}}{:<{}} {};", ' ', 4, key, maxLength, value);
                 generateInlineDoc(header, decl);
-                fmt::println(header.stream, "");
+                idl::println(header.stream, "");
             }
-            fmt::println(header.stream, "}} {};", getDeclCName(node));
-            fmt::println(header.stream, "");
+            idl::println(header.stream, "}} {};", getDeclCName(node));
+            idl::println(header.stream, "");
         }
     }
 
@@ -512,25 +498,25 @@ struct DeclGenerator : Visitor {
         }
         generateDoc(header, node, grouping ? "types" : "", false, nullptr, &node->args);
         const auto decl = fmt::format("(*{})(", getDeclCName(node));
-        fmt::println(header.stream, "typedef {}", getType(node));
-        fmt::print(header.stream, "{}", decl);
+        idl::println(header.stream, "typedef {}", getType(node));
+        idl::print(header.stream, "{}", decl);
         if (node->args.empty()) {
-            fmt::print(header.stream, "void");
+            idl::print(header.stream, "void");
         } else {
             for (size_t i = 0; i < node->args.size(); ++i) {
                 const auto [argType, argName] = getTypeAndName(node->args[i]);
                 if (i == 0) {
-                    fmt::print(header.stream, "{} {}", argType, argName);
+                    idl::print(header.stream, "{} {}", argType, argName);
                 } else {
-                    fmt::print(header.stream, "{:>{}} {}", argType, decl.length() + argType.length(), argName);
+                    idl::print(header.stream, "{:>{}} {}", argType, decl.length() + argType.length(), argName);
                 }
                 if (i + 1 < node->args.size()) {
-                    fmt::println(header.stream, ",");
+                    idl::println(header.stream, ",");
                 }
             }
         }
-        fmt::println(header.stream, ");");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, ");");
+        idl::println(header.stream, "");
     }
 
     void visit(ASTMethod* node) override {
@@ -542,7 +528,7 @@ struct DeclGenerator : Visitor {
                 flushMethods(name.str);
             }
             auto parent            = node->parent->as<ASTDecl>();
-            std::vector<int>* nums = nullptr;
+            ASTVector<int>* nums = nullptr;
             if (auto attr = parent->findAttr<ASTAttrTokenizer>()) {
                 nums = &attr->nums;
             }
@@ -553,44 +539,44 @@ struct DeclGenerator : Visitor {
         printFunc(node, node->args);
     }
 
-    void printFunc(ASTDecl* decl, const std::vector<ASTArg*>& args) {
+    void printFunc(ASTDecl* decl, const ASTVector<ASTArg*>& args) {
         generateDoc(header, decl, grouping ? "functions" : "", false, nullptr, &args);
         auto api       = getApiPrefix(ctx, false);
         auto importApi = api + "_api";
-        fmt::println(header.stream, "{} {}", importApi, getType(decl));
+        idl::println(header.stream, "{} {}", importApi, getType(decl));
         auto declStr = fmt::format("{}(", getDeclCName(decl));
-        fmt::print(header.stream, "{}", declStr);
+        idl::print(header.stream, "{}", declStr);
         if (args.empty()) {
-            fmt::print(header.stream, "void");
+            idl::print(header.stream, "void");
         } else {
             for (size_t i = 0; i < args.size(); ++i) {
                 const auto [typeStr, nameStr] = getTypeAndName(args[i]);
                 if (i == 0) {
-                    fmt::print(header.stream, "{} {}", typeStr, nameStr);
+                    idl::print(header.stream, "{} {}", typeStr, nameStr);
                 } else {
-                    fmt::print(header.stream, "{:>{}} {}", typeStr, declStr.length() + typeStr.length(), nameStr);
+                    idl::print(header.stream, "{:>{}} {}", typeStr, declStr.length() + typeStr.length(), nameStr);
                 }
                 if (i + 1 < args.size()) {
-                    fmt::println(header.stream, ",");
+                    idl::println(header.stream, ",");
                 }
             }
         }
-        fmt::println(header.stream, ");");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, ");");
+        idl::println(header.stream, "");
     }
 
     void beginName(const std::string& name, const std::string& brief) {
-        fmt::println(header.stream, "/**");
-        fmt::println(header.stream, " * @name {}", name);
-        fmt::println(header.stream, " * @brief {}", brief);
-        fmt::println(header.stream, " * @{{");
-        fmt::println(header.stream, " */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/**");
+        idl::println(header.stream, " * @name {}", name);
+        idl::println(header.stream, " * @brief {}", brief);
+        idl::println(header.stream, " * @{{");
+        idl::println(header.stream, " */");
+        idl::println(header.stream, "");
     }
 
     void endName() {
-        fmt::println(header.stream, "/** @}} */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/** @}} */");
+        idl::println(header.stream, "");
     }
 
     void flushCallbacks() {
@@ -741,7 +727,7 @@ static void generateVersion(idl::Context& ctx,
     std::vector<ASTLiteralStr> strings;
     strings.reserve(20);
     auto addDocField = [&strings](std::vector<std::string>&& data) {
-        std::vector<ASTNode*> nodes;
+        ASTVector<ASTNode*> nodes;
         for (const auto& str : data) {
             strings.push_back({});
             strings.back().value = str;
@@ -752,7 +738,8 @@ static void generateVersion(idl::Context& ctx,
 
     ASTDoc doc{};
     doc.brief  = addDocField({ "Library version information and utilities." });
-    doc.detail = addDocField({ "This header provides version information for the " + ctx.api()->name + " library,",
+    doc.detail = addDocField({ "This header provides version information for the " + std::string(ctx.api()->name) +
+                                   " library,",
                                "\n",
                                "including version number components and macros for version comparison",
                                "\n",
@@ -769,7 +756,7 @@ static void generateVersion(idl::Context& ctx,
     file.doc  = &doc;
     generateDoc(header, ctx.api(), grouping ? "files" : "", false, &file);
     beginHeader(ctx, header);
-    fmt::println(header.stream,
+    idl::println(header.stream,
                  tmp,
                  fmt::arg("API", API),
                  fmt::arg("major", major),
@@ -816,7 +803,7 @@ static void generatePlatform(idl::Context& ctx,
     std::vector<ASTLiteralStr> strings;
     strings.reserve(20);
     auto addDocField = [&strings](std::vector<std::string>&& data) {
-        std::vector<ASTNode*> nodes;
+        ASTVector<ASTNode*> nodes;
         for (const auto& str : data) {
             strings.push_back({});
             strings.back().value = str;
@@ -831,7 +818,7 @@ static void generatePlatform(idl::Context& ctx,
     doc.brief  = addDocField({ "Platform-specific definitions and utilities." });
     doc.detail = addDocField({ "This header provides cross-platform macros, type definitions, and utility",
                                "\n",
-                               "macros for the " + ctx.api()->name + " library. It handles:",
+                               "macros for the " + std::string(ctx.api()->name) + " library. It handles:",
                                "\n",
                                "- Platform detection (Windows, macOS, iOS, Android, Linux, Web)",
                                "\n",
@@ -848,113 +835,113 @@ static void generatePlatform(idl::Context& ctx,
     file.doc  = &doc;
     generateDoc(header, ctx.api(), grouping ? "files" : "", false, &file);
     beginHeader(ctx, header);
-    fmt::println(header.stream, "/**");
-    fmt::println(header.stream, " * @def     {}_BEGIN", API);
-    fmt::println(header.stream, " * @brief   Begins a C-linkage declaration block.");
-    fmt::println(header.stream,
+    idl::println(header.stream, "/**");
+    idl::println(header.stream, " * @def     {}_BEGIN", API);
+    idl::println(header.stream, " * @brief   Begins a C-linkage declaration block.");
+    idl::println(header.stream,
                  " * @details In C++, expands to `extern \"C\" {{` to ensure C-compatible symbol naming.");
-    fmt::println(header.stream, " *          In pure C environments, expands to nothing.");
-    fmt::println(header.stream, " * @sa      {}_END{}", API, group);
-    fmt::println(header.stream, " *");
-    fmt::println(header.stream, " */");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "/**");
-    fmt::println(header.stream, " * @def     {}_END", API);
-    fmt::println(header.stream, " * @brief   Ends a C-linkage declaration block.");
-    fmt::println(header.stream, " * @details Closes the scope opened by #{}_BEGIN.", API);
-    fmt::println(header.stream, " * @sa      {}_BEGIN{}", API, group);
-    fmt::println(header.stream, " *");
-    fmt::println(header.stream, " */");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "#ifdef __cplusplus");
-    fmt::println(header.stream, "# define {}_BEGIN extern \"C\" {{", API);
-    fmt::println(header.stream, "# define {}_END   }}", API);
-    fmt::println(header.stream, "#else");
-    fmt::println(header.stream, "# define {}_BEGIN", API);
-    fmt::println(header.stream, "# define {}_END", API);
-    fmt::println(header.stream, "#endif");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "/**");
-    fmt::println(header.stream, " * @def     {}", importAPI);
-    fmt::println(header.stream, " * @brief   Controls symbol visibility for shared library builds.");
-    fmt::println(header.stream,
+    idl::println(header.stream, " *          In pure C environments, expands to nothing.");
+    idl::println(header.stream, " * @sa      {}_END{}", API, group);
+    idl::println(header.stream, " *");
+    idl::println(header.stream, " */");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "/**");
+    idl::println(header.stream, " * @def     {}_END", API);
+    idl::println(header.stream, " * @brief   Ends a C-linkage declaration block.");
+    idl::println(header.stream, " * @details Closes the scope opened by #{}_BEGIN.", API);
+    idl::println(header.stream, " * @sa      {}_BEGIN{}", API, group);
+    idl::println(header.stream, " *");
+    idl::println(header.stream, " */");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "#ifdef __cplusplus");
+    idl::println(header.stream, "# define {}_BEGIN extern \"C\" {{", API);
+    idl::println(header.stream, "# define {}_END   }}", API);
+    idl::println(header.stream, "#else");
+    idl::println(header.stream, "# define {}_BEGIN", API);
+    idl::println(header.stream, "# define {}_END", API);
+    idl::println(header.stream, "#endif");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "/**");
+    idl::println(header.stream, " * @def     {}", importAPI);
+    idl::println(header.stream, " * @brief   Controls symbol visibility for shared library builds.");
+    idl::println(header.stream,
                  " * @details This macro is used to control symbol visibility when building or using the library.");
-    fmt::println(header.stream,
+    idl::println(header.stream,
                  " *          On Windows (**MSVC**) with dynamic linking (non-static build), it expands to "
                  "`__declspec(dllimport)`.");
-    fmt::println(header.stream,
+    idl::println(header.stream,
                  " *          In all other cases (static builds or non-Windows platforms), it expands to nothing.");
-    fmt::println(header.stream, " *          This allows proper importing of symbols from DLLs on Windows platforms.");
-    fmt::println(header.stream, " * @note    Define `{}_STATIC_BUILD` for static library configuration.{}", API, group);
-    fmt::println(header.stream, " */");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "#ifndef {}", importAPI);
-    fmt::println(header.stream, "# if defined(_MSC_VER) && !defined({}_STATIC_BUILD)", API);
-    fmt::println(header.stream, "#  define {} __declspec(dllimport)", importAPI);
-    fmt::println(header.stream, "# else");
-    fmt::println(header.stream, "#  define {}", importAPI);
-    fmt::println(header.stream, "# endif");
-    fmt::println(header.stream, "#endif");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "#if defined(_WIN32) && !defined({}_PLATFORM_WINDOWS)", API);
-    fmt::println(header.stream, "# define {}_PLATFORM_WINDOWS", API);
-    fmt::println(header.stream, "#elif defined(__APPLE__)");
-    fmt::println(header.stream, "# include <TargetConditionals.h>");
-    fmt::println(header.stream, "# include <unistd.h>");
-    fmt::println(header.stream, "# if TARGET_OS_IPHONE && !defined({}_PLATFORM_IOS)", API);
-    fmt::println(header.stream, "#  define {}_PLATFORM_IOS", API);
-    fmt::println(header.stream, "# elif TARGET_IPHONE_SIMULATOR && !defined({}_PLATFORM_IOS)", API);
-    fmt::println(header.stream, "#  define {}_PLATFORM_IOS", API);
-    fmt::println(header.stream, "# elif TARGET_OS_MAC && !defined({}_PLATFORM_MAC_OS)", API);
-    fmt::println(header.stream, "#  define {}_PLATFORM_MAC_OS", API);
-    fmt::println(header.stream, "# else");
-    fmt::println(header.stream, "#  error unsupported Apple platform");
-    fmt::println(header.stream, "# endif");
-    fmt::println(header.stream, "#elif defined(__ANDROID__) && !defined({}_PLATFORM_ANDROID)", API);
-    fmt::println(header.stream, "# define {}_PLATFORM_ANDROID", API);
-    fmt::println(header.stream, "#elif defined(__linux__) && !defined({}_PLATFORM_LINUX)", API);
-    fmt::println(header.stream, "# define {}_PLATFORM_LINUX", API);
-    fmt::println(header.stream, "#elif defined(__EMSCRIPTEN__) && !defined({}_PLATFORM_WEB)", API);
-    fmt::println(header.stream, "# define {}_PLATFORM_WEB", API);
-    fmt::println(header.stream, "#else");
-    fmt::println(header.stream, "# error unsupported platform");
-    fmt::println(header.stream, "#endif");
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "#ifdef __cpp_constexpr");
-    fmt::println(header.stream, "#  define {}_CONSTEXPR constexpr", API);
-    fmt::println(header.stream, "#  if __cpp_constexpr >= 201304L");
-    fmt::println(header.stream, "#    define {}_CONSTEXPR_14 constexpr", API);
-    fmt::println(header.stream, "#  else");
-    fmt::println(header.stream, "#    define {}_CONSTEXPR_14", API);
-    fmt::println(header.stream, "#  endif");
-    fmt::println(header.stream, "#else");
-    fmt::println(header.stream, "#  define {}_CONSTEXPR", API);
-    fmt::println(header.stream, "#  define {}_CONSTEXPR_14", API);
-    fmt::println(header.stream, "#endif");
-    fmt::println(header.stream, "");
+    idl::println(header.stream, " *          This allows proper importing of symbols from DLLs on Windows platforms.");
+    idl::println(header.stream, " * @note    Define `{}_STATIC_BUILD` for static library configuration.{}", API, group);
+    idl::println(header.stream, " */");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "#ifndef {}", importAPI);
+    idl::println(header.stream, "# if defined(_MSC_VER) && !defined({}_STATIC_BUILD)", API);
+    idl::println(header.stream, "#  define {} __declspec(dllimport)", importAPI);
+    idl::println(header.stream, "# else");
+    idl::println(header.stream, "#  define {}", importAPI);
+    idl::println(header.stream, "# endif");
+    idl::println(header.stream, "#endif");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "#if defined(_WIN32) && !defined({}_PLATFORM_WINDOWS)", API);
+    idl::println(header.stream, "# define {}_PLATFORM_WINDOWS", API);
+    idl::println(header.stream, "#elif defined(__APPLE__)");
+    idl::println(header.stream, "# include <TargetConditionals.h>");
+    idl::println(header.stream, "# include <unistd.h>");
+    idl::println(header.stream, "# if TARGET_OS_IPHONE && !defined({}_PLATFORM_IOS)", API);
+    idl::println(header.stream, "#  define {}_PLATFORM_IOS", API);
+    idl::println(header.stream, "# elif TARGET_IPHONE_SIMULATOR && !defined({}_PLATFORM_IOS)", API);
+    idl::println(header.stream, "#  define {}_PLATFORM_IOS", API);
+    idl::println(header.stream, "# elif TARGET_OS_MAC && !defined({}_PLATFORM_MAC_OS)", API);
+    idl::println(header.stream, "#  define {}_PLATFORM_MAC_OS", API);
+    idl::println(header.stream, "# else");
+    idl::println(header.stream, "#  error unsupported Apple platform");
+    idl::println(header.stream, "# endif");
+    idl::println(header.stream, "#elif defined(__ANDROID__) && !defined({}_PLATFORM_ANDROID)", API);
+    idl::println(header.stream, "# define {}_PLATFORM_ANDROID", API);
+    idl::println(header.stream, "#elif defined(__linux__) && !defined({}_PLATFORM_LINUX)", API);
+    idl::println(header.stream, "# define {}_PLATFORM_LINUX", API);
+    idl::println(header.stream, "#elif defined(__EMSCRIPTEN__) && !defined({}_PLATFORM_WEB)", API);
+    idl::println(header.stream, "# define {}_PLATFORM_WEB", API);
+    idl::println(header.stream, "#else");
+    idl::println(header.stream, "# error unsupported platform");
+    idl::println(header.stream, "#endif");
+    idl::println(header.stream, "");
+    idl::println(header.stream, "#ifdef __cpp_constexpr");
+    idl::println(header.stream, "#  define {}_CONSTEXPR constexpr", API);
+    idl::println(header.stream, "#  if __cpp_constexpr >= 201304L");
+    idl::println(header.stream, "#    define {}_CONSTEXPR_14 constexpr", API);
+    idl::println(header.stream, "#  else");
+    idl::println(header.stream, "#    define {}_CONSTEXPR_14", API);
+    idl::println(header.stream, "#  endif");
+    idl::println(header.stream, "#else");
+    idl::println(header.stream, "#  define {}_CONSTEXPR", API);
+    idl::println(header.stream, "#  define {}_CONSTEXPR_14", API);
+    idl::println(header.stream, "#endif");
+    idl::println(header.stream, "");
     if (grouping) {
-        fmt::println(header.stream, "/**");
-        fmt::println(header.stream, " * @addtogroup types Types");
-        fmt::println(header.stream, " * @{{");
-        fmt::println(header.stream, " */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/**");
+        idl::println(header.stream, " * @addtogroup types Types");
+        idl::println(header.stream, " * @{{");
+        idl::println(header.stream, " */");
+        idl::println(header.stream, "");
     }
-    fmt::println(header.stream, "/**");
-    fmt::println(header.stream, " * @name  Platform-independent type definitions.");
-    fmt::println(header.stream, " * @brief Fixed-size types guaranteed to work across all supported platforms.");
-    fmt::println(header.stream, " * @{{");
-    fmt::println(header.stream, " */");
-    fmt::println(header.stream, "#include <stdint.h>");
+    idl::println(header.stream, "/**");
+    idl::println(header.stream, " * @name  Platform-independent type definitions.");
+    idl::println(header.stream, " * @brief Fixed-size types guaranteed to work across all supported platforms.");
+    idl::println(header.stream, " * @{{");
+    idl::println(header.stream, " */");
+    idl::println(header.stream, "#include <stdint.h>");
     for (const auto& [native, type, decl] : trivialTypes) {
-        fmt::print(header.stream, "typedef {:<{}} {:<{}}", native, maxLength, type + ';', maxLengthType + 1);
+        idl::print(header.stream, "typedef {:<{}} {:<{}}", native, maxLength, type + ';', maxLengthType + 1);
         generateInlineDoc(header, decl);
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "");
     }
-    fmt::println(header.stream, "/** @}} */");
-    fmt::println(header.stream, "");
+    idl::println(header.stream, "/** @}} */");
+    idl::println(header.stream, "");
     if (grouping) {
-        fmt::println(header.stream, "/** @}} */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/** @}} */");
+        idl::println(header.stream, "");
     }
     constexpr auto tmpFlags = R"(/**
  * @def       {API}_FLAGS
@@ -997,26 +984,26 @@ inline {API}_CONSTEXPR_14 {api}_enum_t& operator^=({api}_enum_t& lhr, {api}_enum
 #else
 # define {API}_FLAGS({api}_enum_t)
 #endif)";
-    fmt::println(header.stream,
+    idl::println(header.stream,
                  tmpFlags,
                  fmt::arg("API", API),
                  fmt::arg("api", api),
                  fmt::arg("int", intType),
                  fmt::arg("group", grouping ? "\n * @ingroup   macros" : ""));
-    fmt::println(header.stream, "");
-    fmt::println(header.stream, "/**");
-    fmt::println(header.stream, " * @def       {}_TYPE", API);
-    fmt::println(header.stream, " * @brief     Declares an opaque handle type.");
-    fmt::println(header.stream, " * @details   Creates a typedef for a pointer to an incomplete struct type,");
-    fmt::println(header.stream, " *            providing type safety while hiding implementation details.");
-    fmt::println(header.stream,
+    idl::println(header.stream, "");
+    idl::println(header.stream, "/**");
+    idl::println(header.stream, " * @def       {}_TYPE", API);
+    idl::println(header.stream, " * @brief     Declares an opaque handle type.");
+    idl::println(header.stream, " * @details   Creates a typedef for a pointer to an incomplete struct type,");
+    idl::println(header.stream, " *            providing type safety while hiding implementation details.");
+    idl::println(header.stream,
                  " * @param[in] {}_name Base name for the type (suffix `_t` will be added).{}",
                  api,
                  grouping ? "\n * @ingroup   macros" : "");
-    fmt::println(header.stream, " */");
-    fmt::println(header.stream, "#define {}_TYPE({}_name) \\", API, api);
-    fmt::println(header.stream, "typedef struct _##{}_name* {}_name##_t;", api, api);
-    fmt::println(header.stream, "");
+    idl::println(header.stream, " */");
+    idl::println(header.stream, "#define {}_TYPE({}_name) \\", API, api);
+    idl::println(header.stream, "typedef struct _##{}_name* {}_name##_t;", api, api);
+    idl::println(header.stream, "");
     ctx.filter<ASTStruct>([&header, &API, &api, grouping](ASTStruct* node) {
         if (node->findAttr<ASTAttrHandle>()) {
             size_t maxLength = 0;
@@ -1030,23 +1017,23 @@ inline {API}_CONSTEXPR_14 {api}_enum_t& operator^=({api}_enum_t& lhr, {api}_enum
             }
             auto name = getDeclCName(node, 2);
 
-            fmt::println(header.stream, "/**");
-            fmt::println(header.stream, " * @def       {}_HANDLE", API);
-            fmt::println(header.stream, " * @brief     Declares an index-based handle type.");
-            fmt::println(header.stream, " * @details   Creates a struct containing an index value, typically used for");
-            fmt::println(header.stream, " *            resource handles in API designs that avoid direct pointers.");
-            fmt::println(header.stream,
+            idl::println(header.stream, "/**");
+            idl::println(header.stream, " * @def       {}_HANDLE", API);
+            idl::println(header.stream, " * @brief     Declares an index-based handle type.");
+            idl::println(header.stream, " * @details   Creates a struct containing an index value, typically used for");
+            idl::println(header.stream, " *            resource handles in API designs that avoid direct pointers.");
+            idl::println(header.stream,
                          " * @param[in] {}_name Base name for the handle type (suffix `_h` will be added).{}",
                          api,
                          grouping ? "\n * @ingroup   macros" : "");
-            fmt::println(header.stream, " */");
-            fmt::println(header.stream, "#define {}({}_name) \\", upper(name), api);
-            fmt::println(header.stream, "typedef struct _##{}_name {{ \\", api);
+            idl::println(header.stream, " */");
+            idl::println(header.stream, "#define {}({}_name) \\", upper(name), api);
+            idl::println(header.stream, "typedef struct _##{}_name {{ \\", api);
             for (const auto& [key, value] : typeNames) {
-                fmt::println(header.stream, "{:<{}}{:<{}} {}; \\", ' ', 4, key, maxLength, value);
+                idl::println(header.stream, "{:<{}}{:<{}} {}; \\", ' ', 4, key, maxLength, value);
             }
-            fmt::println(header.stream, "}} {}_name##_h;", api);
-            fmt::println(header.stream, "");
+            idl::println(header.stream, "}} {}_name##_h;", api);
+            idl::println(header.stream, "");
         }
     });
     endHeader(ctx, header);
@@ -1069,7 +1056,7 @@ static void generateTypes(idl::Context& ctx,
     std::vector<ASTLiteralStr> strings;
     strings.reserve(20);
     auto addDocField = [&strings](std::vector<std::string>&& data) {
-        std::vector<ASTNode*> nodes;
+        ASTVector<ASTNode*> nodes;
         for (const auto& str : data) {
             strings.push_back({});
             strings.back().value = str;
@@ -1079,12 +1066,12 @@ static void generateTypes(idl::Context& ctx,
     };
 
     ASTDoc doc{};
-    doc.brief = addDocField({ "Core type definitions for the " + ctx.api()->name + " framework." });
+    doc.brief = addDocField({ "Core type definitions for the " + std::string(ctx.api()->name) + " framework." });
     if (hasInterfaces || hasHandles) {
         std::vector<std::string> detail;
         detail.push_back("This header defines the fundamental object types and handles used throughout");
         detail.push_back("\n");
-        detail.push_back("the " + ctx.api()->name +
+        detail.push_back("the " + std::string(ctx.api()->name) +
                          " framework. It provides forward declarations for all major system");
         detail.push_back("\n");
         std::string components = "components using ";
@@ -1115,11 +1102,11 @@ static void generateTypes(idl::Context& ctx,
     beginHeader(ctx, header, "platform");
 
     if (grouping) {
-        fmt::println(header.stream, "/**");
-        fmt::println(header.stream, " * @addtogroup types Types");
-        fmt::println(header.stream, " * @{{");
-        fmt::println(header.stream, " */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/**");
+        idl::println(header.stream, " * @addtogroup types Types");
+        idl::println(header.stream, " * @{{");
+        idl::println(header.stream, " */");
+        idl::println(header.stream, "");
     }
 
     if (hasInterfaces) {
@@ -1132,25 +1119,25 @@ static void generateTypes(idl::Context& ctx,
                 maxLength = decls.back().first.length();
             }
         });
-        fmt::println(header.stream, "/**");
-        fmt::println(header.stream, " * @name    Opaque Object Types");
-        fmt::println(header.stream,
+        idl::println(header.stream, "/**");
+        idl::println(header.stream, " * @name    Opaque Object Types");
+        idl::println(header.stream,
                      " * @brief   Forward declarations for framework objects using opaque pointer types");
-        fmt::println(header.stream,
+        idl::println(header.stream,
                      " * @details These macros generate typedefs for pointers to incomplete struct types,");
-        fmt::println(header.stream,
+        idl::println(header.stream,
                      " *          providing type safety while hiding implementation details. Each represents");
-        fmt::println(header.stream, " *          a major subsystem in the {} framework.", ctx.api()->name);
-        fmt::println(header.stream, " * @sa      {}_TYPE", API);
-        fmt::println(header.stream, " * @{{");
-        fmt::println(header.stream, " */");
+        idl::println(header.stream, " *          a major subsystem in the {} framework.", ctx.api()->name);
+        idl::println(header.stream, " * @sa      {}_TYPE", API);
+        idl::println(header.stream, " * @{{");
+        idl::println(header.stream, " */");
         for (const auto& [str, decl] : decls) {
-            fmt::print(header.stream, "{:<{}}", str, maxLength);
+            idl::print(header.stream, "{:<{}}", str, maxLength);
             generateInlineDoc(header, decl, true, true);
-            fmt::println(header.stream, "");
+            idl::println(header.stream, "");
         }
-        fmt::println(header.stream, "/** @}} */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/** @}} */");
+        idl::println(header.stream, "");
     }
     if (hasHandles) {
         size_t maxLength = 0;
@@ -1162,26 +1149,26 @@ static void generateTypes(idl::Context& ctx,
                 maxLength = decls.back().first.length();
             }
         });
-        fmt::println(header.stream, "/**");
-        fmt::println(header.stream, " * @name    Resource Handles");
-        fmt::println(header.stream, " * @brief   Index-based handles");
-        fmt::println(header.stream, " * @details These macros generate lightweight handle types,");
-        fmt::println(header.stream, " *          using indices rather than pointers for better memory management");
-        fmt::println(header.stream, " *          and cross-API compatibility. Each handle contains an internal index.");
-        fmt::println(header.stream, " * @sa      {}_HANDLE", API);
-        fmt::println(header.stream, " * @{{");
-        fmt::println(header.stream, " */");
+        idl::println(header.stream, "/**");
+        idl::println(header.stream, " * @name    Resource Handles");
+        idl::println(header.stream, " * @brief   Index-based handles");
+        idl::println(header.stream, " * @details These macros generate lightweight handle types,");
+        idl::println(header.stream, " *          using indices rather than pointers for better memory management");
+        idl::println(header.stream, " *          and cross-API compatibility. Each handle contains an internal index.");
+        idl::println(header.stream, " * @sa      {}_HANDLE", API);
+        idl::println(header.stream, " * @{{");
+        idl::println(header.stream, " */");
         for (const auto& [str, decl] : decls) {
-            fmt::print(header.stream, "{:<{}}", str, maxLength);
+            idl::print(header.stream, "{:<{}}", str, maxLength);
             generateInlineDoc(header, decl);
-            fmt::println(header.stream, "");
+            idl::println(header.stream, "");
         }
-        fmt::println(header.stream, "/** @}} */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/** @}} */");
+        idl::println(header.stream, "");
     }
     if (grouping) {
-        fmt::println(header.stream, "/** @}} */");
-        fmt::println(header.stream, "");
+        idl::println(header.stream, "/** @}} */");
+        idl::println(header.stream, "");
     }
     endHeader(ctx, header);
 }
@@ -1276,13 +1263,57 @@ void generateC(idl::Context& ctx,
         return true;
     });
 
-    generateVersion(ctx, out, writer, writerData, docGrouping);
-    generatePlatform(ctx, out, writer, writerData, docGrouping);
-    generateTypes(ctx, out, hasInterfaces, hasHandles, writer, writerData, docGrouping);
+    // Each header is rendered into its own buffer on the pool and then
+    // passed to the writer (or written to disk) in the sequential order.
+    std::vector<std::function<void(idl_write_callback_t, idl_data_t)>> tasks;
+    tasks.reserve(ctx.api()->files.size() + 4);
+    tasks.push_back([&](auto writer, auto writerData) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", "c.generateVersion");
+        generateVersion(ctx, out, writer, writerData, docGrouping);
+    });
+    tasks.push_back([&](auto writer, auto writerData) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", "c.generatePlatform");
+        generatePlatform(ctx, out, writer, writerData, docGrouping);
+    });
+    tasks.push_back([&](auto writer, auto writerData) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", "c.generateTypes");
+        generateTypes(ctx, out, hasInterfaces, hasHandles, writer, writerData, docGrouping);
+    });
     ASTFile* prevFile = nullptr;
     for (auto file : ctx.api()->files) {
-        generateFile(ctx, out, file, prevFile, writer, writerData, docGrouping);
+        tasks.push_back([&, file, prevFile](auto writer, auto writerData) {
+            PhaseTimer timer(ctx.options(), ctx.result(), "generator", fmt::format("c.generateFile:{}", file->name));
+            const auto slot   = fmt::format("c\n{}\n{}", out.string(), file->name);
+            const auto prev   = prevFile ? std::string_view(prevFile->name) : std::string_view();
+            const auto inputs = fmt::format("{}\n{}", prev, docGrouping);
+            ctx.generateFile(file, slot, inputs, writer, writerData, [&](auto write, auto writeData) {
+                generateFile(ctx, out, file, prevFile, write, writeData, docGrouping);
+            });
+        });
         prevFile = file;
     }
-    generateMain(ctx, out, prevFile, writer, writerData, includes, docGrouping);
+    tasks.push_back([&, prevFile](auto writer, auto writerData) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", "c.generateMain");
+        generateMain(ctx, out, prevFile, writer, writerData, includes, docGrouping);
+    });
+
+    auto capture = [](const idl_source_t* source, idl_data_t data) {
+        static_cast<Output*>(data)->name = source->name;
+        static_cast<Output*>(data)->data.assign(source->data, source->size);
+    };
+    std::vector<Output> outputs(tasks.size());
+    const auto jobs = ctx.options() ? ctx.options()->jobs() : 1;
+    parallelFor(tasks.size(), jobs, [&tasks, &outputs, capture](size_t i) {
+        tasks[i](capture, &outputs[i]);
+    });
+
+    for (const auto& output : outputs) {
+        if (writer) {
+            idl_source_t source{ output.name.c_str(), output.data.c_str(), (idl_uint32_t) output.data.length() };
+            writer(&source, writerData);
+        } else {
+            writeOutput(ctx.api()->location, ctx.options(), ctx.result(), out / output.name, output.data);
+            ctx.addOutput(out / output.name);
+        }
+    }
 }
@@ -1,5 +1,7 @@
 #include "case_converter.hpp"
 #include "context.hpp"
+#include "output_sink.hpp"
+#include "trace.hpp"
 
 #include <stduuid/uuid.h>
 
@@ -26,12 +28,7 @@ struct Package {
 };
 
 struct Stream {
-    std::ostream& stream;
-    std::unique_ptr<std::ofstream> fstream;
-    std::unique_ptr<std::ostringstream> sstream;
-    std::string filename;
-    idl_write_callback_t writer;
-    idl_data_t writerData;
+    OutputSink stream;
 };
 
 struct CSharpName : Visitor {
@@ -80,7 +77,7 @@ struct CSharpName : Visitor {
     }
 
     static std::string changeCase(ASTDecl* decl, Case newCase = Case::PascalCase) {
-        std::vector<int>* nums = nullptr;
+        ASTVector<int>* nums = nullptr;
         if (auto attr = decl->findAttr<ASTAttrTokenizer>()) {
             nums = &attr->nums;
         }
@@ -454,7 +451,7 @@ static std::pair<std::string, std::string> keyValue(const std::string& addition)
     return { addition, "" };
 }
 
-static std::string docString(const std::vector<ASTNode*>& nodes) {
+static std::string docString(const ASTVector<ASTNode*>& nodes) {
     std::ostringstream ss;
     for (auto node : nodes) {
         if (auto str = node->as<ASTLiteralStr>()) {
@@ -473,28 +470,11 @@ static Stream createStream(idl::Context& ctx,
                            const std::string& filename,
                            idl_write_callback_t writer,
                            idl_data_t writerData) {
-    std::filesystem::create_directories(out);
-    auto name = out / filename;
-    if (writer) {
-        auto stream = std::make_unique<std::ostringstream>();
-        auto ptr    = stream.get();
-        return { *ptr, nullptr, std::move(stream), filename, writer, writerData };
-    } else {
-        auto stream = std::make_unique<std::ofstream>(std::ofstream(name));
-        if (stream->fail()) {
-            idl::err<IDL_STATUS_E2067>(ctx.api()->location, name.string());
-        }
-        auto ptr = stream.get();
-        return { *ptr, std::move(stream) };
-    }
+    return { OutputSink(ctx, out, filename, writer, writerData) };
 }
 
 static void endStream(Stream& stream) {
-    if (stream.writer) {
-        const std::string data = stream.sstream->str();
-        idl_source_t source{ stream.filename.c_str(), data.c_str(), (idl_uint32_t) data.length() };
-        stream.writer(&source, stream.writerData);
-    }
+    stream.stream.flush();
 }
 
 std::string escapeXml(const std::string& str) {
@@ -567,7 +547,7 @@ static void createTargets(const Package& package,
 )xml";
 
     auto stream = createStream(ctx, out, package.assemblyName + ".targets", writer, writerData);
-    fmt::println(stream.stream, targets, winName, osxName, linuxName);
+    idl::println(stream.stream, targets, winName, osxName, linuxName);
     endStream(stream);
 }
 
@@ -628,9 +608,9 @@ static void createProj(const Package& package,
     std::string description;
 
     auto stream = createStream(ctx, out, package.assemblyName + ".csproj", writer, writerData);
-    fmt::println(stream.stream, "{}", "<Project Sdk=\"Microsoft.NET.Sdk\">");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "{}", "<Project Sdk=\"Microsoft.NET.Sdk\">");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream,
                  props,
                  fmt::arg("assemblyName", package.assemblyName),
                  fmt::arg("rootNamespace", package.rootNamespace),
@@ -647,12 +627,12 @@ static void createProj(const Package& package,
                  fmt::arg("readmeFile", readme),
                  fmt::arg("license", license));
 
-    fmt::println(stream.stream, "  <ItemGroup>");
+    idl::println(stream.stream, "  <ItemGroup>");
     auto addDll = [&stream, &out](const std::string& fullpath, const std::string& folder) {
         if (fullpath.length()) {
             std::filesystem::path path(fullpath);
             const auto rel = std::filesystem::relative(path, out).string();
-            fmt::println(stream.stream,
+            idl::println(stream.stream,
                          R"(    <Content Include="{}">
       <PackagePath>runtimes/{}/native</PackagePath>
       <Pack>true</Pack>
@@ -664,19 +644,19 @@ static void createProj(const Package& package,
     addDll(package.dllwin32, "win-x86");
     addDll(package.dllwin64, "win-x64");
     const auto targets = package.assemblyName + ".targets";
-    fmt::println(stream.stream,
+    idl::println(stream.stream,
                  R"(    <Content Include="{targets}">
       <PackagePath>build/net40/{targets}</PackagePath>
       <Pack>true</Pack>
     </Content>)",
                  fmt::arg("targets", targets));
-    fmt::println(stream.stream, "  </ItemGroup>");
-    fmt::println(stream.stream, "");
+    idl::println(stream.stream, "  </ItemGroup>");
+    idl::println(stream.stream, "");
 
     if (package.readmeFile.length()) {
         std::filesystem::path path(package.readmeFile);
         const auto rel = std::filesystem::relative(path, out);
-        fmt::println(stream.stream,
+        idl::println(stream.stream,
                      R"(  <ItemGroup>
     <None Include="{}">
       <Pack>True</Pack>
@@ -689,7 +669,7 @@ static void createProj(const Package& package,
     if (package.licenseFile.length()) {
         std::filesystem::path path(package.licenseFile);
         const auto rel = std::filesystem::relative(path, out);
-        fmt::println(stream.stream,
+        idl::println(stream.stream,
                      R"(  <ItemGroup>
     <None Include="{}">
       <Pack>True</Pack>
@@ -699,11 +679,11 @@ static void createProj(const Package& package,
 )",
                      rel.string());
     }
-    fmt::println(stream.stream, R"(  <ItemGroup>
+    idl::println(stream.stream, R"(  <ItemGroup>
     <PackageReference Include="System.Runtime.CompilerServices.Unsafe" Version="6.1.2" />
   </ItemGroup>
 )");
-    fmt::println(stream.stream, "</Project>");
+    idl::println(stream.stream, "</Project>");
     endStream(stream);
 }
 
@@ -749,7 +729,7 @@ Global
 EndGlobal)";
 
     auto stream = createStream(ctx, out, package.assemblyName + ".sln", writer, writerData);
-    fmt::println(stream.stream,
+    idl::println(stream.stream,
                  sln,
                  fmt::arg("assembly", package.assemblyName),
                  fmt::arg("solution", solutionGuid),
@@ -757,23 +737,23 @@ EndGlobal)";
     endStream(stream);
 }
 
-static void createDocComment(std::ostream& stream, int indent) {
-    fmt::print(stream, "{:<{}}/// ", ' ', indent);
+static void createDocComment(OutputSink& stream, int indent) {
+    idl::print(stream, "{:<{}}/// ", ' ', indent);
 }
 
-static void createDocField(std::ostream& stream, int indent, const std::vector<ASTNode*> nodes) {
+static void createDocField(OutputSink& stream, int indent, const ASTVector<ASTNode*>& nodes) {
     std::istringstream doc(docString(nodes));
     std::string line;
     while (std::getline(doc, line, '\n')) {
         createDocComment(stream, indent);
-        fmt::println(stream, "{}", line);
+        idl::println(stream, "{}", line);
     }
 }
 
-static void createDoc(std::ostream& stream, int indent, const ASTDoc* doc) {
+static void createDoc(OutputSink& stream, int indent, const ASTDoc* doc) {
     if (!doc->brief.empty() || !doc->detail.empty()) {
         createDocComment(stream, indent);
-        fmt::println(stream, "<summary>");
+        idl::println(stream, "<summary>");
         if (!doc->brief.empty()) {
             createDocField(stream, indent, doc->brief);
         }
@@ -781,7 +761,7 @@ static void createDoc(std::ostream& stream, int indent, const ASTDoc* doc) {
             createDocField(stream, indent, doc->detail);
         }
         createDocComment(stream, indent);
-        fmt::println(stream, "</summary>");
+        idl::println(stream, "</summary>");
     }
 }
 
@@ -791,68 +771,68 @@ static void createNativeContext(const Package& package,
                                 idl_write_callback_t writer,
                                 idl_data_t writerData) {
     auto stream = createStream(ctx, out, "NativeContext.cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "using System.Collections.Generic;");
-    fmt::println(stream.stream, "using System.Runtime.CompilerServices;");
-    fmt::println(stream.stream, "using System.Runtime.InteropServices;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
-    fmt::println(stream.stream, "    internal unsafe class NativeContext : IDisposable");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream, "        private bool disposed = false;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "using System.Collections.Generic;");
+    idl::println(stream.stream, "using System.Runtime.CompilerServices;");
+    idl::println(stream.stream, "using System.Runtime.InteropServices;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
+    idl::println(stream.stream, "    internal unsafe class NativeContext : IDisposable");
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream, "        private bool disposed = false;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream,
                  "        private readonly Dictionary<int, Action> deleters = new Dictionary<int, Action>();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public char* AllocString(int key, string value)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (value == null)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return null;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var buffer = Marshal.StringToHGlobalAnsi(value);");
-    fmt::println(stream.stream, "            AddDeleter(key, () => Marshal.FreeHGlobal(buffer));");
-    fmt::println(stream.stream, "            return (char*)buffer;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        private void AddDeleter(int key, Action action)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (deleters.TryGetValue(key, out var value))");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                value();");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            deleters[key] = action;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void Dispose()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            Dispose(true);");
-    fmt::println(stream.stream, "            GC.SuppressFinalize(this);");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        protected virtual void Dispose(bool disposing)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (!disposed)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                if (disposing)");
-    fmt::println(stream.stream, "                {{");
-    fmt::println(stream.stream, "                    foreach (var deleter in deleters)");
-    fmt::println(stream.stream, "                    {{");
-    fmt::println(stream.stream, "                        deleter.Value();");
-    fmt::println(stream.stream, "                    }}");
-    fmt::println(stream.stream, "                    deleters.Clear();");
-    fmt::println(stream.stream, "                }}");
-    fmt::println(stream.stream, "                disposed = true;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        ~NativeContext()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            Dispose(false);");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public char* AllocString(int key, string value)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (value == null)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return null;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var buffer = Marshal.StringToHGlobalAnsi(value);");
+    idl::println(stream.stream, "            AddDeleter(key, () => Marshal.FreeHGlobal(buffer));");
+    idl::println(stream.stream, "            return (char*)buffer;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        private void AddDeleter(int key, Action action)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (deleters.TryGetValue(key, out var value))");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                value();");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            deleters[key] = action;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void Dispose()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            Dispose(true);");
+    idl::println(stream.stream, "            GC.SuppressFinalize(this);");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        protected virtual void Dispose(bool disposing)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (!disposed)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                if (disposing)");
+    idl::println(stream.stream, "                {{");
+    idl::println(stream.stream, "                    foreach (var deleter in deleters)");
+    idl::println(stream.stream, "                    {{");
+    idl::println(stream.stream, "                        deleter.Value();");
+    idl::println(stream.stream, "                    }}");
+    idl::println(stream.stream, "                    deleters.Clear();");
+    idl::println(stream.stream, "                }}");
+    idl::println(stream.stream, "                disposed = true;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        ~NativeContext()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            Dispose(false);");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -917,41 +897,41 @@ static void createStructures(const Package& package,
 )";
 
     auto stream = createStream(ctx, out, "Structures.cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "using System.Collections;");
-    fmt::println(stream.stream, "using System.Collections.Generic;");
-    fmt::println(stream.stream, "using System.Runtime.CompilerServices;");
-    fmt::println(stream.stream, "using System.Runtime.InteropServices;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
-    fmt::println(stream.stream, baseClass);
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "using System.Collections;");
+    idl::println(stream.stream, "using System.Collections.Generic;");
+    idl::println(stream.stream, "using System.Runtime.CompilerServices;");
+    idl::println(stream.stream, "using System.Runtime.InteropServices;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
+    idl::println(stream.stream, baseClass);
     ctx.filter<ASTStruct>([&stream](ASTStruct* node) {
         if (!node->findAttr<ASTAttrHandle>()) {
             const auto name = csharpName(node);
-            fmt::println(stream.stream, "    public unsafe class {} : Base", name);
-            fmt::println(stream.stream, "    {{");
-            fmt::println(stream.stream, "        public {}() : base(Unsafe.SizeOf<NativeWrapper.{}>())", name, name);
-            fmt::println(stream.stream, "        {{");
-            fmt::println(stream.stream, "        }}");
-            fmt::println(stream.stream, "");
-            fmt::println(stream.stream,
+            idl::println(stream.stream, "    public unsafe class {} : Base", name);
+            idl::println(stream.stream, "    {{");
+            idl::println(stream.stream, "        public {}() : base(Unsafe.SizeOf<NativeWrapper.{}>())", name, name);
+            idl::println(stream.stream, "        {{");
+            idl::println(stream.stream, "        }}");
+            idl::println(stream.stream, "");
+            idl::println(stream.stream,
                          "        internal {}(NativeContext context, NativeWrapper.{}* ptr, bool owned = true) : "
                          "base(context, Unsafe.SizeOf<NativeWrapper.{}>(), ptr, owned)",
                          name,
                          name,
                          name);
-            fmt::println(stream.stream, "        {{");
-            fmt::println(stream.stream, "        }}");
-            fmt::println(stream.stream, "");
-            fmt::println(
+            idl::println(stream.stream, "        {{");
+            idl::println(stream.stream, "        }}");
+            idl::println(stream.stream, "");
+            idl::println(
                 stream.stream, "        internal NativeWrapper.{}* Ptr => (NativeWrapper.{}*)handle;", name, name);
-            fmt::println(stream.stream, "");
-            fmt::println(stream.stream, "    }}");
-            fmt::println(stream.stream, "");
+            idl::println(stream.stream, "");
+            idl::println(stream.stream, "    }}");
+            idl::println(stream.stream, "");
         }
     });
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -961,300 +941,300 @@ static void createMarshallers(const Package& package,
                               idl_write_callback_t writer,
                               idl_data_t writerData) {
     auto stream = createStream(ctx, out, "Marshallers.cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "using System.Collections.Generic;");
-    fmt::println(stream.stream, "using System.Linq;");
-    fmt::println(stream.stream, "using System.Reflection;");
-    fmt::println(stream.stream, "using System.Runtime.CompilerServices;");
-    fmt::println(stream.stream, "using System.Runtime.InteropServices;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
-    fmt::println(stream.stream, "    internal class StringMarshaller : ICustomMarshaler");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "using System.Collections.Generic;");
+    idl::println(stream.stream, "using System.Linq;");
+    idl::println(stream.stream, "using System.Reflection;");
+    idl::println(stream.stream, "using System.Runtime.CompilerServices;");
+    idl::println(stream.stream, "using System.Runtime.InteropServices;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
+    idl::println(stream.stream, "    internal class StringMarshaller : ICustomMarshaler");
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream,
                  "        public static ICustomMarshaler GetInstance(string cookie) => new StringMarshaller();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            return Marshal.PtrToStringAnsi(pNativeData);");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "");
-    fmt::println(
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            return Marshal.PtrToStringAnsi(pNativeData);");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "");
+    idl::println(
         stream.stream,
         "    internal unsafe class ArrOutMarshaller<Raw, T> : ICustomMarshaler where Raw : unmanaged where T : Base");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(
+    idl::println(stream.stream, "    {{");
+    idl::println(
         stream.stream,
         "        public static ICustomMarshaler GetInstance(string cookie) => new ArrOutMarshaller<Raw, T>();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData - IntPtr.Size);");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (ManagedObj == null)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return IntPtr.Zero;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var enumerable = (T[])ManagedObj;");
-    fmt::println(stream.stream, "            var handle = GCHandle.Alloc(enumerable);");
-    fmt::println(
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData - IntPtr.Size);");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (ManagedObj == null)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return IntPtr.Zero;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var enumerable = (T[])ManagedObj;");
+    idl::println(stream.stream, "            var handle = GCHandle.Alloc(enumerable);");
+    idl::println(
         stream.stream,
         "            var ptr = Marshal.AllocHGlobal(enumerable.Count() * Unsafe.SizeOf<Raw>() + IntPtr.Size);");
-    fmt::println(stream.stream, "            Unsafe.Write((void*)ptr, GCHandle.ToIntPtr(handle));");
-    fmt::println(stream.stream, "            return ptr + IntPtr.Size;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData == IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return null;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var addr = Unsafe.Read<IntPtr>((void*)(pNativeData - IntPtr.Size));");
-    fmt::println(stream.stream, "            var handle = GCHandle.FromIntPtr(addr);");
-    fmt::println(stream.stream, "            var arr = (T[])handle.Target;");
-    fmt::println(stream.stream, "            handle.Free();");
-    fmt::println(stream.stream, "            if (arr.Length > 0) {{");
-    fmt::println(stream.stream, "                var marshaller = TypeMarshaller<Raw, T>.GetInstance(\"\");");
-    fmt::println(stream.stream, "                for (var i = 0; i < arr.Length; ++i)");
-    fmt::println(stream.stream, "                {{");
-    fmt::println(stream.stream, "                    arr[i] = (T) marshaller.MarshalNativeToManaged(pNativeData);");
-    fmt::println(stream.stream, "                    pNativeData += Unsafe.SizeOf<Raw>();");
-    fmt::println(stream.stream, "                }}");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            return arr;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "    internal unsafe class OpaqueTypeMarshaller<T> : ICustomMarshaler where T : class");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "            Unsafe.Write((void*)ptr, GCHandle.ToIntPtr(handle));");
+    idl::println(stream.stream, "            return ptr + IntPtr.Size;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData == IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return null;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var addr = Unsafe.Read<IntPtr>((void*)(pNativeData - IntPtr.Size));");
+    idl::println(stream.stream, "            var handle = GCHandle.FromIntPtr(addr);");
+    idl::println(stream.stream, "            var arr = (T[])handle.Target;");
+    idl::println(stream.stream, "            handle.Free();");
+    idl::println(stream.stream, "            if (arr.Length > 0) {{");
+    idl::println(stream.stream, "                var marshaller = TypeMarshaller<Raw, T>.GetInstance(\"\");");
+    idl::println(stream.stream, "                for (var i = 0; i < arr.Length; ++i)");
+    idl::println(stream.stream, "                {{");
+    idl::println(stream.stream, "                    arr[i] = (T) marshaller.MarshalNativeToManaged(pNativeData);");
+    idl::println(stream.stream, "                    pNativeData += Unsafe.SizeOf<Raw>();");
+    idl::println(stream.stream, "                }}");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            return arr;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "    internal unsafe class OpaqueTypeMarshaller<T> : ICustomMarshaler where T : class");
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream,
                  "        public static ICustomMarshaler GetInstance(string cookie) => new OpaqueTypeMarshaller<T>();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            var paramTypes = new Type[] {{ typeof(IntPtr) }};");
-    fmt::println(stream.stream, "            var paramValues = new object[] {{ pNativeData }};");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            var paramTypes = new Type[] {{ typeof(IntPtr) }};");
+    idl::println(stream.stream, "            var paramValues = new object[] {{ pNativeData }};");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream,
                  "            var ci = typeof(T).GetConstructor(BindingFlags.Instance | BindingFlags.NonPublic, null, "
                  "paramTypes, null);");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "            return ci.Invoke(paramValues);");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "    ");
-    fmt::println(stream.stream, "    internal unsafe class ArrStringMarshaller : ICustomMarshaler");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "            return ci.Invoke(paramValues);");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "    ");
+    idl::println(stream.stream, "    internal unsafe class ArrStringMarshaller : ICustomMarshaler");
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream,
                  "        public static ICustomMarshaler GetInstance(string cookie) => new ArrStringMarshaller();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData - IntPtr.Size);");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (ManagedObj == null)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return IntPtr.Zero;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var strings = (string[])ManagedObj;");
-    fmt::println(stream.stream, "            var handle = GCHandle.Alloc(strings);");
-    fmt::println(stream.stream, "            var ptr = Marshal.AllocHGlobal((strings.Length + 1) * IntPtr.Size);");
-    fmt::println(stream.stream, "            Unsafe.Write((void*)ptr, GCHandle.ToIntPtr(handle));");
-    fmt::println(stream.stream, "            return ptr + IntPtr.Size;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData == IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return null;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var addr = Unsafe.Read<IntPtr>((void*)(pNativeData - IntPtr.Size));");
-    fmt::println(stream.stream, "            var handle = GCHandle.FromIntPtr(addr);");
-    fmt::println(stream.stream, "            var arr = (string[])handle.Target;");
-    fmt::println(stream.stream, "            handle.Free();");
-    fmt::println(stream.stream, "            for (var i = 0; i < arr.Length; ++i)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                var item = Unsafe.Read<IntPtr>((void*)(pNativeData));");
-    fmt::println(stream.stream, "                arr[i] = Marshal.PtrToStringAnsi(item);");
-    fmt::println(stream.stream, "                pNativeData += IntPtr.Size;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            return arr;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "");
-    fmt::println(
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData - IntPtr.Size);");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (ManagedObj == null)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return IntPtr.Zero;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var strings = (string[])ManagedObj;");
+    idl::println(stream.stream, "            var handle = GCHandle.Alloc(strings);");
+    idl::println(stream.stream, "            var ptr = Marshal.AllocHGlobal((strings.Length + 1) * IntPtr.Size);");
+    idl::println(stream.stream, "            Unsafe.Write((void*)ptr, GCHandle.ToIntPtr(handle));");
+    idl::println(stream.stream, "            return ptr + IntPtr.Size;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData == IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return null;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var addr = Unsafe.Read<IntPtr>((void*)(pNativeData - IntPtr.Size));");
+    idl::println(stream.stream, "            var handle = GCHandle.FromIntPtr(addr);");
+    idl::println(stream.stream, "            var arr = (string[])handle.Target;");
+    idl::println(stream.stream, "            handle.Free();");
+    idl::println(stream.stream, "            for (var i = 0; i < arr.Length; ++i)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                var item = Unsafe.Read<IntPtr>((void*)(pNativeData));");
+    idl::println(stream.stream, "                arr[i] = Marshal.PtrToStringAnsi(item);");
+    idl::println(stream.stream, "                pNativeData += IntPtr.Size;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            return arr;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "");
+    idl::println(
         stream.stream,
         "    internal unsafe class ArrMarshaller<Raw, T> : ICustomMarshaler where Raw : unmanaged where T : Base");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream,
                  "        public static ICustomMarshaler GetInstance(string cookie) => new ArrMarshaller<Raw, T>();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData);");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (ManagedObj == null)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                return IntPtr.Zero;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            var enumerable = (IEnumerable<T>)ManagedObj;");
-    fmt::println(stream.stream, "            var size = Marshal.SizeOf<Raw>();");
-    fmt::println(stream.stream, "            var count = enumerable.Count();");
-    fmt::println(stream.stream, "            var buffer = Marshal.AllocHGlobal(size * count);");
-    fmt::println(stream.stream, "            var i = 0;");
-    fmt::println(stream.stream, "            foreach (var value in enumerable)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(stream.stream, "                if (value != null)");
-    fmt::println(stream.stream, "                {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                Marshal.FreeHGlobal(pNativeData);");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (ManagedObj == null)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                return IntPtr.Zero;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            var enumerable = (IEnumerable<T>)ManagedObj;");
+    idl::println(stream.stream, "            var size = Marshal.SizeOf<Raw>();");
+    idl::println(stream.stream, "            var count = enumerable.Count();");
+    idl::println(stream.stream, "            var buffer = Marshal.AllocHGlobal(size * count);");
+    idl::println(stream.stream, "            var i = 0;");
+    idl::println(stream.stream, "            foreach (var value in enumerable)");
+    idl::println(stream.stream, "            {{");
+    idl::println(stream.stream, "                if (value != null)");
+    idl::println(stream.stream, "                {{");
+    idl::println(stream.stream,
                  "                    Unsafe.CopyBlock((void*)(buffer + i * size), (void*)value.Handle, "
                  "(uint)Unsafe.SizeOf<Raw>());");
-    fmt::println(stream.stream, "                }}");
-    fmt::println(stream.stream, "                ++i;");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            return buffer;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            throw new NotImplementedException();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "");
-    fmt::println(
+    idl::println(stream.stream, "                }}");
+    idl::println(stream.stream, "                ++i;");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            return buffer;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            throw new NotImplementedException();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "");
+    idl::println(
         stream.stream,
         "    internal unsafe class TypeMarshaller<Raw, T> : ICustomMarshaler where Raw : unmanaged where T : Base");
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream,
                  "        public static ICustomMarshaler GetInstance(string cookie) => new TypeMarshaller<Raw, T>();");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public int GetNativeDataSize()");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            return Unsafe.SizeOf<Raw>();");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            return ManagedObj != null ? ((T)ManagedObj).Handle : IntPtr.Zero;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
-    fmt::println(stream.stream, "            {{");
-    fmt::println(
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpManagedData(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public void CleanUpNativeData(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public int GetNativeDataSize()");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            return Unsafe.SizeOf<Raw>();");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public IntPtr MarshalManagedToNative(object ManagedObj)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            return ManagedObj != null ? ((T)ManagedObj).Handle : IntPtr.Zero;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        public object MarshalNativeToManaged(IntPtr pNativeData)");
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "            if (pNativeData != IntPtr.Zero)");
+    idl::println(stream.stream, "            {{");
+    idl::println(
         stream.stream,
         "                var paramTypes = new Type[] {{ typeof(NativeContext), typeof(Raw*), typeof(bool) }};");
-    fmt::println(stream.stream, "                var paramValues = new object[] {{ null, pNativeData, true }};");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream,
+    idl::println(stream.stream, "                var paramValues = new object[] {{ null, pNativeData, true }};");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream,
                  "                var ci = typeof(T).GetConstructor(BindingFlags.Instance | BindingFlags.NonPublic, "
                  "null, paramTypes, null);");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "                return ci.Invoke(paramValues);");
-    fmt::println(stream.stream, "            }}");
-    fmt::println(stream.stream, "            return null;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "                return ci.Invoke(paramValues);");
+    idl::println(stream.stream, "            }}");
+    idl::println(stream.stream, "            return null;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -1264,22 +1244,22 @@ static void createEnums(const Package& package,
                         idl_write_callback_t writer,
                         idl_data_t writerData) {
     auto stream = createStream(ctx, out, "Enums.cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
     auto first = true;
     ctx.filter<ASTEnum>([&stream, &first](ASTEnum* node) {
         if (!first) {
-            fmt::println(stream.stream, "");
+            idl::println(stream.stream, "");
         }
         first = false;
         createDoc(stream.stream, 4, node->doc);
         if (node->findAttr<ASTAttrFlags>()) {
-            fmt::println(stream.stream, "    [Flags]");
+            idl::println(stream.stream, "    [Flags]");
         }
-        fmt::println(stream.stream, "    public enum {}", csharpName(node));
-        fmt::println(stream.stream, "    {{");
+        idl::println(stream.stream, "    public enum {}", csharpName(node));
+        idl::println(stream.stream, "    {{");
         for (size_t i = 0; i < node->consts.size(); ++i) {
             const auto isLast = i + 1 == node->consts.size();
 
@@ -1296,13 +1276,13 @@ static void createEnums(const Package& package,
             } else {
                 value = std::to_string(ec->value);
             }
-            fmt::println(stream.stream, "");
+            idl::println(stream.stream, "");
             createDoc(stream.stream, 8, ec->doc);
-            fmt::println(stream.stream, "        {} = {}{}", csharpName(ec), value, isLast ? "" : ",");
+            idl::println(stream.stream, "        {} = {}{}", csharpName(ec), value, isLast ? "" : ",");
         }
-        fmt::println(stream.stream, "    }}");
+        idl::println(stream.stream, "    }}");
     });
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -1319,22 +1299,22 @@ static void createNative(const Package& package,
     });
 
     auto stream = createStream(ctx, out, "NativeWrapper.cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "using System.Collections.Generic;");
-    fmt::println(stream.stream, "using System.Runtime.InteropServices;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "using System.Collections.Generic;");
+    idl::println(stream.stream, "using System.Runtime.InteropServices;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
     if (!checkEnums.empty()) {
-        fmt::println(stream.stream, "    public class BaseException : Exception");
-        fmt::println(stream.stream, "    {{");
-        fmt::println(stream.stream, "        public BaseException(string message) : base(message)");
-        fmt::println(stream.stream, "        {{");
-        fmt::println(stream.stream, "        }}");
-        fmt::println(stream.stream, "    }}    ");
-        fmt::println(stream.stream, "");
+        idl::println(stream.stream, "    public class BaseException : Exception");
+        idl::println(stream.stream, "    {{");
+        idl::println(stream.stream, "        public BaseException(string message) : base(message)");
+        idl::println(stream.stream, "        {{");
+        idl::println(stream.stream, "        }}");
+        idl::println(stream.stream, "    }}    ");
+        idl::println(stream.stream, "");
         for (auto en : checkEnums) {
-            fmt::println(stream.stream,
+            idl::println(stream.stream,
                          R"(    public class {name}Exception : BaseException
     {{
         public {name}Exception({name} result) : base("TODO")
@@ -1348,8 +1328,8 @@ static void createNative(const Package& package,
                          fmt::arg("name", csharpName(en)));
         }
     }
-    fmt::println(stream.stream, "    internal unsafe static class NativeWrapper");
-    fmt::println(stream.stream, "    {{");
+    idl::println(stream.stream, "    internal unsafe static class NativeWrapper");
+    idl::println(stream.stream, "    {{");
     for (auto en : checkEnums) {
         std::vector<ASTEnumConst*> success;
         for (auto ec : en->consts) {
@@ -1358,36 +1338,36 @@ static void createNative(const Package& package,
             }
         }
         const auto enName = csharpName(en);
-        fmt::println(stream.stream, "        public static void Check({} result)", enName);
-        fmt::println(stream.stream, "        {{");
+        idl::println(stream.stream, "        public static void Check({} result)", enName);
+        idl::println(stream.stream, "        {{");
         if (success.size() == 1) {
-            fmt::println(stream.stream, "            if (result != {}.{})", enName, csharpName(success[0]));
-            fmt::println(stream.stream, "            {{");
-            fmt::println(stream.stream, "                throw new {}Exception(result);", enName);
-            fmt::println(stream.stream, "            }}");
+            idl::println(stream.stream, "            if (result != {}.{})", enName, csharpName(success[0]));
+            idl::println(stream.stream, "            {{");
+            idl::println(stream.stream, "                throw new {}Exception(result);", enName);
+            idl::println(stream.stream, "            }}");
         } else if (success.size() > 1) {
-            fmt::println(stream.stream, "            switch (result)");
-            fmt::println(stream.stream, "            {{");
+            idl::println(stream.stream, "            switch (result)");
+            idl::println(stream.stream, "            {{");
             for (auto ec : en->consts) {
-                fmt::println(stream.stream, "                case {}.{}:", enName, csharpName(ec));
+                idl::println(stream.stream, "                case {}.{}:", enName, csharpName(ec));
             }
-            fmt::println(stream.stream, "                    break;");
-            fmt::println(stream.stream, "                default:");
-            fmt::println(stream.stream, "                    throw new {}Exception(result);", enName);
-            fmt::println(stream.stream, "            }}");
+            idl::println(stream.stream, "                    break;");
+            idl::println(stream.stream, "                default:");
+            idl::println(stream.stream, "                    throw new {}Exception(result);", enName);
+            idl::println(stream.stream, "            }}");
         }
-        fmt::println(stream.stream, "        }}");
-        fmt::println(stream.stream, "");
+        idl::println(stream.stream, "        }}");
+        idl::println(stream.stream, "");
     }
     ctx.filter<ASTStruct>([&stream](ASTStruct* node) {
         if (!node->findAttr<ASTAttrHandle>()) {
-            fmt::println(stream.stream, "        public struct {}", csharpName(node));
-            fmt::println(stream.stream, "        {{");
+            idl::println(stream.stream, "        public struct {}", csharpName(node));
+            idl::println(stream.stream, "        {{");
             for (auto field : node->fields) {
-                fmt::println(stream.stream, "            public {} {};", cfieldType(field), csharpName(field, true));
+                idl::println(stream.stream, "            public {} {};", cfieldType(field), csharpName(field, true));
             }
-            fmt::println(stream.stream, "        }}");
-            fmt::println(stream.stream, "");
+            idl::println(stream.stream, "        }}");
+            idl::println(stream.stream, "");
         }
     });
     std::filesystem::path dll;
@@ -1418,12 +1398,12 @@ static void createNative(const Package& package,
         dllName = csharpName(ctx.api());
     }
     auto addMethod =
-        [&package, &stream, &dllName](ASTDecl* decl, const std::vector<ASTArg*>& args, bool isDelegate = false) {
+        [&package, &stream, &dllName](ASTDecl* decl, const ASTVector<ASTArg*>& args, bool isDelegate = false) {
         if (isDelegate) {
-            fmt::println(stream.stream,
+            idl::println(stream.stream,
                          "        [UnmanagedFunctionPointer(CallingConvention.Cdecl, CharSet = CharSet.Ansi)]");
         } else {
-            fmt::println(stream.stream,
+            idl::println(stream.stream,
                          "        [DllImport(\"{}\", EntryPoint = \"{}\", CallingConvention = "
                          "CallingConvention.Cdecl, CharSet = CharSet.Ansi)]",
                          dllName,
@@ -1431,9 +1411,9 @@ static void createNative(const Package& package,
         }
         auto m = marshaller(decl, package.rootNamespace);
         if (m.length()) {
-            fmt::println(stream.stream, "        [return: {}]", m);
+            idl::println(stream.stream, "        [return: {}]", m);
         }
-        fmt::print(stream.stream,
+        idl::print(stream.stream,
                    "        public {} {} {}(",
                    isDelegate ? "delegate" : "static extern",
                    csharpType(decl, package.rootNamespace),
@@ -1443,13 +1423,13 @@ static void createNative(const Package& package,
             auto isLast = i + 1 == args.size();
             auto ma     = marshaller(arg, package.rootNamespace);
             if (ma.length()) {
-                fmt::print(stream.stream, "{} ", ma);
+                idl::print(stream.stream, "{} ", ma);
             }
-            fmt::print(
+            idl::print(
                 stream.stream, "{} {}{}", csharpType(arg, package.rootNamespace), csharpName(arg), isLast ? "" : ", ");
         }
-        fmt::println(stream.stream, ");");
-        fmt::println(stream.stream, "");
+        idl::println(stream.stream, ");");
+        idl::println(stream.stream, "");
     };
     ctx.filter<ASTCallback>([&addMethod](ASTCallback* node) {
         addMethod(node, node->args, true);
@@ -1460,8 +1440,8 @@ static void createNative(const Package& package,
     ctx.filter<ASTMethod>([&addMethod](ASTMethod* node) {
         addMethod(node, node->args);
     });
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -1482,29 +1462,29 @@ static void createClass(const Package& package,
     auto dtor       = findDtor(iface);
 
     auto stream = createStream(ctx, out, name + ".cs", writer, writerData);
-    fmt::println(stream.stream, "using System;");
-    fmt::println(stream.stream, "using System.Collections.Generic;");
-    fmt::println(stream.stream, "using System.Linq;");
-    fmt::println(stream.stream, "using System.Runtime.InteropServices;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "namespace {}", package.rootNamespace);
-    fmt::println(stream.stream, "{{");
-    fmt::println(stream.stream, "    public unsafe partial class {} : CriticalHandle", name);
-    fmt::println(stream.stream, "    {{");
-    fmt::println(stream.stream, "        internal {}(IntPtr handle) : base(handle)", name);
-    fmt::println(stream.stream, "        {{");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "        public override bool IsInvalid => handle == IntPtr.Zero;");
-    fmt::println(stream.stream, "");
-    fmt::println(stream.stream, "        protected override bool ReleaseHandle()");
-    fmt::println(stream.stream, "        {{");
+    idl::println(stream.stream, "using System;");
+    idl::println(stream.stream, "using System.Collections.Generic;");
+    idl::println(stream.stream, "using System.Linq;");
+    idl::println(stream.stream, "using System.Runtime.InteropServices;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "namespace {}", package.rootNamespace);
+    idl::println(stream.stream, "{{");
+    idl::println(stream.stream, "    public unsafe partial class {} : CriticalHandle", name);
+    idl::println(stream.stream, "    {{");
+    idl::println(stream.stream, "        internal {}(IntPtr handle) : base(handle)", name);
+    idl::println(stream.stream, "        {{");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "        public override bool IsInvalid => handle == IntPtr.Zero;");
+    idl::println(stream.stream, "");
+    idl::println(stream.stream, "        protected override bool ReleaseHandle()");
+    idl::println(stream.stream, "        {{");
     if (dtor) {
-        fmt::println(stream.stream, "            NativeWrapper.{}(this);", nativeFuncName(dtor));
+        idl::println(stream.stream, "            NativeWrapper.{}(this);", nativeFuncName(dtor));
     }
-    fmt::println(stream.stream, "            return true;");
-    fmt::println(stream.stream, "        }}");
-    fmt::println(stream.stream, "    }}");
-    fmt::println(stream.stream, "}}");
+    idl::println(stream.stream, "            return true;");
+    idl::println(stream.stream, "        }}");
+    idl::println(stream.stream, "    }}");
+    idl::println(stream.stream, "}}");
     endStream(stream);
 }
 
@@ -1575,13 +1555,17 @@ void generateCs(idl::Context& ctx,
             package.licenseFile = value;
         }
     }
-    createTargets(package, ctx, out, writer, writerData);
-    createProj(package, ctx, out, writer, writerData);
-    createSln(package, ctx, out, writer, writerData);
-    createNativeContext(package, ctx, out, writer, writerData);
-    createStructures(package, ctx, out, writer, writerData);
-    createMarshallers(package, ctx, out, writer, writerData);
-    createEnums(package, ctx, out, writer, writerData);
-    createNative(package, ctx, out, writer, writerData);
-    createClasses(package, ctx, out, writer, writerData);
+    auto timed = [&](const char* name, auto create) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", name);
+        create(package, ctx, out, writer, writerData);
+    };
+    timed("cs.createTargets", createTargets);
+    timed("cs.createProj", createProj);
+    timed("cs.createSln", createSln);
+    timed("cs.createNativeContext", createNativeContext);
+    timed("cs.createStructures", createStructures);
+    timed("cs.createMarshallers", createMarshallers);
+    timed("cs.createEnums", createEnums);
+    timed("cs.createNative", createNative);
+    timed("cs.createClasses", createClasses);
 }
@@ -1,18 +1,11 @@
 
 #include "case_converter.hpp"
 #include "context.hpp"
+#include "output_sink.hpp"
+#include "trace.hpp"
 
 using namespace idl;
 
-struct Stream {
-    std::ostream& stream;
-    std::unique_ptr<std::ofstream> fstream;
-    std::unique_ptr<std::ostringstream> sstream;
-    std::string filename;
-    idl_write_callback_t writer;
-    idl_data_t writerData;
-};
-
 struct IsTrivial : Visitor {
     IsTrivial(bool isArray = false) noexcept : trivial(!isArray) {
     }
@@ -149,7 +142,7 @@ struct JsName : Visitor {
 
     void visit(ASTEnumConst* node) override {
         assert(!isArray);
-        std::vector<int>* nums = nullptr;
+        ASTVector<int>* nums = nullptr;
         if (auto attr = node->findAttr<ASTAttrTokenizer>()) {
             nums = &attr->nums;
         }
@@ -204,7 +197,7 @@ struct JsName : Visitor {
     }
 
     static std::string camelCase(ASTDecl* decl) {
-        std::vector<int>* nums = nullptr;
+        ASTVector<int>* nums = nullptr;
         if (auto attr = decl->findAttr<ASTAttrTokenizer>()) {
             nums = &attr->nums;
         }
@@ -212,7 +205,7 @@ struct JsName : Visitor {
     }
 
     static std::string pascalCase(ASTDecl* decl) {
-        std::vector<int>* nums = nullptr;
+        ASTVector<int>* nums = nullptr;
         if (auto attr = decl->findAttr<ASTAttrTokenizer>()) {
             nums = &attr->nums;
         }
@@ -416,7 +409,7 @@ static std::string getNameTS(ASTDecl* decl, bool isDeclArr = false) {
         return "void";
     } else if (decl->is<ASTIntegerType>() || decl->is<ASTFloatType>()) {
         if (isDeclArr) {
-            auto type = decl->name + "Array";
+            auto type = std::string(decl->name) + "Array";
             if (decl->is<ASTInt64>() || decl->is<ASTUint64>()) {
                 type = "Big" + type;
             }
@@ -446,45 +439,32 @@ static std::string getNameTS(ASTDecl* decl, bool isDeclArr = false) {
         }
         return type;
     }
-    std::vector<int>* nums = nullptr;
+    ASTVector<int>* nums = nullptr;
     if (auto attr = decl->findAttr<ASTAttrTokenizer>()) {
         nums = &attr->nums;
     }
     return convert(decl->name, Case::PascalCase, nums) + (isDeclArr ? "[]" : "");
 }
 
-static Stream createStream(idl::Context& ctx,
-                           const std::filesystem::path& out,
-                           idl_write_callback_t writer,
-                           idl_data_t writerData) {
-    std::filesystem::create_directories(out);
+static OutputSink createStream(idl::Context& ctx,
+                               const std::filesystem::path& out,
+                               idl_write_callback_t writer,
+                               idl_data_t writerData) {
     auto filename = (convert(ctx.api()->name, Case::LispCase) + ".js.cpp");
-    auto mName    = out / filename;
-    if (writer) {
-        auto stream = std::make_unique<std::ostringstream>();
-        auto ptr    = stream.get();
-        return { *ptr, nullptr, std::move(stream), filename, writer, writerData };
-    } else {
-        auto stream = std::make_unique<std::ofstream>(std::ofstream(mName));
-        if (stream->fail()) {
-            idl::err<IDL_STATUS_E2067>(ctx.api()->location, mName.string());
-        }
-        auto ptr = stream.get();
-        return { *ptr, std::move(stream) };
-    }
+    return OutputSink(ctx, out, filename, writer, writerData);
 }
 
-static void generateComment(idl::Context& ctx, std::ostream& stream) {
+static void generateComment(idl::Context& ctx, OutputSink& stream) {
     char datatime[100];
     auto now = std::time(nullptr);
     std::tm buf;
 #ifdef IDL_PLATFORM_WINDOWS
     gmtime_s(&buf, &now);
 #else
-    buf = *std::gmtime(&now);
+    gmtime_r(&now, &buf);
 #endif
     strftime(datatime, 100, "%Y-%m-%dT%H:%M:%SZ", &buf);
-    fmt::println(stream,
+    idl::println(stream,
                  R"(/**
  * Auto-generated on {now}
  *
@@ -515,56 +495,56 @@ static void generateComment(idl::Context& ctx, std::ostream& stream) {
                  fmt::arg("now", datatime));
 }
 
-static void generateIncludes(idl::Context& ctx, std::ostream& stream) {
+static void generateIncludes(idl::Context& ctx, OutputSink& stream) {
     const auto libHeader = convert(ctx.api()->name, Case::LispCase) + ".h";
-    fmt::println(stream, "#include <emscripten/bind.h>");
-    fmt::println(stream, "#include <emscripten/val.h>");
-    fmt::println(stream, "");
-    fmt::println(stream, "#include \"{}\"", libHeader);
-    fmt::println(stream, "");
-    fmt::println(stream, "#include <type_traits>");
-    fmt::println(stream, "#include <vector>");
-    fmt::println(stream, "#include <list>");
-    fmt::println(stream, "#include <span>");
-    fmt::println(stream, "");
-    fmt::println(stream, "using namespace emscripten;");
-    fmt::println(stream, "");
+    idl::println(stream, "#include <emscripten/bind.h>");
+    idl::println(stream, "#include <emscripten/val.h>");
+    idl::println(stream, "");
+    idl::println(stream, "#include \"{}\"", libHeader);
+    idl::println(stream, "");
+    idl::println(stream, "#include <type_traits>");
+    idl::println(stream, "#include <vector>");
+    idl::println(stream, "#include <list>");
+    idl::println(stream, "#include <span>");
+    idl::println(stream, "");
+    idl::println(stream, "using namespace emscripten;");
+    idl::println(stream, "");
 }
 
-static void generateTypes(idl::Context& ctx, std::ostream& stream) {
-    fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE(String);");
+static void generateTypes(idl::Context& ctx, OutputSink& stream) {
+    idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE(String);");
     ctx.filter<ASTCallback>([&stream](ASTCallback* callback) {
         JsName jsname;
         callback->accept(jsname);
-        fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
+        idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
     });
     ctx.filter<ASTTrivialType>([&stream](ASTTrivialType* trivialType) {
         if (!trivialType->is<ASTVoid>() && !trivialType->is<ASTChar>() && !trivialType->is<ASTData>() &&
             !trivialType->is<ASTConstData>()) {
             JsName jsname(true);
             trivialType->accept(jsname);
-            fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
+            idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
         }
     });
     ctx.filter<ASTStruct>([&stream](ASTStruct* node) {
         JsName jsname(true);
         node->accept(jsname);
-        fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
+        idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
     });
     ctx.filter<ASTInterface>([&stream](ASTInterface* node) {
         JsName jsname(true);
         node->accept(jsname);
-        fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
+        idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
     });
     ctx.filter<ASTCallback>([&stream](ASTCallback* callback) {
         JsName jsname(true);
         callback->accept(jsname);
-        fmt::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
+        idl::println(stream, "EMSCRIPTEN_DECLARE_VAL_TYPE({});", jsname.str);
     });
-    fmt::println(stream, "");
+    idl::println(stream, "");
 }
 
-static void generateExceptions(idl::Context& ctx, std::ostream& stream) {
+static void generateExceptions(idl::Context& ctx, OutputSink& stream) {
     bool hasErrorCodes = false;
     ctx.filter<ASTEnum>([&hasErrorCodes](ASTEnum* en) {
         if (en->findAttr<ASTAttrErrorCode>()) {
@@ -587,11 +567,11 @@ static void generateExceptions(idl::Context& ctx, std::ostream& stream) {
 
     CName cname;
     type->accept(cname);
-    fmt::println(stream, "struct {}Exception : std::runtime_error {{", prefix);
-    fmt::println(stream, "    {}Exception({} message) : std::runtime_error(message) {{", prefix, cname.str);
-    fmt::println(stream, "    }}");
-    fmt::println(stream, "}};");
-    fmt::println(stream, "");
+    idl::println(stream, "struct {}Exception : std::runtime_error {{", prefix);
+    idl::println(stream, "    {}Exception({} message) : std::runtime_error(message) {{", prefix, cname.str);
+    idl::println(stream, "    }}");
+    idl::println(stream, "}};");
+    idl::println(stream, "");
 
     ctx.filter<ASTEnum>([&ctx, &stream, &prefix](ASTEnum* en) {
         if (en->findAttr<ASTAttrErrorCode>()) {
@@ -622,58 +602,58 @@ static void generateExceptions(idl::Context& ctx, std::ostream& stream) {
             }
 
             en->accept(cname);
-            fmt::println(stream, "void checkResult({} result) {{", cname.str);
+            idl::println(stream, "void checkResult({} result) {{", cname.str);
             if (noErrors == 1 && errcodeToString) {
                 errcodeToString->accept(cname);
-                fmt::println(stream, "    if (result != {}) {{", noerrorcodeFirst);
-                fmt::println(stream, "        throw {}Exception({}(result));", prefix, cname.str);
-                fmt::println(stream, "    }}");
+                idl::println(stream, "    if (result != {}) {{", noerrorcodeFirst);
+                idl::println(stream, "        throw {}Exception({}(result));", prefix, cname.str);
+                idl::println(stream, "    }}");
             } else {
                 if (noErrors != 0) {
-                    fmt::println(stream, "    switch (result) {{");
+                    idl::println(stream, "    switch (result) {{");
                     for (auto ec : en->consts) {
                         if (ec->findAttr<ASTAttrNoError>()) {
                             ec->accept(cname);
-                            fmt::println(stream, "        case {}:", cname.str);
+                            idl::println(stream, "        case {}:", cname.str);
                         }
                     }
-                    fmt::println(stream, "            return;");
-                    fmt::println(stream, "        default:");
-                    fmt::println(stream, "            break;");
-                    fmt::println(stream, "    }}");
+                    idl::println(stream, "            return;");
+                    idl::println(stream, "        default:");
+                    idl::println(stream, "            break;");
+                    idl::println(stream, "    }}");
                 }
                 if (errcodeToString) {
                     errcodeToString->accept(cname);
-                    fmt::println(stream, "    throw {}Exception({}(result));", prefix, cname.str);
+                    idl::println(stream, "    throw {}Exception({}(result));", prefix, cname.str);
                 } else {
-                    fmt::println(stream, "    switch (result) {{");
+                    idl::println(stream, "    switch (result) {{");
                     for (auto ec : en->consts) {
                         if (!ec->findAttr<ASTAttrNoError>()) {
                             ec->accept(cname);
-                            fmt::println(stream, "        case {}:", cname.str);
-                            fmt::println(stream, "            throw {}Exception(\"{}\");", prefix, cname.str);
+                            idl::println(stream, "        case {}:", cname.str);
+                            idl::println(stream, "            throw {}Exception(\"{}\");", prefix, cname.str);
                         }
                     }
-                    fmt::println(stream, "        default:");
-                    fmt::println(stream, "            assert(!\"unreachable code\");");
-                    fmt::println(stream, "            break;");
-                    fmt::println(stream, "    }}");
+                    idl::println(stream, "        default:");
+                    idl::println(stream, "            assert(!\"unreachable code\");");
+                    idl::println(stream, "            break;");
+                    idl::println(stream, "    }}");
                 }
             }
-            fmt::println(stream, "}}");
-            fmt::println(stream, "");
+            idl::println(stream, "}}");
+            idl::println(stream, "");
         }
     });
 }
 
-static void generateNonTrivialTypes(idl::Context& ctx, std::ostream& stream) {
+static void generateNonTrivialTypes(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTStruct>([&stream](ASTStruct* node) {
         IsTrivial trivial;
         node->accept(trivial);
         if (!trivial.trivial) {
             JsName jsname;
             node->accept(jsname);
-            fmt::println(stream, "struct {} {{", jsname.str);
+            idl::println(stream, "struct {} {{", jsname.str);
             std::set<ASTDecl*> skip;
             for (auto field : node->fields) {
                 if (auto attr = field->findAttr<ASTAttrArray>()) {
@@ -696,25 +676,25 @@ static void generateNonTrivialTypes(idl::Context& ctx, std::ostream& stream) {
                 field->accept(jsname);
                 Value value(isArr);
                 field->accept(value);
-                fmt::println(stream, "    {} {}{{ {} }};", typeStr, jsname.str, value.value);
+                idl::println(stream, "    {} {}{{ {} }};", typeStr, jsname.str, value.value);
             }
-            fmt::println(stream, "}};", jsname.str);
-            fmt::println(stream, "");
+            idl::println(stream, "}};", jsname.str);
+            idl::println(stream, "");
         }
     });
 }
 
-static void generateClassDeclarations(idl::Context& ctx, std::ostream& stream) {
+static void generateClassDeclarations(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTInterface>([&stream](ASTInterface* node) {
         JsName jsname;
         node->accept(jsname);
-        fmt::println(stream, "class {};", jsname.str);
+        idl::println(stream, "class {};", jsname.str);
     });
-    fmt::println(stream, "");
+    idl::println(stream, "");
 }
 
-static void generateArrItems(idl::Context& ctx, std::ostream& stream) {
-    fmt::println(stream, "template <typename> struct ArrItem;");
+static void generateArrItems(idl::Context& ctx, OutputSink& stream) {
+    idl::println(stream, "template <typename> struct ArrItem;");
     auto addArrItem = [&stream](ASTDecl* decl) {
         if (!decl->is<ASTVoid>() && !decl->is<ASTChar>() && !decl->is<ASTData>() && !decl->is<ASTConstData>()) {
             JsName jsname(true);
@@ -729,7 +709,7 @@ static void generateArrItems(idl::Context& ctx, std::ostream& stream) {
                     typed = "Big" + typed;
                 }
             }
-            fmt::println(
+            idl::println(
                 stream,
                 "template <> struct ArrItem<{}> {{ using type = {}; static constexpr char typed[] = \"{}\"; }};",
                 arrname,
@@ -741,10 +721,10 @@ static void generateArrItems(idl::Context& ctx, std::ostream& stream) {
     ctx.filter<ASTStruct>(addArrItem);
     ctx.filter<ASTInterface>(addArrItem);
     ctx.filter<ASTCallback>(addArrItem);
-    fmt::println(stream, "");
+    idl::println(stream, "");
 }
 
-static void generateJsConverters(idl::Context& ctx, std::ostream& stream) {
+static void generateJsConverters(idl::Context& ctx, OutputSink& stream) {
     CName cname;
     ASTDeclRef ref;
     ref.parent = ctx.api();
@@ -761,7 +741,7 @@ static void generateJsConverters(idl::Context& ctx, std::ostream& stream) {
     ctx.resolveType(&ref)->accept(cname);
     auto strType = cname.str;
 
-    fmt::println(stream,
+    idl::println(stream,
                  R"(template <typename, typename>
 struct JsConverter;
 
@@ -870,10 +850,10 @@ struct JsConverter<String, {str}> {{
             node->accept(jsname);
             CName cname;
             node->accept(cname);
-            fmt::println(stream, "template <>");
-            fmt::println(stream, "struct JsConverter<{}, {}> {{", jsname.str, cname.str);
-            fmt::println(stream, "    static {} convert(const {}& obj) {{", jsname.str, cname.str);
-            fmt::println(stream, "        return {} {{", jsname.str);
+            idl::println(stream, "template <>");
+            idl::println(stream, "struct JsConverter<{}, {}> {{", jsname.str, cname.str);
+            idl::println(stream, "    static {} convert(const {}& obj) {{", jsname.str, cname.str);
+            idl::println(stream, "        return {} {{", jsname.str);
             std::set<ASTDecl*> skip;
             for (auto field : node->fields) {
                 if (auto attr = field->findAttr<ASTAttrArray>()) {
@@ -912,7 +892,7 @@ struct JsConverter<String, {str}> {{
                 }
                 type->accept(jsname);
                 field->accept(cname);
-                fmt::println(stream,
+                idl::println(stream,
                              "            jsconvert<{}>({}{}obj.{}{}),",
                              jsname.str,
                              isR ? "*" : "",
@@ -920,15 +900,15 @@ struct JsConverter<String, {str}> {{
                              cname.str,
                              spanEnd);
             }
-            fmt::println(stream, "        }};");
-            fmt::println(stream, "    }}");
-            fmt::println(stream, "}};");
-            fmt::println(stream, "");
+            idl::println(stream, "        }};");
+            idl::println(stream, "    }}");
+            idl::println(stream, "}};");
+            idl::println(stream, "");
         }
     });
 }
 
-static void generateCConverters(idl::Context& ctx, std::ostream& stream) {
+static void generateCConverters(idl::Context& ctx, OutputSink& stream) {
     CName cname;
     ASTDeclRef ref;
     ref.parent = ctx.api();
@@ -953,7 +933,7 @@ static void generateCConverters(idl::Context& ctx, std::ostream& stream) {
     ctx.resolveType(&ref)->accept(cname);
     auto cdataType = cname.str;
 
-    fmt::println(stream,
+    idl::println(stream,
                  R"(struct CContext {{
     template <typename T>
     T* allocate() {{
@@ -1158,10 +1138,10 @@ struct CConverter<{cdata}, std::string> {{
             node->accept(jsname);
             CName cname;
             node->accept(cname);
-            fmt::println(stream, "template <>");
-            fmt::println(stream, "struct CConverter<{}, {}> {{", cname.str, jsname.str);
-            fmt::println(stream, "    static {}* convert(CContext& ctx, {}& obj) {{", cname.str, jsname.str);
-            fmt::println(stream, "        auto result = ctx.allocate<{}>();", cname.str);
+            idl::println(stream, "template <>");
+            idl::println(stream, "struct CConverter<{}, {}> {{", cname.str, jsname.str);
+            idl::println(stream, "    static {}* convert(CContext& ctx, {}& obj) {{", cname.str, jsname.str);
+            idl::println(stream, "        auto result = ctx.allocate<{}>();", cname.str);
             for (auto field : node->fields) {
                 auto type  = getType(field);
                 auto isArr = isArray(field);
@@ -1179,20 +1159,20 @@ struct CConverter<{cdata}, std::string> {{
                         ref->accept(cname);
                         const auto sizeName = cname.str;
                         getType(ref)->accept(cname);
-                        fmt::println(stream,
+                        idl::println(stream,
                                      "        result->{} = *cconvert<arr_size<{}>>(ctx, obj.{});",
                                      sizeName,
                                      cname.str,
                                      jsname.str);
                     } else {
-                        fmt::println(stream,
+                        idl::println(stream,
                                      "        auto {}Size = *cconvert<arr_size<size_t>>(ctx, obj.{});",
                                      jsname.str,
                                      jsname.str);
-                        fmt::println(stream, "        auto {}MaxSize = std::size(result->{});", jsname.str, fieldCName);
-                        fmt::println(
+                        idl::println(stream, "        auto {}MaxSize = std::size(result->{});", jsname.str, fieldCName);
+                        idl::println(
                             stream, "        auto {} = cconvert<{}>(ctx, obj.{});", jsname.str, typeCName, jsname.str);
-                        fmt::println(stream,
+                        idl::println(stream,
                                      "        memcpy(result->{}, {}, std::min({}Size, {}MaxSize) * sizeof({}));",
                                      fieldCName,
                                      jsname.str,
@@ -1203,7 +1183,7 @@ struct CConverter<{cdata}, std::string> {{
                     }
                 }
                 if (!skip.contains(field)) {
-                    fmt::println(stream,
+                    idl::println(stream,
                                  "        result->{} = {}cconvert<{}>(ctx, obj.{});",
                                  fieldCName,
                                  isR ? "" : "*",
@@ -1211,18 +1191,18 @@ struct CConverter<{cdata}, std::string> {{
                                  jsname.str);
                 }
             }
-            fmt::println(stream, "        return result;");
-            fmt::println(stream, "    }}");
-            fmt::println(stream, "}};");
-            fmt::println(stream, "");
+            idl::println(stream, "        return result;");
+            idl::println(stream, "    }}");
+            idl::println(stream, "}};");
+            idl::println(stream, "");
         }
     });
 }
 
 static void generateFunctionReturnType(idl::Context& ctx,
-                                       std::ostream& stream,
+                                       OutputSink& stream,
                                        ASTDecl* func,
-                                       const std::vector<ASTArg*>& args) {
+                                       const ASTVector<ASTArg*>& args) {
     ASTDecl* returnType{};
     bool returnTypeIsArray{};
     bool returnTypeIsOptional{};
@@ -1249,13 +1229,13 @@ static void generateFunctionReturnType(idl::Context& ctx,
             typeName = "std::optional<" + typeName + '>';
         }
     }
-    fmt::print(stream, "{}", typeName);
+    idl::print(stream, "{}", typeName);
 }
 
 static void generateFunctionArgs(idl::Context& ctx,
-                                 std::ostream& stream,
+                                 OutputSink& stream,
                                  ASTDecl* func,
-                                 const std::vector<ASTArg*>& args,
+                                 const ASTVector<ASTArg*>& args,
                                  const std::map<ASTArg*, ASTArg*>& sizeArgs,
                                  bool skipArgNames = false) {
     bool first = true;
@@ -1277,7 +1257,7 @@ static void generateFunctionArgs(idl::Context& ctx,
         auto jsTypeName = jsname.str;
 
         if (!first) {
-            fmt::print(stream, ", ");
+            idl::print(stream, ", ");
         }
         first = false;
 
@@ -1292,27 +1272,27 @@ static void generateFunctionArgs(idl::Context& ctx,
             jsTypeName = "std::optional<" + jsTypeName + '>';
         }
 
-        fmt::print(stream, "{}{}{}", isConst ? "const " : "", jsTypeName, isR ? "&" : "");
+        idl::print(stream, "{}{}{}", isConst ? "const " : "", jsTypeName, isR ? "&" : "");
         if (!skipArgNames) {
             jsname.isArray = false;
             arg->accept(jsname);
             const auto jsArgName = jsname.str;
-            fmt::print(stream, " {}", jsArgName);
+            idl::print(stream, " {}", jsArgName);
         }
     }
 }
 
 static void generateFunctionCall(idl::Context& ctx,
-                                 std::ostream& stream,
+                                 OutputSink& stream,
                                  ASTDecl* func,
-                                 const std::vector<ASTArg*>& args,
+                                 const ASTVector<ASTArg*>& args,
                                  bool fetchOnly,
                                  const std::map<ASTArg*, Param>& params) {
     bool first   = true;
     int userData = 0;
     for (auto arg : args) {
         if (!first) {
-            fmt::print(stream, ", ");
+            idl::print(stream, ", ");
         }
         first = false;
         if (auto it = params.find(arg); it != params.end()) {
@@ -1320,12 +1300,12 @@ static void generateFunctionCall(idl::Context& ctx,
             if (param.outParam) {
                 if (param.isVector) {
                     if (fetchOnly) {
-                        fmt::print(stream, "nullptr");
+                        idl::print(stream, "nullptr");
                     } else {
-                        fmt::print(stream, "{}.data()", param.paramName);
+                        idl::print(stream, "{}.data()", param.paramName);
                     }
                 } else {
-                    fmt::print(stream, "&{}", param.paramName);
+                    idl::print(stream, "&{}", param.paramName);
                 }
             } else {
                 bool isStr      = !param.isVector && param.type->is<ASTStr>();
@@ -1336,10 +1316,10 @@ static void generateFunctionCall(idl::Context& ctx,
                 if (param.isUserdata) {
                     name = "data" + std::to_string(userData++);
                 }
-                fmt::print(stream, "{}{}", isR ? "" : "*", name);
+                idl::print(stream, "{}{}", isR ? "" : "*", name);
             }
         } else if (arg->findAttr<ASTAttrThis>()) {
-            fmt::print(stream, "_handle");
+            idl::print(stream, "_handle");
         } else {
             assert(!"unreachable code");
         }
@@ -1347,14 +1327,14 @@ static void generateFunctionCall(idl::Context& ctx,
 }
 
 static void generateFunctionReturn(idl::Context& ctx,
-                                   std::ostream& stream,
+                                   OutputSink& stream,
                                    ASTDecl* func,
                                    const std::string& name,
                                    ASTDecl* decl,
                                    ASTDecl* type,
                                    bool isArr) {
     if (func->findAttr<ASTAttrCtor>()) {
-        fmt::println(stream, "        _handle = {};", name);
+        idl::println(stream, "        _handle = {};", name);
     } else {
         auto isR = !isArr && isRef(func) && !isOptional(decl);
         JsName jsname;
@@ -1371,26 +1351,26 @@ static void generateFunctionReturn(idl::Context& ctx,
             spanBegin = "std::span{";
             spanEnd   = ".data(), " + name + ".size()}";
         }
-        fmt::println(
+        idl::println(
             stream, "        return jsconvert<{}>({}{}{}{});", jsname.str, isR ? "*" : "", spanBegin, name, spanEnd);
     }
 }
 
-static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* func, const std::vector<ASTArg*>& args) {
+static void generateFunction(idl::Context& ctx, OutputSink& stream, ASTDecl* func, const ASTVector<ASTArg*>& args) {
     const auto isCtor = func->findAttr<ASTAttrCtor>() != nullptr;
     if (isCtor) {
         JsName jsname;
         func->parent->accept(jsname);
-        fmt::print(stream, "    {}", jsname.str);
+        idl::print(stream, "    {}", jsname.str);
     } else {
-        fmt::print(stream, "    ");
+        idl::print(stream, "    ");
         if (func->findAttr<ASTAttrStatic>() && func->is<ASTMethod>()) {
-            fmt::print(stream, "static ");
+            idl::print(stream, "static ");
         }
         JsName jsname;
         func->accept(jsname);
         generateFunctionReturnType(ctx, stream, func, args);
-        fmt::print(stream, " {}", jsname.str);
+        idl::print(stream, " {}", jsname.str);
     }
     std::map<ASTArg*, ASTArg*> sizeArgs;
     for (auto arg : args) {
@@ -1400,10 +1380,10 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
             sizeArgs[attr->decl->decl->as<ASTArg>()] = arg;
         }
     }
-    fmt::print(stream, "(");
+    idl::print(stream, "(");
     generateFunctionArgs(ctx, stream, func, args, sizeArgs);
     auto isConst = func->findAttr<ASTAttrConst>() && !func->findAttr<ASTAttrStatic>() && !func->is<ASTFunc>();
-    fmt::println(stream, ") {}{{", isConst ? "const " : "");
+    idl::println(stream, ") {}{{", isConst ? "const " : "");
 
     std::map<ASTArg*, Param> params;
     bool needFetchSizes{};
@@ -1476,14 +1456,14 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
     }
 
     if (needContext) {
-        fmt::println(stream, "        CContext ctx;");
+        idl::println(stream, "        CContext ctx;");
     }
 
     int userDataCount = 0;
     for (auto& [_, param] : params) {
         if (!param.outParam) {
             if (param.isSize) {
-                fmt::println(stream,
+                idl::println(stream,
                              "        auto {} = cconvert<arr_size<{}>>(ctx, {});",
                              param.paramName,
                              param.typeName,
@@ -1500,7 +1480,7 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                     storeCallback = "storeFuncCallback";
                 }
 
-                fmt::println(stream,
+                idl::println(stream,
                              "        auto {} = {}(\"{}\", {} ? &{}.value() : nullptr);",
                              paramData,
                              storeCallback,
@@ -1508,16 +1488,16 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                              param.jsArgName,
                              param.jsArgName);
 
-                fmt::print(stream, "        auto {} = {} ? [](", param.paramName, param.jsArgName);
+                idl::print(stream, "        auto {} = {} ? [](", param.paramName, param.jsArgName);
                 bool first = true;
                 ASTArg* userdata{};
                 for (auto arg : param.type->as<ASTCallback>()->args) {
                     if (!first) {
-                        fmt::print(stream, ", ");
+                        idl::print(stream, ", ");
                     }
                     first = false;
                     if (arg->findAttr<ASTAttrConst>() && arg->findAttr<ASTAttrRef>()) {
-                        fmt::print(stream, "const ");
+                        idl::print(stream, "const ");
                     }
                     bool isR = false;
                     if (arg->findAttr<ASTAttrRef>() || arg->findAttr<ASTAttrOut>()) {
@@ -1525,30 +1505,30 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                     }
                     CName cname;
                     getType(arg)->accept(cname);
-                    fmt::print(stream, "{}{} ", cname.str, isR ? "*" : "");
+                    idl::print(stream, "{}{} ", cname.str, isR ? "*" : "");
                     arg->accept(jsname);
-                    fmt::print(stream, "{}", jsname.str);
+                    idl::print(stream, "{}", jsname.str);
                     if (arg->findAttr<ASTAttrUserData>()) {
                         userdata = arg;
                     }
                 }
                 userdata->accept(jsname);
-                fmt::println(stream, ") {{");
-                fmt::println(stream,
+                idl::println(stream, ") {{");
+                idl::println(stream,
                              "            auto& [callback, ctx] = *((std::pair<val, std::shared_ptr<CContext>>*) {});",
                              jsname.str);
-                fmt::print(stream, "            ");
+                idl::print(stream, "            ");
                 if (!getType(param.type)->is<ASTVoid>()) {
-                    fmt::print(stream, "auto functionReturn = ");
+                    idl::print(stream, "auto functionReturn = ");
                 }
-                fmt::print(stream, "callback(");
+                idl::print(stream, "callback(");
                 first = true;
                 for (auto arg : param.type->as<ASTCallback>()->args) {
                     if (arg->findAttr<ASTAttrUserData>()) {
                         continue;
                     }
                     if (!first) {
-                        fmt::print(stream, ", ");
+                        idl::print(stream, ", ");
                     }
                     first          = false;
                     auto type      = getType(arg);
@@ -1573,10 +1553,10 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                     CName cname;
                     type->accept(jsname);
                     arg->accept(cname);
-                    fmt::print(
+                    idl::print(
                         stream, "jsconvert<{}>({}{}{}{})", jsname.str, isR ? "*" : "", spanBegin, cname.str, spanEnd);
                 }
-                fmt::println(stream, ");");
+                idl::println(stream, ");");
                 if (!getType(param.type)->is<ASTVoid>()) {
                     JsName jsname;
                     getType(param.type)->accept(jsname);
@@ -1585,16 +1565,16 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                     }
                     CName cname;
                     getType(param.type)->accept(cname);
-                    fmt::println(stream, "            ctx = std::make_shared<CContext>();");
-                    fmt::println(stream,
+                    idl::println(stream, "            ctx = std::make_shared<CContext>();");
+                    idl::println(stream,
                                  "            return cconvert<{}>(*ctx, functionReturn.as<{}>());",
                                  cname.str,
                                  jsname.str);
                 }
-                fmt::println(stream, "        }} : nullptr;");
+                idl::println(stream, "        }} : nullptr;");
             } else if (param.isUserdata) {
             } else {
-                fmt::println(stream,
+                idl::println(stream,
                              "        auto {} = cconvert<{}>(ctx, {});",
                              param.paramName,
                              param.typeName,
@@ -1609,53 +1589,53 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
             if (param.inParam && !param.isSize) {
                 value = fmt::format(" = cconvert<{}>(ctx, {})", param.typeName, param.jsArgName);
             }
-            fmt::println(stream, "        {} {}{};", param.typeName, param.paramName, value);
+            idl::println(stream, "        {} {}{};", param.typeName, param.paramName, value);
         }
     }
 
     if (needFetchSizes) {
-        fmt::print(stream, "        ");
+        idl::print(stream, "        ");
         auto checkReturnError = getType(func)->findAttr<ASTAttrErrorCode>() != nullptr;
         if (checkReturnError) {
-            fmt::print(stream, "const auto checkReturnError = ");
+            idl::print(stream, "const auto checkReturnError = ");
         }
 
         CName cname;
         func->accept(cname);
-        fmt::print(stream, "{}(", cname.str);
+        idl::print(stream, "{}(", cname.str);
         generateFunctionCall(ctx, stream, func, args, true, params);
-        fmt::println(stream, ");");
+        idl::println(stream, ");");
         if (checkReturnError) {
-            fmt::println(stream, "        checkResult(checkReturnError);");
+            idl::println(stream, "        checkResult(checkReturnError);");
         }
         for (const auto& [_, param] : params) {
             if (param.outParam && param.isError) {
-                fmt::println(stream, "        checkResult({});", param.paramName);
+                idl::println(stream, "        checkResult({});", param.paramName);
             }
         }
         for (const auto& [_, param] : params) {
             if (param.outParam && param.isVector) {
                 auto& sizeParam = params[param.refArg];
-                fmt::println(stream, "        {}.resize({});", param.paramName, sizeParam.paramName);
+                idl::println(stream, "        {}.resize({});", param.paramName, sizeParam.paramName);
             }
         }
     }
     {
-        fmt::print(stream, "        ");
+        idl::print(stream, "        ");
         if (!getType(func)->is<ASTVoid>()) {
-            fmt::print(stream, "auto functionReturn = ");
+            idl::print(stream, "auto functionReturn = ");
         }
         CName cname;
         func->accept(cname);
-        fmt::print(stream, "{}(", cname.str);
+        idl::print(stream, "{}(", cname.str);
         generateFunctionCall(ctx, stream, func, args, false, params);
-        fmt::println(stream, ");");
+        idl::println(stream, ");");
         if (getType(func)->findAttr<ASTAttrErrorCode>() != nullptr) {
-            fmt::println(stream, "        checkResult(functionReturn);");
+            idl::println(stream, "        checkResult(functionReturn);");
         }
         for (const auto& [_, param] : params) {
             if (param.outParam && param.isError) {
-                fmt::println(stream, "        checkResult({});", param.paramName);
+                idl::println(stream, "        checkResult({});", param.paramName);
             }
         }
         for (const auto& [_, param] : params) {
@@ -1679,7 +1659,7 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
                 if (param.isUserdata) {
                     JsName jsname;
                     getType(func)->accept(jsname);
-                    fmt::println(stream,
+                    idl::println(stream,
                                  "        return {} ? std::make_optional({}((((std::pair<val, "
                                  "std::shared_ptr<CContext>>*) {})->first))) : std::nullopt;",
                                  param.paramName,
@@ -1694,11 +1674,11 @@ static void generateFunction(idl::Context& ctx, std::ostream& stream, ASTDecl* f
         }
     }
 
-    fmt::println(stream, "    }}");
-    fmt::println(stream, "");
+    idl::println(stream, "    }}");
+    idl::println(stream, "");
 }
 
-static void generateCppClasses(idl::Context& ctx, std::ostream& stream) {
+static void generateCppClasses(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTInterface>([&ctx, &stream](ASTInterface* node) {
         bool hasCallbacks{};
         bool hasStaticCallbacks{};
@@ -1724,16 +1704,16 @@ static void generateCppClasses(idl::Context& ctx, std::ostream& stream) {
         CName cname;
         node->accept(cname);
         const auto handleTypeStr = cname.str;
-        fmt::println(stream, "class {} {{", jsTypeStr);
-        fmt::println(stream, "public:");
+        idl::println(stream, "class {} {{", jsTypeStr);
+        idl::println(stream, "public:");
         for (auto method : node->methods) {
             if (method->findAttr<ASTAttrCtor>() != nullptr) {
                 generateFunction(ctx, stream, method, method->args);
             }
         }
-        fmt::println(stream, "    {}({} handle) : _handle(handle) {{", jsTypeStr, handleTypeStr);
-        fmt::println(stream, "    }}");
-        fmt::println(stream, "");
+        idl::println(stream, "    {}({} handle) : _handle(handle) {{", jsTypeStr, handleTypeStr);
+        idl::println(stream, "    }}");
+        idl::println(stream, "");
 
         ASTMethod* reference{};
         for (auto method : node->methods) {
@@ -1743,27 +1723,27 @@ static void generateCppClasses(idl::Context& ctx, std::ostream& stream) {
             }
         }
         if (reference || hasCallbacks) {
-            fmt::print(stream, "    {}(const {}& other) : ", jsTypeStr, jsTypeStr);
+            idl::print(stream, "    {}(const {}& other) : ", jsTypeStr, jsTypeStr);
             if (hasCallbacks) {
-                fmt::print(stream, "_callbacks(other._callbacks), ");
+                idl::print(stream, "_callbacks(other._callbacks), ");
             }
-            fmt::println(stream, "_handle(other._handle) {{");
+            idl::println(stream, "_handle(other._handle) {{");
             if (reference) {
                 reference->accept(cname);
-                fmt::println(stream, "        if (_handle) {{");
-                fmt::println(stream, "            {}(_handle);", cname.str);
-                fmt::println(stream, "        }}");
+                idl::println(stream, "        if (_handle) {{");
+                idl::println(stream, "            {}(_handle);", cname.str);
+                idl::println(stream, "        }}");
             }
-            fmt::println(stream, "    }}");
-            fmt::println(stream, "");
+            idl::println(stream, "    }}");
+            idl::println(stream, "");
         }
         for (auto method : node->methods) {
             if (method->findAttr<ASTAttrDestroy>() != nullptr) {
                 method->accept(cname);
-                fmt::println(stream, "    ~{}() {{", jsTypeStr);
-                fmt::println(stream, "        {}(_handle);", cname.str);
-                fmt::println(stream, "    }}");
-                fmt::println(stream, "");
+                idl::println(stream, "    ~{}() {{", jsTypeStr);
+                idl::println(stream, "        {}(_handle);", cname.str);
+                idl::println(stream, "    }}");
+                idl::println(stream, "");
                 break;
             }
         }
@@ -1774,31 +1754,31 @@ static void generateCppClasses(idl::Context& ctx, std::ostream& stream) {
             }
         }
 
-        fmt::println(stream, "    {} handle() noexcept {{", handleTypeStr);
-        fmt::println(stream, "        return _handle;");
-        fmt::println(stream, "    }}");
-        fmt::println(stream, "");
-        fmt::println(stream, "private:");
+        idl::println(stream, "    {} handle() noexcept {{", handleTypeStr);
+        idl::println(stream, "        return _handle;");
+        idl::println(stream, "    }}");
+        idl::println(stream, "");
+        idl::println(stream, "private:");
         if (hasStaticCallbacks) {
             ASTDeclRef dataRef{};
             dataRef.parent = ctx.api();
             dataRef.name   = "Data";
             CName cname;
             ctx.resolveType(&dataRef)->accept(cname);
-            fmt::println(
+            idl::println(
                 stream, "    static {} storeStaticCallback(const std::string& func, val* callback) {{", cname.str);
-            fmt::println(stream, "        if (callback) {{");
-            fmt::println(
+            idl::println(stream, "        if (callback) {{");
+            idl::println(
                 stream,
                 "            return ({}) &_staticCallbacks.insert_or_assign(func, std::make_pair(val(*callback), "
                 "nullptr)).first->second;",
                 cname.str);
-            fmt::println(stream, "        }}");
-            fmt::println(stream, "        _staticCallbacks.erase(func);");
-            fmt::println(stream, "        return nullptr;");
-            fmt::println(stream, "    }}");
-            fmt::println(stream, "");
-            fmt::println(
+            idl::println(stream, "        }}");
+            idl::println(stream, "        _staticCallbacks.erase(func);");
+            idl::println(stream, "        return nullptr;");
+            idl::println(stream, "    }}");
+            idl::println(stream, "");
+            idl::println(
                 stream,
                 "    static std::map<std::string, std::pair<val, std::shared_ptr<CContext>>> _staticCallbacks;");
         }
@@ -1808,49 +1788,49 @@ static void generateCppClasses(idl::Context& ctx, std::ostream& stream) {
             dataRef.name   = "Data";
             CName cname;
             ctx.resolveType(&dataRef)->accept(cname);
-            fmt::println(stream, "    {} storeCallback(const std::string& func, val* callback) {{", cname.str);
-            fmt::println(stream, "        if (callback) {{");
-            fmt::println(stream,
+            idl::println(stream, "    {} storeCallback(const std::string& func, val* callback) {{", cname.str);
+            idl::println(stream, "        if (callback) {{");
+            idl::println(stream,
                          "            return ({}) &_callbacks.insert_or_assign(func, std::make_pair(val(*callback), "
                          "nullptr)).first->second;",
                          cname.str);
-            fmt::println(stream, "        }}");
-            fmt::println(stream, "        _callbacks.erase(func);");
-            fmt::println(stream, "        return nullptr;");
-            fmt::println(stream, "    }}");
-            fmt::println(stream, "");
-            fmt::println(stream,
+            idl::println(stream, "        }}");
+            idl::println(stream, "        _callbacks.erase(func);");
+            idl::println(stream, "        return nullptr;");
+            idl::println(stream, "    }}");
+            idl::println(stream, "");
+            idl::println(stream,
                          "    std::map<std::string, std::pair<val, std::shared_ptr<CContext>>> _callbacks{{}};");
         }
-        fmt::println(stream, "    {} _handle{{}};", handleTypeStr);
-        fmt::println(stream, "}};");
+        idl::println(stream, "    {} _handle{{}};", handleTypeStr);
+        idl::println(stream, "}};");
         if (hasStaticCallbacks) {
-            fmt::println(stream,
+            idl::println(stream,
                          "std::map<std::string, std::pair<val, std::shared_ptr<CContext>>> {}::_staticCallbacks{{}};",
                          jsTypeStr);
         }
-        fmt::println(stream, "template <>");
-        fmt::println(stream, "struct JsConverter<{}, {}> {{", jsTypeStr, handleTypeStr);
-        fmt::println(stream, "    static {} convert(const {}& obj) {{", jsTypeStr, handleTypeStr);
-        fmt::println(stream, "        return {}(obj);", jsTypeStr);
-        fmt::println(stream, "    }}");
-        fmt::println(stream, "}};");
-        fmt::println(stream, "template <>");
-        fmt::println(stream, "struct CConverter<{}, {}> {{", handleTypeStr, jsTypeStr);
-        fmt::println(stream, "    static {} convert(CContext& ctx, {}& obj) {{", handleTypeStr, jsTypeStr);
-        fmt::println(stream, "        return obj.handle();");
-        fmt::println(stream, "    }}");
-        fmt::println(stream, "}};");
-        fmt::println(stream, "");
+        idl::println(stream, "template <>");
+        idl::println(stream, "struct JsConverter<{}, {}> {{", jsTypeStr, handleTypeStr);
+        idl::println(stream, "    static {} convert(const {}& obj) {{", jsTypeStr, handleTypeStr);
+        idl::println(stream, "        return {}(obj);", jsTypeStr);
+        idl::println(stream, "    }}");
+        idl::println(stream, "}};");
+        idl::println(stream, "template <>");
+        idl::println(stream, "struct CConverter<{}, {}> {{", handleTypeStr, jsTypeStr);
+        idl::println(stream, "    static {} convert(CContext& ctx, {}& obj) {{", handleTypeStr, jsTypeStr);
+        idl::println(stream, "        return obj.handle();");
+        idl::println(stream, "    }}");
+        idl::println(stream, "}};");
+        idl::println(stream, "");
     });
 }
 
-static void generateBeginBindings(idl::Context& ctx, std::ostream& stream) {
+static void generateBeginBindings(idl::Context& ctx, OutputSink& stream) {
     const auto moduleName = convert(ctx.api()->name, Case::CamelCase);
-    fmt::println(stream, "EMSCRIPTEN_BINDINGS({}) {{", moduleName);
+    idl::println(stream, "EMSCRIPTEN_BINDINGS({}) {{", moduleName);
 }
 
-static void generateFuncCallbackStore(idl::Context& ctx, std::ostream& stream) {
+static void generateFuncCallbackStore(idl::Context& ctx, OutputSink& stream) {
     bool hasCallbacks{};
     ctx.filter<ASTFunc>([&hasCallbacks](ASTFunc* node) {
         for (auto arg : node->args) {
@@ -1867,23 +1847,23 @@ static void generateFuncCallbackStore(idl::Context& ctx, std::ostream& stream) {
         dataRef.name   = "Data";
         CName cname;
         ctx.resolveType(&dataRef)->accept(cname);
-        fmt::println(stream, "{} storeFuncCallback(const std::string& func, val* callback) {{", cname.str);
-        fmt::println(stream,
+        idl::println(stream, "{} storeFuncCallback(const std::string& func, val* callback) {{", cname.str);
+        idl::println(stream,
                      "    static std::map<std::string, std::pair<val, std::shared_ptr<CContext>>> callbacks{{}};");
-        fmt::println(stream, "    if (callback) {{");
-        fmt::println(stream,
+        idl::println(stream, "    if (callback) {{");
+        idl::println(stream,
                      "        return ({}) &callbacks.insert_or_assign(func, std::make_pair(val(*callback), "
                      "nullptr)).first->second;",
                      cname.str);
-        fmt::println(stream, "    }}");
-        fmt::println(stream, "    callbacks.erase(func);");
-        fmt::println(stream, "    return nullptr;");
-        fmt::println(stream, "}}");
-        fmt::println(stream, "");
+        idl::println(stream, "    }}");
+        idl::println(stream, "    callbacks.erase(func);");
+        idl::println(stream, "    return nullptr;");
+        idl::println(stream, "}}");
+        idl::println(stream, "");
     }
 }
 
-static void generateCppFunctions(idl::Context& ctx, std::ostream& stream) {
+static void generateCppFunctions(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTFunc>([&ctx, &stream](ASTFunc* node) {
         if (!node->findAttr<ASTAttrErrorCode>()) {
             generateFunction(ctx, stream, node, node->args);
@@ -1891,32 +1871,32 @@ static void generateCppFunctions(idl::Context& ctx, std::ostream& stream) {
     });
 }
 
-static void generateRegisterTypes(idl::Context& ctx, std::ostream& stream) {
+static void generateRegisterTypes(idl::Context& ctx, OutputSink& stream) {
     auto isArr   = false;
     auto addType = [&stream, &isArr](ASTDecl* decl) {
         if (!decl->is<ASTVoid>() && !decl->is<ASTChar>() && !decl->is<ASTData>() && !decl->is<ASTConstData>()) {
             JsName jsname(isArr);
             decl->accept(jsname);
-            fmt::println(stream, "    register_type<{}>(\"{}\");", jsname.str, getNameTS(decl, isArr));
+            idl::println(stream, "    register_type<{}>(\"{}\");", jsname.str, getNameTS(decl, isArr));
         }
     };
-    fmt::println(stream, "    register_type<String>(\"string\");");
+    idl::println(stream, "    register_type<String>(\"string\");");
     ctx.filter<ASTCallback>(addType);
     isArr = true;
     ctx.filter<ASTTrivialType>(addType);
     ctx.filter<ASTStruct>(addType);
     ctx.filter<ASTInterface>(addType);
     ctx.filter<ASTCallback>(addType);
-    fmt::println(stream, "");
+    idl::println(stream, "");
 }
 
-static void generateRegisterOptionals(idl::Context& ctx, std::ostream& stream) {
+static void generateRegisterOptionals(idl::Context& ctx, OutputSink& stream) {
     auto addOptional = [&stream](ASTDecl* decl) {
         if (!decl->is<ASTVoid>() && !decl->is<ASTChar>() && !decl->is<ASTConstData>() &&
             !decl->findAttr<ASTAttrErrorCode>()) {
             JsName jsname;
             decl->accept(jsname);
-            fmt::println(stream, "    register_optional<{}>();", jsname.str);
+            idl::println(stream, "    register_optional<{}>();", jsname.str);
         }
     };
     ctx.filter<ASTTrivialType>(addOptional);
@@ -1924,31 +1904,31 @@ static void generateRegisterOptionals(idl::Context& ctx, std::ostream& stream) {
     ctx.filter<ASTStruct>(addOptional);
     ctx.filter<ASTInterface>(addOptional);
     ctx.filter<ASTCallback>(addOptional);
-    fmt::println(stream, "");
+    idl::println(stream, "");
 }
 
-static void generateEnums(idl::Context& ctx, std::ostream& stream) {
+static void generateEnums(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTEnum>([&stream](ASTEnum* node) {
         if (node->findAttr<ASTAttrErrorCode>() == nullptr) {
             CName cname;
             node->accept(cname);
-            fmt::println(stream, "    enum_<{}>(\"{}\")", cname.str, getNameTS(node));
+            idl::println(stream, "    enum_<{}>(\"{}\")", cname.str, getNameTS(node));
             for (auto ec : node->consts) {
-                std::vector<int>* nums = nullptr;
+                ASTVector<int>* nums = nullptr;
                 if (auto attr = ec->findAttr<ASTAttrTokenizer>()) {
                     nums = &attr->nums;
                 }
                 auto name = convert(ec->name, Case::ScreamingSnakeCase, nums);
                 ec->accept(cname);
-                fmt::println(stream, "        .value(\"{}\", {})", name, cname.str);
+                idl::println(stream, "        .value(\"{}\", {})", name, cname.str);
             }
-            fmt::println(stream, "        ;");
-            fmt::println(stream, "");
+            idl::println(stream, "        ;");
+            idl::println(stream, "");
         }
     });
 }
 
-static void generateValueObjects(idl::Context& ctx, std::ostream& stream) {
+static void generateValueObjects(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTStruct>([&stream](ASTStruct* node) {
         CName cname;
         JsName jsname;
@@ -1956,7 +1936,7 @@ static void generateValueObjects(idl::Context& ctx, std::ostream& stream) {
         IsTrivial trivial;
         node->accept(trivial);
         const auto typeName = jsname.str;
-        fmt::println(stream, "    value_object<{}>(\"{}\")", typeName, getNameTS(node));
+        idl::println(stream, "    value_object<{}>(\"{}\")", typeName, getNameTS(node));
         std::set<ASTDecl*> skip;
         for (auto field : node->fields) {
             if (auto attr = field->findAttr<ASTAttrArray>()) {
@@ -1981,25 +1961,25 @@ static void generateValueObjects(idl::Context& ctx, std::ostream& stream) {
                 field->accept(jsname);
                 fieldNameCpp = jsname.str;
             }
-            fmt::println(stream, "        .field(\"{}\", &{}::{})", fieldNameJs, typeName, fieldNameCpp);
+            idl::println(stream, "        .field(\"{}\", &{}::{})", fieldNameJs, typeName, fieldNameCpp);
         }
-        fmt::println(stream, "        ;");
-        fmt::println(stream, "");
+        idl::println(stream, "        ;");
+        idl::println(stream, "");
     });
 }
 
-static void generateClasses(idl::Context& ctx, std::ostream& stream) {
+static void generateClasses(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTInterface>([&ctx, &stream](ASTInterface* node) {
         std::set<ASTDecl*> excluded;
         JsName jsname;
         node->accept(jsname);
         const auto typeName = jsname.str;
-        fmt::println(stream, "    class_<{}>(\"{}\")", typeName, typeName);
+        idl::println(stream, "    class_<{}>(\"{}\")", typeName, typeName);
         for (auto method : node->methods) {
             if (method->findAttr<ASTAttrCtor>()) {
                 if (method->args.size() == 0 ||
                     (method->args.size() == 1 && method->args[0]->findAttr<ASTAttrResult>())) {
-                    fmt::println(stream, "        .constructor()");
+                    idl::println(stream, "        .constructor()");
                 } else {
                     std::map<ASTArg*, ASTArg*> sizeArgs;
                     for (auto arg : method->args) {
@@ -2009,9 +1989,9 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
                             sizeArgs[attr->decl->decl->as<ASTArg>()] = arg;
                         }
                     }
-                    std::ostringstream ss;
+                    OutputSink ss;
                     generateFunctionArgs(ctx, ss, method, method->args, sizeArgs, true);
-                    fmt::println(stream, "        .constructor<{}>()", ss.str());
+                    idl::println(stream, "        .constructor<{}>()", ss.str());
                 }
             }
         }
@@ -2029,7 +2009,7 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
                 const auto getterName = jsname.str;
                 setter->decl->decl->accept(jsname);
                 const auto setterName = jsname.str;
-                fmt::println(stream,
+                idl::println(stream,
                              "        .property(\"{}\", &{}::{}, &{}::{})",
                              propName,
                              typeName,
@@ -2041,12 +2021,12 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
             } else if (getter) {
                 getter->decl->decl->accept(jsname);
                 const auto getterName = jsname.str;
-                fmt::println(stream, "        .property(\"{}\", &{}::{})", propName, typeName, getterName);
+                idl::println(stream, "        .property(\"{}\", &{}::{})", propName, typeName, getterName);
                 excluded.insert(getter->decl->decl);
             } else if (setter) {
                 setter->decl->decl->accept(jsname);
                 const auto setterName = jsname.str;
-                fmt::println(stream, "        .property(\"{}\", &{}::{})", propName, typeName, setterName);
+                idl::println(stream, "        .property(\"{}\", &{}::{})", propName, typeName, setterName);
                 excluded.insert(setter->decl->decl);
             }
         }
@@ -2064,7 +2044,7 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
                 const auto getterName = jsname.str;
                 setter->decl->decl->accept(jsname);
                 const auto setterName = jsname.str;
-                fmt::println(stream,
+                idl::println(stream,
                              "        .property(\"{}\", &{}::{}, &{}::{})",
                              evName,
                              typeName,
@@ -2076,12 +2056,12 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
             } else if (getter) {
                 getter->decl->decl->accept(jsname);
                 const auto getterName = jsname.str;
-                fmt::println(stream, "        .property(\"{}\", &{}::{})", evName, typeName, getterName);
+                idl::println(stream, "        .property(\"{}\", &{}::{})", evName, typeName, getterName);
                 excluded.insert(getter->decl->decl);
             } else if (setter) {
                 setter->decl->decl->accept(jsname);
                 const auto setterName = jsname.str;
-                fmt::println(stream, "        .property(\"{}\", &{}::{})", evName, typeName, setterName);
+                idl::println(stream, "        .property(\"{}\", &{}::{})", evName, typeName, setterName);
                 excluded.insert(setter->decl->decl);
             }
         }
@@ -2096,30 +2076,30 @@ static void generateClasses(idl::Context& ctx, std::ostream& stream) {
             method->accept(jsname);
             const auto methodName = jsname.str;
             auto isClassFunc      = method->findAttr<ASTAttrStatic>() != nullptr;
-            fmt::println(stream,
+            idl::println(stream,
                          "        .{}function(\"{}\", &{}::{})",
                          isClassFunc ? "class_" : "",
                          methodName,
                          typeName,
                          methodName);
         }
-        fmt::println(stream, "        ;");
-        fmt::println(stream, "");
+        idl::println(stream, "        ;");
+        idl::println(stream, "");
     });
 }
 
-static void generateFunctions(idl::Context& ctx, std::ostream& stream) {
+static void generateFunctions(idl::Context& ctx, OutputSink& stream) {
     ctx.filter<ASTFunc>([&stream](ASTFunc* node) {
         if (!node->findAttr<ASTAttrErrorCode>()) {
             JsName jsname;
             node->accept(jsname);
-            fmt::println(stream, "    function(\"{}\", &{});", jsname.str, jsname.str);
+            idl::println(stream, "    function(\"{}\", &{});", jsname.str, jsname.str);
         }
     });
 }
 
-static void generateEndBindings(idl::Context& ctx, std::ostream& stream) {
-    fmt::println(stream, "}}");
+static void generateEndBindings(idl::Context& ctx, OutputSink& stream) {
+    idl::println(stream, "}}");
 }
 
 void generateJs(idl::Context& ctx,
@@ -2127,29 +2107,29 @@ void generateJs(idl::Context& ctx,
                 idl_write_callback_t writer,
                 idl_data_t writerData) {
     auto stream = createStream(ctx, out, writer, writerData);
-    generateComment(ctx, stream.stream);
-    generateIncludes(ctx, stream.stream);
-    generateTypes(ctx, stream.stream);
-    generateExceptions(ctx, stream.stream);
-    generateNonTrivialTypes(ctx, stream.stream);
-    generateClassDeclarations(ctx, stream.stream);
-    generateArrItems(ctx, stream.stream);
-    generateJsConverters(ctx, stream.stream);
-    generateCConverters(ctx, stream.stream);
-    generateCppClasses(ctx, stream.stream);
-    generateFuncCallbackStore(ctx, stream.stream);
-    generateCppFunctions(ctx, stream.stream);
-    generateBeginBindings(ctx, stream.stream);
-    generateRegisterTypes(ctx, stream.stream);
-    generateRegisterOptionals(ctx, stream.stream);
-    generateEnums(ctx, stream.stream);
-    generateValueObjects(ctx, stream.stream);
-    generateClasses(ctx, stream.stream);
-    generateFunctions(ctx, stream.stream);
-    generateEndBindings(ctx, stream.stream);
-    if (stream.writer) {
-        const std::string data = stream.sstream->str();
-        idl_source_t source{ stream.filename.c_str(), data.c_str(), (idl_uint32_t) data.length() };
-        stream.writer(&source, stream.writerData);
-    }
+    auto timed = [&ctx, &stream](const char* name, void (*generate)(Context&, OutputSink&)) {
+        PhaseTimer timer(ctx.options(), ctx.result(), "generator", name);
+        generate(ctx, stream);
+    };
+    timed("js.generateComment", generateComment);
+    timed("js.generateIncludes", generateIncludes);
+    timed("js.generateTypes", generateTypes);
+    timed("js.generateExceptions", generateExceptions);
+    timed("js.generateNonTrivialTypes", generateNonTrivialTypes);
+    timed("js.generateClassDeclarations", generateClassDeclarations);
+    timed("js.generateArrItems", generateArrItems);
+    timed("js.generateJsConverters", generateJsConverters);
+    timed("js.generateCConverters", generateCConverters);
+    timed("js.generateCppClasses", generateCppClasses);
+    timed("js.generateFuncCallbackStore", generateFuncCallbackStore);
+    timed("js.generateCppFunctions", generateCppFunctions);
+    timed("js.generateBeginBindings", generateBeginBindings);
+    timed("js.generateRegisterTypes", generateRegisterTypes);
+    timed("js.generateRegisterOptionals", generateRegisterOptionals);
+    timed("js.generateEnums", generateEnums);
+    timed("js.generateValueObjects", generateValueObjects);
+    timed("js.generateClasses", generateClasses);
+    timed("js.generateFunctions", generateFunctions);
+    timed("js.generateEndBindings", generateEndBindings);
+    stream.flush();
 }
@@ -14,18 +14,33 @@
 #include "idlc/idl.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <span>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <typeindex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <fmt/base.h>
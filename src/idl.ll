@@ -2,7 +2,7 @@
 #include <sstream>
 #include "scanner.hpp"
 #define YY_NO_UNISTD_H
-#define YY_DECL int idl::Scanner::yylex(idl::Parser::semantic_type* yylval, idl::Parser::location_type* yylloc)
+#define YY_DECL int idl::Scanner::lex(idl::Parser::semantic_type* yylval, idl::Parser::location_type* yylloc)
 #define YY_USER_ACTION action(*yylloc);
 using namespace std::string_literals;
 typedef idl::Parser::token token;
@@ -192,7 +192,7 @@ DOCMCHAR ([^ \r\n\t\{\}[\]`]|^[`]{3}|\\\{|\\\}|\\\[|\\\])
 <ATTRARGVERSION>","    { return YYText()[0]; }
 <ATTRARGVERSION>" "    ;
 <ATTRARGVERSION>\r?\n  { yylloc->lines(); }
-<ATTRARGVERSION>[0-9]+ { yylval->emplace<int>(std::stoi(YYText())); return token::NUM; }
+<ATTRARGVERSION>[0-9]+ { yylval->emplace<int64_t>(std::stoll(YYText())); return token::NUM; }
 <ATTRARGVERSION>.      { err<IDL_STATUS_E2001>(*yylloc, YYText()); }
 
 "b166074c3cba4005a198513772597880" { context().setDeclaring(); return token::FILEDOC; }
@@ -206,17 +206,8 @@ import[ ]+ { BEGIN(IMPORT); }
         }
     }
     yylloc->lines();
-    import(*yylloc, yytext);
     BEGIN(INITIAL);
-    unput('\n'), unput('\n');
-    for (auto it = importName.rbegin(); it != importName.rend(); ++it) {
-        unput(*it);
-    }
-    unput(' ');
-    unput('0'), unput('8'), unput('8'), unput('7'), unput('9'), unput('5'), unput('2'), unput('7');
-    unput('7'), unput('3'), unput('1'), unput('5'), unput('8'), unput('9'), unput('1'), unput('a');
-    unput('5'), unput('0'), unput('0'), unput('4'), unput('a'), unput('b'), unput('c'), unput('3');
-    unput('c'), unput('4'), unput('7'), unput('0'), unput('6'), unput('6'), unput('1'), unput('b');
+    importFile(*yylloc, yytext, importName);
 }
 <IMPORT>.|\r?\n { err<IDL_STATUS_E2001>(*yylloc, YYText()); }
 
@@ -237,7 +228,18 @@ import[ ]+ { BEGIN(IMPORT); }
 "true"                    { yylval->emplace<bool>(true); return token::BOOL; }
 "false"                   { yylval->emplace<bool>(false); return token::BOOL; }
 [a-zA-Z0-9]+              { err<IDL_STATUS_E2003>(*yylloc, YYText()); }
-<<EOF>>                   { context().setDeclaring(false); if (!popImport()) { return token::YYEOF; } }
+<<EOF>>                   {
+    if (resumeModule()) {
+        return resume;
+    }
+    context().setDeclaring(false);
+    if (!popImport()) {
+        return token::YYEOF;
+    }
+    if (resumeModule()) {
+        return resume;
+    }
+}
 \r?\n                     { yylloc->lines(); context().setDeclaring(false); }
 \t                        { err<IDL_STATUS_E2002>(*yylloc); }
 " "                       ;
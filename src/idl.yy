@@ -199,7 +199,7 @@ def
     }
     | def_with_type ':' attr_ref_arg_list { 
         auto consts = alloc_node(ASTLiteralConsts, @3);
-        consts->decls = $3;
+        consts->decls.assign($3.begin(), $3.end());
         auto attr = alloc_node(ASTAttrValue, @1);
         attr->value = consts;
         for (auto decl : consts->decls) {
@@ -309,7 +309,7 @@ attr_value
     }
     | ATTRVALUE '(' attr_ref_arg_list ')' {
         auto consts = alloc_node(ASTLiteralConsts, @3);
-        consts->decls = $attr_ref_arg_list;
+        consts->decls.assign($attr_ref_arg_list.begin(), $attr_ref_arg_list.end());
         auto node = alloc_node(ASTAttrValue, @1);
         node->value = consts;
         for (auto decl : consts->decls) {
@@ -389,7 +389,7 @@ attr_tokenizer
             }
         }
         auto node = alloc_node(ASTAttrTokenizer, @1);
-        node->nums = tokens;
+        node->nums.assign(tokens.begin(), tokens.end());
         $$ = node;
     }
     ;
@@ -623,34 +623,34 @@ void addDoc(idl::ASTDoc* node, const std::vector<idl::ASTNode*>& doc, char type)
     {
         case 'b':
             if (!node->brief.empty()) err<IDL_STATUS_E2007>(node->location);
-            node->brief = field;
+            node->brief.assign(field.begin(), field.end());
             break;
         case 'd':
             if (!node->detail.empty()) err<IDL_STATUS_E2008>(node->location);
-            node->detail = field;
+            node->detail.assign(field.begin(), field.end());
             break;
         case 'c':
             if (!node->copyright.empty()) err<IDL_STATUS_E2009>(node->location);
-            node->copyright = field;
+            node->copyright.assign(field.begin(), field.end());
             break;
         case 'l':
             if (!node->license.empty()) err<IDL_STATUS_E2010>(node->location);
-            node->license = field;
+            node->license.assign(field.begin(), field.end());
             break;
         case 'a':
-            node->authors.push_back(field);
+            node->authors.emplace_back(field.begin(), field.end());
             break;
         case 's':
-            node->see.push_back(field);
+            node->see.emplace_back(field.begin(), field.end());
             break;
         case 'n':
-            node->note.push_back(field);
+            node->note.emplace_back(field.begin(), field.end());
             break;
         case 'w':
-            node->warn.push_back(field);
+            node->warn.emplace_back(field.begin(), field.end());
             break;
         case 'r':
-            node->ret = field;
+            node->ret.assign(field.begin(), field.end());
             break;
     }
 }
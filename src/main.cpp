@@ -1,15 +1,34 @@
 #include <idlc/idl.h>
 
 #include <argparse/argparse.hpp>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
 #include <regex>
+#include <set>
+#include <thread>
+
+#ifndef IDL_PLATFORM_WINDOWS
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/time.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+#ifdef IDL_PLATFORM_LINUX
+# include <poll.h>
+# include <sys/inotify.h>
+#endif
 
 void addGeneratorArg(argparse::ArgumentParser& program, const std::map<std::string, idl_generator_t>& generators) {
     auto& arg = program.add_argument("-g", "--generator");
     std::ostringstream help;
-    help << "generator programming language (";
+    help << "generator programming languages separated by commas (";
     bool first = true;
     for (auto& [gen, _] : generators) {
-        arg.add_choice(gen);
         if (!first) {
             help << ", ";
         }
@@ -20,22 +39,218 @@ void addGeneratorArg(argparse::ArgumentParser& program, const std::map<std::stri
     arg.help(help.str());
 }
 
-idl_generator_t getGeneratorArg(argparse::ArgumentParser& program,
-                                const std::map<std::string, idl_generator_t>& generators) {
+std::vector<idl_generator_t> getGeneratorArg(argparse::ArgumentParser& program,
+                                             const std::map<std::string, idl_generator_t>& generators) {
     if (!program.is_used("--generator")) {
-        return IDL_GENERATOR_C;
+        return { IDL_GENERATOR_C };
+    }
+    std::vector<idl_generator_t> result;
+    std::istringstream stream(program.get("--generator"));
+    std::string gen;
+    while (std::getline(stream, gen, ',')) {
+        auto it = generators.find(gen);
+        if (it == generators.end()) {
+            throw std::runtime_error("invalid generator '" + gen + "'");
+        }
+        result.push_back(it->second);
     }
-    std::string gen = program.get("--generator");
-    return generators.at(gen);
+    if (result.empty()) {
+        throw std::runtime_error("no generator specified");
+    }
+    return result;
 }
 
-int main(int argc, char* argv[]) {
-    auto warnAsErr = false;
-    auto input     = std::filesystem::path();
-    auto output    = std::filesystem::current_path();
-    auto imports   = std::vector<std::string>();
-    auto additions = std::vector<std::string>();
+struct TraceLog {
+    struct Event {
+        std::string name;
+        std::string category;
+        std::string detail;
+        double start;
+        double duration;
+        idl_uint32_t threadId;
+    };
+
+    std::mutex mutex;
+    std::vector<Event> events;
+};
+
+void collectTrace(const idl_trace_event_t* event, idl_data_t data) {
+    auto log = static_cast<TraceLog*>(data);
+    std::lock_guard lock(log->mutex);
+    log->events.push_back(
+        { event->name, event->category, event->detail, event->start, event->duration, event->thread_id });
+}
+
+void writeJsonString(std::ostream& stream, const std::string& str) {
+    stream << '"';
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if ((unsigned char) c < 0x20) {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+        } else {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+bool writeTrace(const std::string& path, const TraceLog& log) {
+    std::ofstream stream(path);
+    stream << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& event : log.events) {
+        stream << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"cat\":";
+        writeJsonString(stream, event.category);
+        stream << ",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+               << ",\"pid\":1,\"tid\":" << event.threadId;
+        if (!event.detail.empty()) {
+            stream << ",\"args\":{\"detail\":";
+            writeJsonString(stream, event.detail);
+            stream << '}';
+        }
+        stream << '}';
+        first = false;
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    stream.flush();
+    return !stream.fail();
+}
+
+bool report(std::ostream& err, idl_compilation_result_t result, bool timeReport) {
+    if (idl_compilation_result_has_errors(result) || idl_compilation_result_has_warnings(result)) {
+        idl_uint32_t count{};
+        idl_compilation_result_get_messages(result, &count, nullptr);
+        std::vector<idl_message_t> messages;
+        messages.resize(count);
+        idl_compilation_result_get_messages(result, &count, messages.data());
+        for (const auto& message : messages) {
+            err << (message.is_error ? "error" : "warning");
+            err << " [" << (message.status >= IDL_STATUS_E2001 ? 'E' : 'W');
+            err << (int) message.status << "]: " << message.message;
+            if (message.line > 0) {
+                err << " at " << message.filename << ':' << message.line << ':' << message.column << '.' << std::endl;
+            }
+        }
+    }
+    if (timeReport) {
+        idl_uint32_t count{};
+        idl_compilation_result_get_phase_times(result, &count, nullptr);
+        std::vector<idl_phase_time_t> phases;
+        phases.resize(count);
+        idl_compilation_result_get_phase_times(result, &count, phases.data());
+        for (const auto& phase : phases) {
+            err << std::left << std::setw(40) << phase.name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << phase.milliseconds << " ms" << std::endl;
+        }
+        auto stats = idl_compilation_result_get_stats(result);
+        err << "nodes: " << stats->node_count << ", symbols: " << stats->symbol_count
+            << ", arena: " << stats->arena_bytes << " bytes" << std::endl;
+    }
+    return idl_compilation_result_has_errors(result);
+}
+
+std::vector<std::string> getFiles(idl_compilation_result_t result,
+                                  void (*getter)(idl_compilation_result_t, idl_uint32_t*, idl_utf8_t*)) {
+    idl_uint32_t count{};
+    getter(result, &count, nullptr);
+    std::vector<idl_utf8_t> files(count);
+    getter(result, &count, files.data());
+    return { files.begin(), files.end() };
+}
+
+std::vector<std::string> waitForChanges(const std::set<std::string>& files) {
+#ifdef IDL_PLATFORM_LINUX
+    // Directories are watched rather than the files themselves: editors often
+    // save by replacing the file, which would drop a watch on the old inode.
+    if (auto fd = inotify_init1(IN_CLOEXEC); fd >= 0) {
+        std::map<int, std::filesystem::path> dirs;
+        for (const auto& file : files) {
+            const auto dir = std::filesystem::path(file).parent_path();
+            const auto wd  = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+            if (wd >= 0) {
+                dirs[wd] = dir;
+            }
+        }
+        std::set<std::string> changed;
+        alignas(inotify_event) char buffer[4096];
+        auto timeout = -1;
+        while (!dirs.empty()) {
+            pollfd pfd{ fd, POLLIN, 0 };
+            const auto ready = poll(&pfd, 1, timeout);
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            const auto size = ready > 0 ? read(fd, buffer, sizeof(buffer)) : 0;
+            if (size <= 0) {
+                break;
+            }
+            for (auto ptr = buffer; ptr < buffer + size;) {
+                const auto event = reinterpret_cast<const inotify_event*>(ptr);
+                if (event->len > 0 && dirs.contains(event->wd)) {
+                    auto path = (dirs[event->wd] / event->name).lexically_normal().string();
+                    if (files.contains(path)) {
+                        changed.insert(std::move(path));
+                    }
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+            if (!changed.empty()) {
+                // Collect the remaining events of the same save before recompiling.
+                timeout = 100;
+            }
+        }
+        close(fd);
+        if (!changed.empty()) {
+            return { changed.begin(), changed.end() };
+        }
+    }
+#endif
+    auto stamp = [](const std::string& file) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(file, ec);
+        return ec ? std::filesystem::file_time_type::min() : time;
+    };
+    std::map<std::string, std::filesystem::file_time_type> stamps;
+    for (const auto& file : files) {
+        stamps[file] = stamp(file);
+    }
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        std::vector<std::string> changed;
+        for (const auto& [file, time] : stamps) {
+            if (stamp(file) != time) {
+                changed.push_back(file);
+            }
+        }
+        if (!changed.empty()) {
+            return changed;
+        }
+    }
+}
+
+int run(const std::vector<std::string>& args,
+        const std::filesystem::path& cwd,
+        idl_compiler_t compiler,
+        bool warm,
+        std::ostream& out,
+        std::ostream& err) {
+    auto warnAsErr      = false;
+    auto writeIfChanged = false;
+    auto timeReport     = false;
+    auto watch          = false;
+    auto jobs           = 1;
+    auto inputs         = std::vector<std::string>();
+    auto output         = std::filesystem::path();
+    auto imports        = std::vector<std::string>();
+    auto additions      = std::vector<std::string>();
     std::string apiver;
+    std::string depfile;
+    std::string depfileTarget;
+    std::string traceFile;
+    TraceLog traceLog;
 
     std::map<std::string, idl_generator_t> generators = {
         { "c",  IDL_GENERATOR_C           },
@@ -43,22 +258,47 @@ int main(int argc, char* argv[]) {
         { "cs", IDL_GENERATOR_CSHARP      }
     };
 
-    argparse::ArgumentParser program("idlc", IDL_VERSION_STRING);
-    program.add_argument("input").store_into(input).help("input .idl file");
+    argparse::ArgumentParser program("idlc", IDL_VERSION_STRING, argparse::default_arguments::all, false, out);
+    program.add_epilog("idlc --server keeps a warm compiler listening on a local socket (path from IDLC_SOCKET);\n"
+                       "idlc --client <arguments> runs the compilation on that server, or locally if none is running.");
+    program.add_argument("input")
+        .nargs(argparse::nargs_pattern::at_least_one)
+        .store_into(inputs)
+        .help("input .idl files (several files are compiled in parallel)");
     addGeneratorArg(program, generators);
     program.add_argument("-o", "--output").store_into(output).help("output directory");
     program.add_argument("-i", "--imports").append().store_into(imports).help("import directories");
     program.add_argument("-a", "--additions").append().store_into(additions).help("additional inclusions");
     program.add_argument("-w", "--warnings").store_into(warnAsErr).help("warnings as errors");
     program.add_argument("--apiver").store_into(apiver).help("api version");
+    program.add_argument("-j", "--jobs")
+        .store_into(jobs)
+        .help("threads used by each compilation (0 for one per hardware thread)");
+    program.add_argument("--write-if-changed")
+        .store_into(writeIfChanged)
+        .help("do not rewrite output files whose content has not changed");
+    program.add_argument("--depfile").store_into(depfile).help("write a Make/Ninja depfile of the resolved imports");
+    program.add_argument("--depfile-target").store_into(depfileTarget).help("target named in the depfile");
+    program.add_argument("--trace").store_into(traceFile).help("write compiler phases in Chrome trace event format");
+    program.add_argument("--time-report").store_into(timeReport).help("print phase timings and AST statistics");
+    program.add_argument("--watch").store_into(watch).help("rebuild when the input or any of its imports change");
 
+    auto printedInfo = [&program]() {
+        return program.is_used("--help") || program.is_used("--version");
+    };
     try {
-        program.parse_args(argc, argv);
+        program.parse_args(args);
     } catch (const std::exception& exc) {
-        std::cerr << exc.what() << std::endl;
-        std::cerr << program;
+        if (printedInfo()) {
+            return EXIT_SUCCESS;
+        }
+        err << exc.what() << std::endl;
+        err << program;
         return EXIT_FAILURE;
     }
+    if (printedInfo()) {
+        return EXIT_SUCCESS;
+    }
 
     std::optional<idl_api_version_t> version{};
     if (program.is_used("--apiver")) {
@@ -70,16 +310,31 @@ int main(int argc, char* argv[]) {
                                              (idl_uint32_t) std::stoi(matches[2].str()),
                                              (idl_uint32_t) std::stoi(matches[3].str()) };
             } catch (const std::exception& e) {
-                std::cerr << "invalid version number (out of range)" << std::endl;
+                err << "invalid version number (out of range)" << std::endl;
                 return EXIT_FAILURE;
             }
         } else {
-            std::cerr << "invalid version format" << std::endl;
+            err << "invalid version format" << std::endl;
             return EXIT_FAILURE;
         }
     }
-    idl_generator_t gen   = getGeneratorArg(program, generators);
-    std::string inputFile = input.string();
+    std::vector<idl_generator_t> gens;
+    try {
+        gens = getGeneratorArg(program, generators);
+    } catch (const std::exception& exc) {
+        err << exc.what() << std::endl;
+        err << program;
+        return EXIT_FAILURE;
+    }
+    if (watch && warm) {
+        err << "--watch is not supported by the compile server" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (inputs.size() > 1 && !depfile.empty()) {
+        err << "--depfile requires a single input file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string baseDir   = cwd.string();
     std::string outputDir = output.string();
     std::vector<idl_utf8_t> dirs;
     std::vector<idl_utf8_t> adds;
@@ -93,55 +348,399 @@ int main(int argc, char* argv[]) {
     idl_options_t options{};
     auto code = idl_options_create(&options);
     if (code != IDL_RESULT_SUCCESS) {
-        std::cerr << idl_result_to_string(code) << std::endl;
+        err << idl_result_to_string(code) << std::endl;
         return EXIT_FAILURE;
     }
     idl_options_set_debug_mode(options, 0);
+    idl_options_set_base_dir(options, baseDir.c_str());
+    idl_options_set_import_cache(options, warm ? 1 : 0);
+    idl_options_set_compile_cache(options, warm || watch ? 1 : 0);
     idl_options_set_warnings_as_errors(options, warnAsErr ? 1 : 0);
     idl_options_set_output_dir(options, outputDir.c_str());
     idl_options_set_import_dirs(options, (idl_uint32_t) dirs.size(), dirs.data());
     idl_options_set_additions(options, (idl_uint32_t) adds.size(), adds.data());
     idl_options_set_version(options, version ? &version.value() : nullptr);
+    idl_options_set_write_if_changed(options, writeIfChanged || watch ? 1 : 0);
+    idl_options_set_depfile(options, depfile.empty() ? nullptr : depfile.c_str());
+    idl_options_set_depfile_target(options, depfileTarget.empty() ? nullptr : depfileTarget.c_str());
+    idl_options_set_jobs(options, (idl_uint32_t) std::max(jobs, 0));
+    idl_options_set_tracer(options, traceFile.empty() ? nullptr : collectTrace, &traceLog);
 
+    std::set<std::string> watched;
+    for (const auto& input : inputs) {
+        watched.insert((cwd / input).lexically_normal().string());
+    }
+    auto compile = [&]() {
+        auto collect = [&](idl_compilation_result_t result) {
+            auto failed = report(err, result, timeReport);
+            if (watch) {
+                for (const auto& file : getFiles(result, idl_compilation_result_get_dependencies)) {
+                    watched.insert(std::filesystem::path(file).lexically_normal().string());
+                }
+                for (const auto& file : getFiles(result, idl_compilation_result_get_changed_files)) {
+                    err << "updated " << file << std::endl;
+                }
+            }
+            idl_compilation_result_destroy(result);
+            return failed;
+        };
+        traceLog.events.clear();
+        bool failed = false;
+        if (inputs.size() == 1) {
+            idl_compilation_result_t result{};
+            code = idl_compiler_compile_multi(compiler,
+                                              (idl_uint32_t) gens.size(),
+                                              gens.data(),
+                                              inputs.front().c_str(),
+                                              0,
+                                              nullptr,
+                                              options,
+                                              &result);
+            if (result) {
+                failed = collect(result);
+            }
+        } else {
+            std::vector<idl_compile_job_t> jobs;
+            for (const auto& input : inputs) {
+                for (auto gen : gens) {
+                    jobs.push_back({ gen, input.c_str(), options });
+                }
+            }
+            std::vector<idl_compilation_result_t> results(jobs.size());
+            code = idl_compiler_compile_batch(compiler, (idl_uint32_t) jobs.size(), jobs.data(), results.data());
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (results[i]) {
+                    if (timeReport) {
+                        err << jobs[i].file << ':' << std::endl;
+                    }
+                    failed = collect(results[i]) || failed;
+                }
+            }
+        }
+        if (code != IDL_RESULT_SUCCESS) {
+            err << "error: " << idl_result_to_string(code) << std::endl;
+            failed = true;
+        }
+        if (!traceFile.empty() && !writeTrace((cwd / traceFile).string(), traceLog)) {
+            err << "error: failed to write trace '" << traceFile << "'" << std::endl;
+            failed = true;
+        }
+        return failed;
+    };
+
+    auto failed = compile();
+    // Watch mode rebuilds all inputs after each change and relies on write-if-changed
+    // to leave unaffected outputs untouched. Inputs that do not depend on a changed file
+    // are replayed from the compile cache. The others are parsed again, but the C header
+    // of each imported file is only generated again when a file it depends on changed.
+    while (watch) {
+        err << "watching " << watched.size() << " files" << std::endl;
+        const auto changed = waitForChanges(watched);
+        for (const auto& file : changed) {
+            err << "changed " << file << std::endl;
+            idl_compiler_invalidate_cache(compiler, file.c_str());
+        }
+        failed = compile();
+    }
+
+    idl_options_destroy(options);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int runLocal(const std::vector<std::string>& args) {
     idl_compiler_t compiler{};
-    idl_compiler_create(&compiler);
-    if (code != IDL_RESULT_SUCCESS) {
-        idl_options_destroy(options);
+    if (auto code = idl_compiler_create(&compiler); code != IDL_RESULT_SUCCESS) {
+        std::cerr << idl_result_to_string(code) << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto exitCode = run(args, std::filesystem::current_path(), compiler, false, std::cout, std::cerr);
+    idl_compiler_destroy(compiler);
+    return exitCode;
+}
+
+#ifndef IDL_PLATFORM_WINDOWS
+
+// Messages between the client and the server are sequences of 32-bit integers
+// and length-prefixed strings. The client sends its working directory and
+// arguments, the server answers with the exit code, stdout and stderr of the run.
+
+bool sendAll(int fd, const void* data, size_t size) {
+    auto ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        auto count = write(fd, ptr, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        ptr += count;
+        size -= (size_t) count;
+    }
+    return true;
+}
+
+bool recvAll(int fd, void* data, size_t size) {
+    auto ptr = static_cast<char*>(data);
+    while (size > 0) {
+        auto count = read(fd, ptr, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        ptr += count;
+        size -= (size_t) count;
+    }
+    return true;
+}
+
+bool sendInt(int fd, uint32_t value) {
+    return sendAll(fd, &value, sizeof(value));
+}
+
+bool recvInt(int fd, uint32_t& value) {
+    return recvAll(fd, &value, sizeof(value));
+}
+
+bool sendString(int fd, const std::string& str) {
+    return sendInt(fd, (uint32_t) str.length()) && sendAll(fd, str.data(), str.length());
+}
+
+bool recvString(int fd, std::string& str) {
+    uint32_t length{};
+    if (!recvInt(fd, length)) {
+        return false;
+    }
+    str.resize(length);
+    return recvAll(fd, str.data(), length);
+}
+
+// The socket lives in the per-user runtime directory, or else in a private
+// directory under the temporary directory. An empty path means that no such
+// directory is available and the server cannot be used.
+std::string socketPath() {
+    if (auto path = std::getenv("IDLC_SOCKET")) {
+        return path;
+    }
+    if (auto dir = std::getenv("XDG_RUNTIME_DIR"); dir && *dir) {
+        return (std::filesystem::path(dir) / "idlc.sock").string();
+    }
+    const auto dir = std::filesystem::temp_directory_path() / ("idlc-" + std::to_string(getuid()));
+    mkdir(dir.c_str(), 0700);
+    struct stat st {};
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0) {
+        return {};
+    }
+    return (dir / "idlc.sock").string();
+}
+
+bool samePeer(int fd) {
+#if defined(IDL_PLATFORM_LINUX) || defined(IDL_PLATFORM_ANDROID)
+    ucred cred{};
+    socklen_t size = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) == 0 && cred.uid == getuid();
+#else
+    uid_t uid{};
+    gid_t gid{};
+    return getpeereid(fd, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+int connectSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (const sockaddr*) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// A client that stops sending its request, or stops reading the answer, gives
+// up its slot once the timeout expires. The compilation itself is not limited.
+bool setTimeouts(int fd) {
+    timeval timeout{ 10, 0 };
+    return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0 &&
+           setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+bool serveClient(int fd, idl_compiler_t compiler) {
+    std::string cwd;
+    uint32_t argc{};
+    if (!recvString(fd, cwd) || !recvInt(fd, argc)) {
+        return false;
+    }
+    std::vector<std::string> args(argc);
+    for (auto& arg : args) {
+        if (!recvString(fd, arg)) {
+            return false;
+        }
+    }
+    std::ostringstream out;
+    std::ostringstream err;
+    int exitCode{};
+    try {
+        exitCode = run(args, cwd, compiler, true, out, err);
+    } catch (const std::exception& exc) {
+        err << "error: " << exc.what() << std::endl;
+        exitCode = EXIT_FAILURE;
+    }
+    return sendInt(fd, (uint32_t) exitCode) && sendString(fd, out.str()) && sendString(fd, err.str());
+}
+
+int server() {
+    const auto path = socketPath();
+    sockaddr_un addr{};
+    if (path.empty()) {
+        std::cerr << "no private directory for the socket, set XDG_RUNTIME_DIR or IDLC_SOCKET" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (path.length() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path '" << path << "' is too long" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (auto fd = connectSocket(path); fd >= 0) {
+        close(fd);
+        std::cerr << "server is already listening on '" << path << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // Only the user running the server may connect to the socket.
+    const auto mask  = umask(0177);
+    const auto bound = fd >= 0 && bind(fd, (const sockaddr*) &addr, sizeof(addr)) == 0;
+    umask(mask);
+    if (!bound || chmod(path.c_str(), 0600) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "failed to listen on '" << path << "': " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    idl_compiler_t compiler{};
+    if (auto code = idl_compiler_create(&compiler); code != IDL_RESULT_SUCCESS) {
+        close(fd);
         std::cerr << idl_result_to_string(code) << std::endl;
         return EXIT_FAILURE;
     }
-    idl_compilation_result_t result{};
-    code = idl_compiler_compile(compiler, gen, inputFile.c_str(), 0, nullptr, options, &result);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cerr << "listening on '" << path << "'" << std::endl;
 
-    bool failed = false;
-    if (result) {
-        if (idl_compilation_result_has_errors(result)) {
-            failed = true;
+    // Each connection is served on its own thread; the compiler, its import
+    // directory index and compile cache are shared by all of them. At most one
+    // client per hardware thread is served at a time, further connections wait
+    // in the listen backlog.
+    struct Clients {
+        std::mutex mutex;
+        std::condition_variable released;
+        unsigned active{};
+    };
+    auto release = [](Clients& clients) {
+        {
+            std::lock_guard lock(clients.mutex);
+            --clients.active;
         }
-        if (idl_compilation_result_has_errors(result) || idl_compilation_result_has_warnings(result)) {
-            idl_uint32_t count{};
-            idl_compilation_result_get_messages(result, &count, nullptr);
-            std::vector<idl_message_t> messages;
-            messages.resize(count);
-            idl_compilation_result_get_messages(result, &count, messages.data());
-            for (const auto& message : messages) {
-                std::cerr << (message.is_error ? "error" : "warning");
-                std::cerr << " [" << (message.status >= IDL_STATUS_E2001 ? 'E' : 'W');
-                std::cerr << (int) message.status << "]: " << message.message;
-                if (message.line > 0) {
-                    std::cerr << " at " << message.filename << ':' << message.line << ':' << message.column << '.'
-                              << std::endl;
-                }
+        clients.released.notify_one();
+    };
+
+    auto clients          = std::make_shared<Clients>();
+    const auto maxClients = std::max(std::thread::hardware_concurrency(), 1u);
+    while (true) {
+        {
+            std::unique_lock lock(clients->mutex);
+            clients->released.wait(lock, [&]() { return clients->active < maxClients; });
+            ++clients->active;
+        }
+        auto client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            release(*clients);
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
             }
+            break;
+        }
+        if (!samePeer(client) || !setTimeouts(client)) {
+            close(client);
+            release(*clients);
+            continue;
+        }
+        auto reference = idl_compiler_reference(compiler);
+        try {
+            std::thread([client, clients, release, reference]() {
+                serveClient(client, reference);
+                close(client);
+                idl_compiler_destroy(reference);
+                release(*clients);
+            }).detach();
+        } catch (const std::system_error&) {
+            close(client);
+            idl_compiler_destroy(reference);
+            release(*clients);
         }
-        idl_compilation_result_destroy(result);
     }
-    if (code != IDL_RESULT_SUCCESS) {
-        std::cerr << "error: " << idl_result_to_string(code) << std::endl;
-        failed = true;
+    std::cerr << "failed to accept connection: " << std::strerror(errno) << std::endl;
+    idl_compiler_destroy(compiler);
+    close(fd);
+    return EXIT_FAILURE;
+}
+
+int client(const std::vector<std::string>& args) {
+    auto fd = connectSocket(socketPath());
+    if (fd < 0) {
+        return runLocal(args);
+    }
+    if (!samePeer(fd)) {
+        close(fd);
+        std::cerr << "warning: the compile server belongs to another user, compiling locally" << std::endl;
+        return runLocal(args);
+    }
+    auto sent = sendString(fd, std::filesystem::current_path().string()) && sendInt(fd, (uint32_t) args.size());
+    for (const auto& arg : args) {
+        sent = sent && sendString(fd, arg);
     }
+    uint32_t exitCode{};
+    std::string out;
+    std::string err;
+    const auto received = sent && recvInt(fd, exitCode) && recvString(fd, out) && recvString(fd, err);
+    close(fd);
+    if (!received) {
+        std::cerr << "error: connection to the compile server was lost" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << out << std::flush;
+    std::cerr << err << std::flush;
+    return (int) exitCode;
+}
 
-    idl_compiler_destroy(compiler);
-    idl_options_destroy(options);
-    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+#else
+
+int server() {
+    std::cerr << "compile server is not supported on this platform" << std::endl;
+    return EXIT_FAILURE;
+}
+
+int client(const std::vector<std::string>& args) {
+    return runLocal(args);
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv, argv + argc);
+    if (args.size() == 2 && args[1] == "--server") {
+        return server();
+    }
+    if (args.size() > 1 && args[1] == "--client") {
+        args.erase(args.begin() + 1);
+        return client(args);
+    }
+    return runLocal(args);
 }
@@ -0,0 +1,129 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include "idl.hpp"
+
+#if defined(IDL_PLATFORM_WINDOWS)
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#elif !defined(IDL_PLATFORM_WEB)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace idl {
+
+class MappedFile final {
+public:
+    MappedFile() noexcept = default;
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool map(const std::filesystem::path& path) noexcept {
+        unmap();
+#if defined(IDL_PLATFORM_WINDOWS)
+        auto file = CreateFileW(path.c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            return false;
+        }
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            _mapped = true;
+            return true;
+        }
+        auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            return false;
+        }
+        auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) {
+            return false;
+        }
+        _data   = static_cast<const char*>(view);
+        _size   = static_cast<size_t>(size.QuadPart);
+        _mapped = true;
+        return true;
+#elif !defined(IDL_PLATFORM_WEB)
+        auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            ::close(fd);
+            _mapped = true;
+            return true;
+        }
+        auto addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        _data   = static_cast<const char*>(addr);
+        _size   = static_cast<size_t>(st.st_size);
+        _mapped = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void unmap() noexcept {
+        if (_data) {
+#if defined(IDL_PLATFORM_WINDOWS)
+            UnmapViewOfFile(_data);
+#elif !defined(IDL_PLATFORM_WEB)
+            ::munmap(const_cast<char*>(_data), _size);
+#endif
+        }
+        _data   = nullptr;
+        _size   = 0;
+        _mapped = false;
+    }
+
+    bool mapped() const noexcept {
+        return _mapped;
+    }
+
+    std::span<const char> data() const noexcept {
+        return { _data, _size };
+    }
+
+private:
+    const char* _data{};
+    size_t _size{};
+    bool _mapped{};
+};
+
+} // namespace idl
+
+#endif
@@ -10,11 +10,11 @@ public:
     virtual ~Object() = default;
 
     void reference() noexcept {
-        ++_refCount;
+        _refCount.fetch_add(1, std::memory_order_relaxed);
     }
 
     void destroy() noexcept {
-        if (--_refCount == 0) {
+        if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             delete this;
         }
     }
@@ -42,7 +42,7 @@ public:
     }
 
 private:
-    idl_sint32_t _refCount{ 1 };
+    std::atomic<idl_sint32_t> _refCount{ 1 };
 };
 
 } // namespace idl
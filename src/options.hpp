@@ -2,6 +2,7 @@
 #define IDL_OPTIONS_HPP
 
 #include "object.hpp"
+#include "thread_pool.hpp"
 
 struct _idl_options : public idl::Object {};
 
@@ -9,7 +10,7 @@ namespace idl {
 
 class Options final : public _idl_options {
 public:
-    Options() : _outputDir(std::filesystem::current_path().string()) {
+    Options() {
         _importDirs.reserve(20);
     }
 
@@ -37,6 +38,34 @@ public:
         _outputDir = std::filesystem::path(dir).make_preferred().string();
     }
 
+    idl_utf8_t getBaseDir() const noexcept {
+        return _baseDir.empty() ? nullptr : _baseDir.c_str();
+    }
+
+    void setBaseDir(idl_utf8_t dir) {
+        _baseDir = dir ? std::filesystem::path(dir).make_preferred().string() : "";
+    }
+
+    idl_uint32_t getJobs() const noexcept {
+        return _jobs;
+    }
+
+    void setJobs(idl_uint32_t jobs) noexcept {
+        _jobs = jobs;
+    }
+
+    size_t jobs() const noexcept {
+        return _jobs ? _jobs : hardwareJobs();
+    }
+
+    std::filesystem::path basePath() const {
+        return _baseDir.empty() ? std::filesystem::current_path() : std::filesystem::path(_baseDir);
+    }
+
+    std::filesystem::path resolve(const std::filesystem::path& path) const {
+        return path.is_absolute() ? path : basePath() / path;
+    }
+
     void getImportDirs(idl_uint32_t& dirCount, idl_utf8_t* dirs) const noexcept {
         if (dirs) {
             dirCount = std::min(dirCount, (idl_uint32_t) _importDirs.size());
@@ -109,6 +138,58 @@ public:
         }
     }
 
+    bool getImportCache() const noexcept {
+        return _importCache;
+    }
+
+    void setImportCache(bool enable) noexcept {
+        _importCache = enable;
+    }
+
+    bool getCompileCache() const noexcept {
+        return _compileCache;
+    }
+
+    void setCompileCache(bool enable) noexcept {
+        _compileCache = enable;
+    }
+
+    bool getWriteIfChanged() const noexcept {
+        return _writeIfChanged;
+    }
+
+    void setWriteIfChanged(bool enable) noexcept {
+        _writeIfChanged = enable;
+    }
+
+    idl_utf8_t getDepfile() const noexcept {
+        return _depfile.empty() ? nullptr : _depfile.c_str();
+    }
+
+    void setDepfile(idl_utf8_t file) {
+        _depfile = file ? file : "";
+    }
+
+    idl_utf8_t getDepfileTarget() const noexcept {
+        return _depfileTarget.empty() ? nullptr : _depfileTarget.c_str();
+    }
+
+    void setDepfileTarget(idl_utf8_t target) {
+        _depfileTarget = target ? target : "";
+    }
+
+    idl_trace_callback_t getTracer(idl_data_t* data) const noexcept {
+        if (data) {
+            *data = _tracerData;
+        }
+        return _tracer;
+    }
+
+    void setTracer(idl_trace_callback_t callback, idl_data_t data) noexcept {
+        _tracer     = callback;
+        _tracerData = data;
+    }
+
     const idl_api_version_t* getVersion() const noexcept {
         return _version.has_value() ? &_version.value() : nullptr;
     }
@@ -121,6 +202,8 @@ private:
     bool _debugMode{};
     bool _warningsAsErrors{};
     std::string _outputDir{};
+    std::string _baseDir{};
+    idl_uint32_t _jobs{ 1 };
     std::vector<std::string> _importDirs{};
     std::vector<std::string> _additions{};
     idl_import_callback_t _importer{};
@@ -130,6 +213,13 @@ private:
     idl_write_callback_t _writer{};
     idl_data_t _writerData{};
     std::optional<idl_api_version_t> _version{};
+    bool _importCache{};
+    bool _compileCache{};
+    bool _writeIfChanged{};
+    std::string _depfile{};
+    std::string _depfileTarget{};
+    idl_trace_callback_t _tracer{};
+    idl_data_t _tracerData{};
 };
 
 }; // namespace idl
@@ -0,0 +1,98 @@
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+#include "context.hpp"
+
+#include <fmt/format.h>
+
+namespace idl {
+
+inline void writeOutput(const idl::location& loc,
+                        const Options* options,
+                        CompilationResult* result,
+                        const std::filesystem::path& path,
+                        std::string_view data) {
+    if (options && options->getWriteIfChanged()) {
+        std::ifstream existing(path);
+        if (existing) {
+            std::string content{ std::istreambuf_iterator<char>(existing), std::istreambuf_iterator<char>() };
+            if (content == data) {
+                return;
+            }
+        }
+    }
+    std::ofstream stream(path);
+    stream.write(data.data(), (std::streamsize) data.length());
+    stream.flush();
+    if (stream.fail()) {
+        err<IDL_STATUS_E2067>(loc, path.string());
+    }
+    if (result) {
+        result->addChangedFile(path.string());
+    }
+}
+
+class OutputSink final {
+public:
+    OutputSink() = default;
+
+    OutputSink(Context& ctx,
+               const std::filesystem::path& out,
+               const std::string& filename,
+               idl_write_callback_t writer,
+               idl_data_t writerData) :
+        _ctx(&ctx),
+        _out(out),
+        _filename(filename),
+        _writer(writer),
+        _writerData(writerData) {
+        std::filesystem::create_directories(out);
+    }
+
+    const std::string& filename() const noexcept {
+        return _filename;
+    }
+
+    fmt::memory_buffer& buffer() noexcept {
+        return _buffer;
+    }
+
+    std::string str() const {
+        return fmt::to_string(_buffer);
+    }
+
+    void flush() {
+        if (_writer) {
+            idl_source_t source{ _filename.c_str(), _buffer.data(), (idl_uint32_t) _buffer.size() };
+            _writer(&source, _writerData);
+        } else if (_ctx) {
+            const auto data = std::string_view(_buffer.data(), _buffer.size());
+            writeOutput(_ctx->api()->location, _ctx->options(), _ctx->result(), _out / _filename, data);
+            _ctx->addOutput(_out / _filename);
+        }
+        _buffer.clear();
+    }
+
+private:
+    fmt::memory_buffer _buffer{};
+    Context* _ctx{};
+    std::filesystem::path _out{};
+    std::string _filename{};
+    idl_write_callback_t _writer{};
+    idl_data_t _writerData{};
+};
+
+template <typename... Args>
+inline void print(OutputSink& sink, fmt::format_string<Args...> fmt, Args&&... args) {
+    fmt::format_to(fmt::appender(sink.buffer()), fmt, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+inline void println(OutputSink& sink, fmt::format_string<Args...> fmt, Args&&... args) {
+    fmt::format_to(fmt::appender(sink.buffer()), fmt, std::forward<Args>(args)...);
+    sink.buffer().push_back('\n');
+}
+
+} // namespace idl
+
+#endif
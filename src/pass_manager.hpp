@@ -0,0 +1,257 @@
+#ifndef PASS_MANAGER_HPP
+#define PASS_MANAGER_HPP
+
+#include "context.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+namespace idl {
+
+// Runs the semantic passes of a compilation in an order where each pass comes
+// after the passes it depends on; passes that do not depend on each other keep
+// the order they were added in. A pass visits every declaration of one kind,
+// and the AST changes it staged are committed once it is done. Passes over the
+// same kind that end up next to each other share a traversal unless one of them
+// depends on the other, and the cost of each pass is added to the phases of the
+// compilation result. If a shared traversal fails, its passes are run again one
+// after the other, so that the error reported is the one of the first pass.
+//
+// With more than one job, the declarations of a parallel pass are split into
+// chunks which are checked on several threads. Each thread stages its changes
+// and warnings separately, and they are committed in declaration order, so the
+// result is the same as with a single job.
+class PassManager final {
+public:
+    enum class Mode {
+        Parallel,
+        Serial
+    };
+
+    PassManager(Context& ctx, const Options* options, CompilationResult* result, size_t jobs = 1) noexcept :
+        _ctx(ctx),
+        _options(options),
+        _result(result),
+        _jobs(std::max<size_t>(jobs, 1)) {
+    }
+
+    template <typename Node>
+    void add(std::string name,
+             std::initializer_list<std::string_view> deps,
+             void (Context::*visit)(Node*),
+             Mode mode = Mode::Parallel) {
+        static_assert(std::is_base_of<ASTNode, Node>::value, "Node must be inherited from ASTNode");
+        auto& pass    = _passes.emplace_back(Pass{ std::move(name), deps });
+        pass.kinds    = { size_t(Node::kindFirst), size_t(Node::kindLast) };
+        pass.mode     = mode;
+        pass.traverse = [this](const std::function<void(ASTNode*)>& visitor) {
+            _ctx.filter<Node>([&visitor](Node* node) {
+                visitor(node);
+            });
+        };
+        pass.visit = [this, visit](ASTNode* node) {
+            (_ctx.*visit)(static_cast<Node*>(node));
+        };
+    }
+
+    void run() {
+        sort();
+        for (size_t first = 0; first < _passes.size();) {
+            auto last = first + 1;
+            while (fusable(first, last)) {
+                ++last;
+            }
+            traverse(first, last);
+            first = last;
+        }
+    }
+
+private:
+    // Declarations are handed to threads in chunks, so that a thread is not
+    // started for passes over a few declarations only.
+    static constexpr size_t chunkSize = 64;
+
+    struct Pass {
+        std::string name;
+        std::vector<std::string_view> deps;
+        std::pair<size_t, size_t> kinds{};
+        Mode mode{};
+        std::function<void(const std::function<void(ASTNode*)>&)> traverse{};
+        std::function<void(ASTNode*)> visit{};
+    };
+
+    // Orders the passes topologically, taking the first pass in add order
+    // whose dependencies have all run.
+    void sort() {
+        std::vector<size_t> order{};
+        std::vector<bool> done(_passes.size());
+        auto isDone = [this, &done](std::string_view dep) {
+            for (size_t i = 0; i < _passes.size(); ++i) {
+                if (done[i] && _passes[i].name == dep) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        while (order.size() < _passes.size()) {
+            auto ready = _passes.size();
+            for (size_t i = 0; i < _passes.size() && ready == _passes.size(); ++i) {
+                const auto& deps = _passes[i].deps;
+                if (!done[i] && std::all_of(deps.begin(), deps.end(), isDone)) {
+                    ready = i;
+                }
+            }
+            // A dependency that was never added, or a cycle: the remaining
+            // passes run in the order they were added.
+            assert(ready < _passes.size());
+            if (ready == _passes.size()) {
+                ready = size_t(std::find(done.begin(), done.end(), false) - done.begin());
+            }
+            done[ready] = true;
+            order.push_back(ready);
+        }
+        std::vector<Pass> sorted{};
+        sorted.reserve(_passes.size());
+        for (auto i : order) {
+            sorted.push_back(std::move(_passes[i]));
+        }
+        _passes = std::move(sorted);
+    }
+
+    bool fusable(size_t first, size_t next) const {
+        if (next >= _passes.size() || _passes[first].kinds != _passes[next].kinds ||
+            _passes[first].mode != _passes[next].mode) {
+            return false;
+        }
+        const auto& deps = _passes[next].deps;
+        for (auto i = first; i < next; ++i) {
+            if (std::find(deps.begin(), deps.end(), _passes[i].name) != deps.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void traverse(size_t first, size_t last) {
+        // Passes sharing a traversal are timed per declaration, so that each
+        // of them still reports its own cost.
+        const auto fused = last - first > 1;
+        const auto timed = fused && (_result || tracing(_options));
+        const auto start = timed ? traceClock() : 0.0;
+        std::optional<PhaseTimer> timer{};
+        if (!fused) {
+            timer.emplace(_options, _result, "pass", _passes[first].name);
+        }
+
+        std::vector<ASTNode*> nodes{};
+        _passes[first].traverse([&nodes](ASTNode* node) {
+            nodes.push_back(node);
+        });
+
+        const auto parallel = _jobs > 1 && _passes[first].mode == Mode::Parallel;
+        const auto chunks   = parallel ? std::max<size_t>((nodes.size() + chunkSize - 1) / chunkSize, 1) : 1;
+        const auto passes   = last - first;
+        std::vector<Context::Staging> stagings(chunks);
+        std::vector<double> costs(chunks * passes);
+        auto check = [this, first, last, timed, parallel, passes, &nodes, &stagings, &costs](size_t chunk) {
+            auto& staging             = stagings[chunk];
+            const auto begin          = parallel ? chunk * chunkSize : 0;
+            const auto end            = parallel ? std::min(begin + chunkSize, nodes.size()) : nodes.size();
+            Context::Staging::current = &staging;
+            try {
+                for (auto i = begin; i < end; ++i) {
+                    staging.order = i;
+                    for (auto pass = first; pass < last; ++pass) {
+                        const auto clock = timed ? traceClock() : 0.0;
+                        _passes[pass].visit(nodes[i]);
+                        if (timed) {
+                            costs[chunk * passes + pass - first] += traceClock() - clock;
+                        }
+                    }
+                }
+            } catch (...) {
+                staging.failed            = true;
+                Context::Staging::current = nullptr;
+                throw;
+            }
+            Context::Staging::current = nullptr;
+        };
+
+        try {
+            parallelFor(chunks, parallel ? _jobs : 1, check);
+        } catch (...) {
+            if (fused) {
+                // Nothing has been committed yet, and the passes only stage
+                // their changes, so they can be run again separately.
+                for (auto pass = first; pass < last; ++pass) {
+                    traverse(pass, pass + 1);
+                }
+                throw;
+            }
+            // As with a single job, the warnings reported before the first
+            // failed declaration are kept.
+            auto failed = nodes.size();
+            for (const auto& staging : stagings) {
+                if (staging.failed) {
+                    failed = std::min(failed, staging.order);
+                }
+            }
+            _ctx.commitWarnings(stagings, failed);
+            throw;
+        }
+
+        const auto commit = timed ? traceClock() : 0.0;
+        _ctx.commitStaged(stagings);
+        if (!fused) {
+            return;
+        }
+
+        // The commit of a fused traversal is shared by its passes, and is
+        // accounted to each of them evenly.
+        const auto shared = timed ? (traceClock() - commit) / passes : 0.0;
+        std::string names{};
+        for (auto i = first; i < last; ++i) {
+            auto cost = shared;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                cost += costs[chunk * passes + i - first];
+            }
+            if (_result) {
+                _result->addPhase(_passes[i].name, cost / 1000.0);
+            }
+            names.append(names.empty() ? "" : "+").append(_passes[i].name);
+        }
+        trace(_options, "pass", names.c_str(), "", start);
+    }
+
+    Context& _ctx;
+    const Options* _options;
+    CompilationResult* _result;
+    size_t _jobs;
+    std::vector<Pass> _passes{};
+};
+
+inline void addSemanticPasses(PassManager& passes) {
+    // Full names are cached lazily, and enum consts are evaluated across
+    // enums, so these passes are not split between threads. Names are cached
+    // first so that the other passes only read them.
+    passes.add("cacheFullnames", {}, &Context::cacheFullname, PassManager::Mode::Serial);
+    passes.add("prepareEnumConsts", {}, &Context::prepareEnumConsts);
+    passes.add("prepareEnumValues", { "prepareEnumConsts" }, &Context::prepareEnumValues, PassManager::Mode::Serial);
+    passes.add("prepareStructs", { "prepareEnumValues" }, &Context::prepareStruct);
+    passes.add("checkStructFieldTypes", { "prepareStructs" }, &Context::checkStructFieldTypes);
+    passes.add("checkStructArrays", { "prepareStructs" }, &Context::checkStructArrays);
+    passes.add("prepareCallbacks", {}, &Context::prepareInvokable<ASTCallback>);
+    passes.add("checkCallbacks", { "prepareCallbacks" }, &Context::checkInvokable<ASTCallback>);
+    passes.add("prepareFunctions", {}, &Context::prepareInvokable<ASTFunc>);
+    passes.add("checkFunctions", { "prepareFunctions" }, &Context::checkInvokable<ASTFunc>);
+    passes.add("prepareMethods", {}, &Context::prepareInvokable<ASTMethod>);
+    passes.add("checkMethods", { "prepareMethods" }, &Context::checkInvokable<ASTMethod>);
+    passes.add("prepareProperties", { "prepareMethods" }, &Context::prepareGetterSetter<ASTProperty>);
+    passes.add("prepareEvents", { "prepareMethods" }, &Context::prepareGetterSetter<ASTEvent>);
+    passes.add("prepareInterfaces", {}, &Context::prepareInterface);
+    passes.add("prepareHandles", {}, &Context::prepareHandle);
+    passes.add("prepareDocumentation", { "prepareProperties", "prepareEvents" }, &Context::prepareDocumentation);
+}
+
+} // namespace idl
+
+#endif
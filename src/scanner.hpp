@@ -2,8 +2,13 @@
 #define SCANNER_HPP
 
 #include "context.hpp"
+#include "directory_index.hpp"
+#include "mapped_file.hpp"
+#include "token_module.hpp"
 #include "options.hpp"
 #include "parser.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 #include <fstream>
 
@@ -15,24 +20,45 @@ namespace idl {
 
 class Scanner : public yyFlexLexer {
 public:
+    struct Dependency {
+        std::filesystem::path path;
+        uint64_t hash;
+        bool fromImporter;
+        bool fromSources;
+    };
+
+    struct Directory {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+    };
+
+    // A file by the name its locations carry: the hash of its content and the
+    // names of the files it imports.
+    struct Imported {
+        uint64_t hash{};
+        std::vector<std::string> imports{};
+    };
+
     Scanner(Context& ctx,
+            DirectoryIndex& dirIndex,
             const Options* options,
             std::span<const idl_source_t> sources,
-            const std::filesystem::path& file) :
+            const std::filesystem::path& file,
+            ModuleStore* modules = nullptr) :
         yyFlexLexer(),
         _ctx(ctx),
+        _dirIndex(dirIndex),
         _options(options),
-        _sources(sources) {
+        _sources(sources),
+        _modules(modules) {
         const std::string str = "<input>";
         const auto loc        = idl::location(idl::position(&str, 1, 1));
 
-        if (_basePath.empty()) {
-            _basePath = std::filesystem::current_path();
-        }
+        _basePath = _options ? _options->basePath() : std::filesystem::current_path();
 
         std::filesystem::path path{};
         if (!file.empty()) {
-            path      = file.is_relative() ? std::filesystem::current_path() / file : file;
+            path      = file.is_relative() ? _basePath / file : file;
             _basePath = path.parent_path();
         }
 
@@ -41,11 +67,62 @@ public:
 
     ~Scanner() {
         while (!_imports.empty()) {
-            popImport();
+            popImport(false);
         }
     }
 
-    int yylex(Parser::semantic_type* yylval, Parser::location_type* yylloc);
+    int yylex(Parser::semantic_type* yylval, Parser::location_type* yylloc) {
+        while (true) {
+            auto& import = *_imports.back();
+            if (import.started) {
+                auto entry = import.module->next();
+                if (entry && entry->record == TokenModule::Token) {
+                    *yylloc                = entry->loc;
+                    yylloc->begin.filename = import.filename;
+                    yylloc->end.filename   = import.filename;
+                    if (TokenModule::isString(entry->kind)) {
+                        yylval->emplace<std::string>(entry->str);
+                    } else if (entry->kind == Parser::token::NUM) {
+                        yylval->emplace<int64_t>(entry->num);
+                    } else if (entry->kind == Parser::token::BOOL) {
+                        yylval->emplace<bool>(entry->num != 0);
+                    } else if (entry->kind == Parser::token::ATTRPLATFORMARG) {
+                        yylval->emplace<ASTAttrPlatform::Type>(ASTAttrPlatform::Type(entry->num));
+                    }
+                    return entry->kind;
+                } else if (entry) {
+                    auto loc           = entry->loc;
+                    loc.begin.filename = import.filename;
+                    loc.end.filename   = import.filename;
+                    *yylloc            = loc;
+                    // The file marker of the import is lexed before the module resumes.
+                    import.started = false;
+                    importFile(loc, entry->str, entry->name);
+                } else {
+                    context().setDeclaring(false);
+                    if (!popImport()) {
+                        return Parser::token::YYEOF;
+                    }
+                    resumeModule();
+                }
+                continue;
+            }
+            const auto kind = lex(yylval, yylloc);
+            if (kind == resume) {
+                continue;
+            }
+            if (_markerTokens > 0) {
+                if (--_markerTokens == 0 && _markerInline) {
+                    context().setDeclaring(false);
+                    _markerInline  = false;
+                    _needUpdateLoc = true;
+                }
+            } else if (!_imports.empty() && _imports.back()->writer) {
+                _imports.back()->writer->token(kind, *yylloc, *yylval);
+            }
+            return kind;
+        }
+    }
 
     Context& context() noexcept {
         return _ctx;
@@ -55,6 +132,98 @@ public:
         return _imports.back()->filename;
     }
 
+    const std::vector<Dependency>& dependencies() const noexcept {
+        return _dependencies;
+    }
+
+    const std::vector<Directory>& directories() const noexcept {
+        return _directories;
+    }
+
+    const std::unordered_map<std::string, Imported>& imported() const noexcept {
+        return _imported;
+    }
+
+    bool hashable() const noexcept {
+        return _hashable;
+    }
+
+    void importFile(const idl::location& loc, const std::string& file, const std::string& name) {
+        if (auto& import = *_imports.back(); import.writer) {
+            import.writer->import(loc, file, name);
+        }
+        if (_prelexing) {
+            context().setDeclaring(false);
+            return;
+        }
+        const auto depth = _imports.size();
+        import(loc, file);
+
+        // The imported file starts with a marker declaring its ASTFile; the two
+        // tokens it yields are not part of the module of either file. A file
+        // that was already imported gets the marker in the importing file, and
+        // the location after the import line is restored once it is lexed, so
+        // that modules do not depend on the order in which files are imported.
+        _markerInline = _imports.size() == depth;
+        if (_markerInline) {
+            _imports.back()->location = loc;
+        }
+        unputMarker(name, !_markerInline);
+    }
+
+    // Lexes the imports of the input ahead of the parser. The import graph is
+    // walked level by level and the files of a level are lexed concurrently
+    // into in-memory modules, which the parser then replays in import order.
+    // Files that fail to lex are left to the parser, which reports the error
+    // where the serial compilation would.
+    void prelex(size_t jobs) {
+        idl_data_t data{};
+        if (jobs < 2 || !_sources.empty() || _imports.size() != 1 || (_options && _options->getImporter(&data))) {
+            return;
+        }
+        const std::string str = "<input>";
+        const auto loc        = idl::location(idl::position(&str, 1, 1));
+
+        std::vector<std::pair<std::string, std::string>> imports{};
+        for (auto& name : importLines(_imports.back()->input)) {
+            imports.emplace_back(name, name);
+        }
+        std::set<std::string> visited{};
+        while (!imports.empty()) {
+            std::vector<std::pair<std::filesystem::path, std::string>> files{};
+            for (const auto& [file, name] : imports) {
+                try {
+                    auto path = std::get<0>(findFile(loc, file));
+                    if (visited.insert(path.string()).second) {
+                        files.emplace_back(std::move(path), name);
+                    }
+                } catch (...) {
+                }
+            }
+            std::vector<std::unique_ptr<ModuleReader>> modules(files.size());
+            parallelFor(files.size(), jobs, [this, &files, &modules](size_t i) {
+                try {
+                    Context ctx{ nullptr, nullptr };
+                    Scanner scanner{ ctx, _dirIndex, _basePath, _modules };
+                    modules[i] = scanner.lexModule(files[i].first, files[i].second);
+                } catch (...) {
+                }
+            });
+            imports.clear();
+            for (size_t i = 0; i < files.size(); ++i) {
+                if (auto& module = modules[i]) {
+                    while (auto entry = module->next()) {
+                        if (entry->record == TokenModule::Import) {
+                            imports.emplace_back(entry->str, entry->name);
+                        }
+                    }
+                    module->rewind();
+                    _prelexed.emplace(files[i].first.string(), std::move(module));
+                }
+            }
+        }
+    }
+
     void import(const idl::location& loc, const std::filesystem::path& file, bool isRelative = true) {
         if (isRelative && file.is_absolute()) {
             err<IDL_STATUS_E2041>(loc, file.string());
@@ -62,6 +231,9 @@ public:
         const auto [path, source, needRelease] = findFile(loc, file);
         const auto filename = path.is_absolute() ? std::filesystem::relative(path, _basePath).string() : path.string();
 
+        if (!_imports.empty()) {
+            _imported[*_imports.back()->filename].imports.push_back(filename);
+        }
         if (_allImports.contains(filename)) {
             return;
         }
@@ -72,35 +244,45 @@ public:
             _imports.back()->location = loc;
             _imports.back()->line     = yylineno;
         }
-        auto initLineNum = _imports.empty() ? 1 : std::numeric_limits<position::counter_type>::max() - 1;
+        // An imported file starts two lines before the first line, which the
+        // newlines of its file marker wrap around to. A file lexed ahead of the
+        // parser is an import as well, so its module has the same locations.
+        auto initLineNum = _imports.empty() && !_prelexing ? 1 : std::numeric_limits<position::counter_type>::max() - 1;
         _imports.emplace_back(std::make_unique<Import>(this,
                                                        source,
                                                        needRelease,
                                                        path,
                                                        filenamePtr,
                                                        idl::location(idl::position(filenamePtr, initLineNum, 1)),
-                                                       1,
-                                                       nullptr,
-                                                       nullptr));
+                                                       1));
         auto& import = *_imports.back();
+        if (tracing(_options)) {
+            import.traceStart = traceClock();
+        }
         if (import.source) {
-            struct MemoryBuffer : public std::streambuf {
-            public:
-                MemoryBuffer(const char* data, size_t size) {
-                    setg(const_cast<char*>(data), const_cast<char*>(data), const_cast<char*>(data) + size);
-                }
-            };
-
-            import.stream = new std::istream(new MemoryBuffer(import.source->data, (size_t) import.source->size));
+            import.input = { import.source->data, (size_t) import.source->size };
+        } else if (import.mapped.map(path)) {
+            import.input = import.mapped.data();
         } else {
-            import.stream = new std::ifstream(path);
+            import.stream = std::make_unique<std::ifstream>(path);
             if (import.stream->fail()) {
-                delete import.stream;
                 err<IDL_STATUS_E2042>(loc, path.string());
                 return;
             }
+            _hashable = false;
         }
-        import.buffer = yy_create_buffer(import.stream, 16384);
+        _dependencies.push_back({ path,
+                                  XXH64(import.input.data(), import.input.size(), 0),
+                                  import.releaseSource,
+                                  import.source && !import.releaseSource });
+        _imported[filename].hash = _dependencies.back().hash;
+        if (auto result = _ctx.result(); result && !import.source) {
+            result->addDependency(path.string());
+        }
+        if ((isRelative || _prelexing) && !import.stream) {
+            openModule(import, path);
+        }
+        import.buffer = yy_create_buffer(import.stream ? import.stream.get() : &_nullStream, 16384);
         yy_switch_to_buffer(import.buffer);
 
         yylineno = 1;
@@ -108,13 +290,29 @@ public:
         _needUpdateLoc = true;
     }
 
-    bool popImport() {
+    bool resumeModule() noexcept {
+        auto& import   = *_imports.back();
+        import.started = import.module != nullptr;
+        return import.started;
+    }
+
+    bool popImport(bool complete = true) {
+        if (auto& import = *_imports.back(); complete && import.writer) {
+            _lexed = import.writer->release();
+            if (_modules) {
+                _modules->insert(import.file, _lexed);
+            }
+        }
         if (_imports.size() > 1) {
             auto& import = *(_imports.rbegin() + 1);
             yy_switch_to_buffer(import->buffer);
             yylineno = import->line;
         }
         assert(!_imports.empty());
+        if (tracing(_options)) {
+            const auto& import = *_imports.back();
+            trace(_options, "import", import.filename->c_str(), import.file.string().c_str(), import.traceStart);
+        }
         if (_imports.back()->releaseSource && _options) {
             idl_data_t data{};
             if (auto callback = _options->getReleaseImport(&data)) {
@@ -130,13 +328,12 @@ public:
     }
 
     void action(idl::location& loc) {
-        if (!_needUpdateLoc) {
-            loc.step();
-            loc.columns(yyleng);
-        } else {
+        if (_needUpdateLoc) {
             loc            = _imports.back()->location;
             _needUpdateLoc = false;
         }
+        loc.step();
+        loc.columns(yyleng);
     }
 
     int lineIndent = -1;
@@ -146,18 +343,6 @@ private:
         ~Import() {
             scanner->yy_delete_buffer(buffer);
             buffer = nullptr;
-            if (stream) {
-                std::streambuf* buf{};
-                if (source) {
-                    buf = stream->rdbuf();
-                }
-                delete stream;
-                stream = nullptr;
-                if (buf) {
-                    delete buf;
-                    buf = nullptr;
-                }
-            }
         }
 
         Scanner* scanner{};
@@ -168,11 +353,111 @@ private:
         idl::location location;
         int line{};
         yy_buffer_state* buffer{};
-        std::istream* stream{};
+        std::unique_ptr<std::ifstream> stream{};
+        MappedFile mapped{};
+        std::span<const char> input{};
+        size_t offset{};
+        double traceStart{};
+        uint64_t hash{};
+        std::unique_ptr<ModuleReader> module{};
+        std::unique_ptr<ModuleWriter> writer{};
+        bool started{};
     };
 
+    static constexpr int resume = -1;
+
+    Scanner(Context& ctx, DirectoryIndex& dirIndex, const std::filesystem::path& basePath, ModuleStore* modules) :
+        yyFlexLexer(),
+        _ctx(ctx),
+        _dirIndex(dirIndex),
+        _options(nullptr),
+        _modules(modules),
+        _basePath(basePath),
+        _prelexing(true) {
+    }
+
+    int lex(Parser::semantic_type* yylval, Parser::location_type* yylloc);
+
+    std::unique_ptr<ModuleReader> lexModule(const std::filesystem::path& path, const std::string& name) {
+        const std::string str = "<input>";
+        const auto loc        = idl::location(idl::position(&str, 1, 1));
+
+        import(loc, path, false);
+        auto& import = *_imports.back();
+        if (import.module || !import.writer) {
+            return std::move(import.module);
+        }
+        unputMarker(name, true);
+
+        Parser::semantic_type value{};
+        idl::location location{};
+        for (auto kind = yylex(&value, &location); kind != Parser::token::YYEOF; kind = yylex(&value, &location)) {
+            TokenModule::destroy(kind, value);
+        }
+        return _lexed ? std::make_unique<ModuleReader>(std::move(_lexed)) : nullptr;
+    }
+
+    void openModule(Import& import, const std::filesystem::path& path) {
+        import.hash = _dependencies.back().hash;
+        if (auto it = _prelexed.find(path.string()); it != _prelexed.end() && it->second->hash() == import.hash) {
+            import.module = std::move(it->second);
+            _prelexed.erase(it);
+        } else if (auto module = _modules ? _modules->find(path, import.hash) : nullptr) {
+            import.module = std::make_unique<ModuleReader>(std::move(module));
+        }
+        if (!import.module && (_prelexing || _modules)) {
+            import.writer = std::make_unique<ModuleWriter>(import.hash);
+        }
+        if (import.module) {
+            // Only the file marker is lexed, the tokens are replayed from the module.
+            import.offset = import.input.size();
+        }
+    }
+
+    void unputMarker(const std::string& name, bool newFile) {
+        const std::string marker = "b166074c3cba4005a198513772597880 " + name + (newFile ? "\n\n" : "");
+        for (auto it = marker.rbegin(); it != marker.rend(); ++it) {
+            yyunput(*it, yytext);
+        }
+        _markerTokens = 2;
+    }
+
+    static std::vector<std::string> importLines(std::span<const char> input) {
+        constexpr std::string_view chars = "-.abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+        std::vector<std::string> imports{};
+        const std::string_view text(input.data(), input.size());
+        for (size_t offset = 0; offset < text.size();) {
+            auto end  = std::min(text.find('\n', offset), text.size());
+            auto line = text.substr(offset, end - offset);
+            offset    = end + 1;
+            line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+            if (!line.starts_with("import ")) {
+                continue;
+            }
+            line.remove_prefix(std::min(line.find_first_not_of(' ', 7), line.size()));
+            const auto length = line.find_first_not_of(chars);
+            if (length > 0) {
+                imports.emplace_back(line.substr(0, length));
+            }
+        }
+        return imports;
+    }
+
+    int LexerInput(char* buf, int maxSize) override {
+        auto& import = *_imports.back();
+        if (import.stream) {
+            return yyFlexLexer::LexerInput(buf, maxSize);
+        }
+        const auto size = std::min(import.input.size() - import.offset, (size_t) maxSize);
+        if (size > 0) {
+            std::memcpy(buf, import.input.data() + import.offset, size);
+            import.offset += size;
+        }
+        return (int) size;
+    }
+
     std::tuple<std::filesystem::path, const idl_source_t*, bool> findFile(const idl::location& loc,
-                                                                          const std::filesystem::path& file) const {
+                                                                          const std::filesystem::path& file) {
         if (file.empty() && !_sources.empty()) {
             auto& source = _sources.front();
             return { source.name, &source, false };
@@ -211,44 +496,50 @@ private:
             _options->getImportDirs(dirCount, dirs.data());
             importDirs.reserve(dirs.size());
             for (const auto dir : dirs) {
-                importDirs.push_back(dir);
+                importDirs.push_back(_options->resolve(dir));
             }
         }
         importDirs.push_back(_basePath);
 
-        for (const auto basePath : importDirs) {
-            try {
-                auto fullpath = basePath / file;
-                auto filename = file.string();
-                while (true) {
-                    if (!fullpath.has_extension()) {
-                        fullpath.replace_extension(".idl");
-                    } else if (lowercase(fullpath.extension()) != ".idl") {
-                        fullpath += ".idl";
-                    }
-                    if (std::filesystem::exists(fullpath) && std::filesystem::is_regular_file(fullpath)) {
-                        return { fullpath, nullptr, false };
-                    }
-                    for (const auto& entry : std::filesystem::directory_iterator(fullpath.parent_path())) {
-                        const auto pathActual   = lowercase(entry.path());
-                        const auto pathExpected = lowercase(fullpath);
-                        if (pathActual == pathExpected) {
-                            return { entry.path(), nullptr, false };
-                        }
-                    }
-                    const auto offset = filename.find('.');
-                    if (offset == std::string::npos) {
-                        break;
-                    }
-                    filename.replace(offset, 1, 1, '/');
-                    fullpath = basePath / std::filesystem::path(filename).make_preferred();
+        for (const auto& basePath : importDirs) {
+            auto fullpath = basePath / file;
+            auto filename = file.string();
+            while (true) {
+                if (!fullpath.has_extension()) {
+                    fullpath.replace_extension(".idl");
+                } else if (lowercase(fullpath.extension()) != ".idl") {
+                    fullpath += ".idl";
+                }
+                searched(fullpath.parent_path());
+                if (auto path = _dirIndex.find(fullpath)) {
+                    return { *path, nullptr, false };
+                }
+                const auto offset = filename.find('.');
+                if (offset == std::string::npos) {
+                    break;
                 }
-            } catch (const std::filesystem::filesystem_error&) {
+                filename.replace(offset, 1, 1, '/');
+                fullpath = basePath / std::filesystem::path(filename).make_preferred();
             }
         }
         err<IDL_STATUS_E2041>(loc, file.string());
     }
 
+    // The compile cache needs the directories searched for imports: a file
+    // added to one of them may resolve an import to another file.
+    void searched(const std::filesystem::path& dir) {
+        if (!_options || !_options->getCompileCache()) {
+            return;
+        }
+        for (const auto& directory : _directories) {
+            if (directory.path == dir) {
+                return;
+            }
+        }
+        std::error_code ec;
+        _directories.push_back({ dir, std::filesystem::last_write_time(dir, ec) });
+    }
+
     std::string normalize(const std::filesystem::path& path) const {
         auto filename = path.is_absolute() ? std::filesystem::relative(path, _basePath).string() : path.string();
         auto offset   = filename.find('\\');
@@ -272,12 +563,24 @@ private:
     }
 
     Context& _ctx;
+    DirectoryIndex& _dirIndex;
     const Options* _options;
     std::span<const idl_source_t> _sources;
+    ModuleStore* _modules{};
     std::filesystem::path _basePath{};
     std::vector<std::unique_ptr<Import>> _imports{};
     std::map<std::string, std::unique_ptr<std::string>> _allImports{};
+    std::istream _nullStream{ nullptr };
+    std::vector<Dependency> _dependencies{};
+    std::vector<Directory> _directories{};
+    std::unordered_map<std::string, Imported> _imported{};
+    bool _hashable{ true };
     bool _needUpdateLoc{};
+    int _markerTokens{};
+    bool _markerInline{};
+    bool _prelexing{};
+    std::shared_ptr<const TokenModule> _lexed{};
+    std::map<std::string, std::unique_ptr<ModuleReader>> _prelexed{};
 };
 
 } // namespace idl
@@ -0,0 +1,71 @@
+#ifndef SYMBOL_POOL_HPP
+#define SYMBOL_POOL_HPP
+
+#include "idl.hpp"
+
+namespace idl {
+
+class SymbolPool final {
+public:
+    explicit SymbolPool(std::pmr::memory_resource* resource) noexcept : _resource(resource) {
+    }
+
+    SymbolPool(const SymbolPool&)            = delete;
+    SymbolPool& operator=(const SymbolPool&) = delete;
+
+    uint32_t intern(std::string_view str) {
+        if (auto id = find(str)) {
+            return id;
+        }
+        auto data = static_cast<char*>(_resource->allocate(str.length() + 1, alignof(char)));
+        std::memcpy(data, str.data(), str.length());
+        data[str.length()] = '\0';
+
+        const auto view = std::string_view(data, str.length());
+        const auto id   = static_cast<uint32_t>(_strings.size() + 1);
+        _strings.push_back(view);
+        _ids.emplace(view, id);
+        return id;
+    }
+
+    uint32_t find(std::string_view str) const noexcept {
+        auto it = _ids.find(str);
+        return it != _ids.end() ? it->second : 0;
+    }
+
+    std::string_view str(uint32_t id) const noexcept {
+        assert(id > 0 && id <= _strings.size());
+        return _strings[id - 1];
+    }
+
+private:
+    static char fold(char c) noexcept {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    struct Hash {
+        size_t operator()(std::string_view str) const noexcept {
+            uint64_t hash = 14695981039346656037ull;
+            for (auto c : str) {
+                hash = (hash ^ static_cast<unsigned char>(fold(c))) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct Equal {
+        bool operator()(std::string_view lhs, std::string_view rhs) const noexcept {
+            return lhs.length() == rhs.length() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](auto a, auto b) {
+                       return fold(a) == fold(b);
+                   });
+        }
+    };
+
+    std::pmr::memory_resource* _resource;
+    std::unordered_map<std::string_view, uint32_t, Hash, Equal> _ids{};
+    std::vector<std::string_view> _strings{};
+};
+
+} // namespace idl
+
+#endif
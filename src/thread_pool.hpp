@@ -0,0 +1,176 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "idl.hpp"
+
+namespace idl {
+
+inline size_t hardwareJobs() noexcept {
+#ifndef IDL_PLATFORM_WEB
+    return std::max(std::thread::hardware_concurrency(), 1u);
+#else
+    return 1;
+#endif
+}
+
+#ifndef IDL_PLATFORM_WEB
+// Worker threads shared by every parallelFor of the process, so that threads
+// are started once instead of on every call. If a thread cannot be started,
+// the pool keeps running with the threads it already has.
+class ThreadPool final {
+public:
+    explicit ThreadPool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            try {
+                _threads.emplace_back([this]() {
+                    work();
+                });
+            } catch (...) {
+                break;
+            }
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const noexcept {
+        return _threads.size();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard lock(_mutex);
+            _jobs.push_back(std::move(job));
+        }
+        _wake.notify_one();
+    }
+
+    static ThreadPool& shared() {
+        static ThreadPool pool(hardwareJobs() - 1);
+        return pool;
+    }
+
+    // Set while the thread runs tasks of a parallelFor.
+    static inline thread_local bool nested{};
+
+private:
+    void work() {
+        while (true) {
+            std::function<void()> job{};
+            {
+                std::unique_lock lock(_mutex);
+                _wake.wait(lock, [this]() {
+                    return _stop || !_jobs.empty();
+                });
+                if (_jobs.empty()) {
+                    return;
+                }
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> _threads{};
+    std::deque<std::function<void()>> _jobs{};
+    std::mutex _mutex{};
+    std::condition_variable _wake{};
+    bool _stop{};
+};
+#endif
+
+// The number of threads a parallelFor started from the calling thread can use
+// out of the given jobs.
+inline size_t availableJobs(size_t jobs) noexcept {
+#ifndef IDL_PLATFORM_WEB
+    return ThreadPool::nested ? 1 : std::min(jobs, ThreadPool::shared().size() + 1);
+#else
+    return 1;
+#endif
+}
+
+template <typename Task>
+void parallelFor(size_t count, size_t jobs, Task&& task) {
+    jobs = std::min(jobs, count);
+#ifndef IDL_PLATFORM_WEB
+    // A parallelFor nested in the tasks of another one runs on the calling
+    // thread, so the number of threads is bounded by the outermost call.
+    auto& pool = ThreadPool::shared();
+    jobs       = ThreadPool::nested ? 1 : std::min(jobs, pool.size() + 1);
+    if (jobs > 1) {
+        // Tasks are taken in index order; if several fail, the exception
+        // of the lowest index is rethrown so errors are deterministic. The
+        // state outlives the call, as helpers may be dequeued only after
+        // the caller has run every task itself.
+        struct State {
+            std::atomic<size_t> next{};
+            size_t done{};
+            std::mutex mutex{};
+            std::condition_variable finished{};
+            std::vector<std::exception_ptr> errors{};
+        };
+        auto state = std::make_shared<State>();
+        state->errors.resize(count);
+        auto worker = [state, count, &task]() {
+            const auto nested = std::exchange(ThreadPool::nested, true);
+            size_t done       = 0;
+            for (auto i = state->next++; i < count; i = state->next++) {
+                try {
+                    task(i);
+                } catch (...) {
+                    state->errors[i] = std::current_exception();
+                }
+                ++done;
+            }
+            ThreadPool::nested = nested;
+            if (done) {
+                std::lock_guard lock(state->mutex);
+                state->done += done;
+                if (state->done == count) {
+                    state->finished.notify_all();
+                }
+            }
+        };
+        for (size_t i = 1; i < jobs; ++i) {
+            try {
+                pool.submit(worker);
+            } catch (...) {
+                break;
+            }
+        }
+        worker();
+        {
+            std::unique_lock lock(state->mutex);
+            state->finished.wait(lock, [&state, count]() {
+                return state->done == count;
+            });
+        }
+        for (const auto& error : state->errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        task(i);
+    }
+}
+
+} // namespace idl
+
+#endif
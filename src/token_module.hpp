@@ -0,0 +1,139 @@
+#ifndef TOKEN_MODULE_HPP
+#define TOKEN_MODULE_HPP
+
+#include "parser.hpp"
+
+namespace idl {
+
+// The tokens the lexer produced for one imported file, and the imports it made,
+// in the order it produced them. Files lexed ahead of the parser are replayed
+// from their modules. A module records the content hash of its file, so it is
+// only replayed for the same content.
+struct TokenModule {
+    enum Record : uint8_t {
+        Token,
+        Import
+    };
+
+    struct Entry {
+        Record record{};
+        int kind{};
+        location loc{};
+        std::string str{};
+        std::string name{};
+        int64_t num{};
+    };
+
+    uint64_t hash{};
+    std::vector<Entry> entries{};
+
+    static bool isString(int kind) noexcept {
+        return kind == Parser::token::STR || kind == Parser::token::ID || kind == Parser::token::REF ||
+               kind == Parser::token::TOKINDX;
+    }
+
+    static void destroy(int kind, Parser::semantic_type& value) noexcept {
+        if (isString(kind)) {
+            value.destroy<std::string>();
+        } else if (kind == Parser::token::NUM) {
+            value.destroy<int64_t>();
+        } else if (kind == Parser::token::BOOL) {
+            value.destroy<bool>();
+        } else if (kind == Parser::token::ATTRPLATFORMARG) {
+            value.destroy<ASTAttrPlatform::Type>();
+        }
+    }
+};
+
+class ModuleWriter final {
+public:
+    explicit ModuleWriter(uint64_t hash) : _module(std::make_shared<TokenModule>()) {
+        _module->hash = hash;
+    }
+
+    void token(int kind, const location& loc, Parser::semantic_type& value) {
+        auto& entry = append(TokenModule::Token, loc);
+        entry.kind  = kind;
+        if (TokenModule::isString(kind)) {
+            entry.str = value.as<std::string>();
+        } else if (kind == Parser::token::NUM) {
+            entry.num = value.as<int64_t>();
+        } else if (kind == Parser::token::BOOL) {
+            entry.num = int64_t(value.as<bool>());
+        } else if (kind == Parser::token::ATTRPLATFORMARG) {
+            entry.num = int64_t(value.as<ASTAttrPlatform::Type>());
+        }
+    }
+
+    void import(const location& loc, const std::string& path, const std::string& name) {
+        auto& entry = append(TokenModule::Import, loc);
+        entry.str   = path;
+        entry.name  = name;
+    }
+
+    std::shared_ptr<const TokenModule> release() noexcept {
+        return std::move(_module);
+    }
+
+private:
+    TokenModule::Entry& append(TokenModule::Record record, const location& loc) {
+        auto& entry  = _module->entries.emplace_back();
+        entry.record = record;
+        entry.loc    = loc;
+        // File names belong to the scanner that lexed the file, they are set
+        // again when the module is replayed.
+        entry.loc.begin.filename = nullptr;
+        entry.loc.end.filename   = nullptr;
+        return entry;
+    }
+
+    std::shared_ptr<TokenModule> _module;
+};
+
+class ModuleReader final {
+public:
+    explicit ModuleReader(std::shared_ptr<const TokenModule> module) noexcept : _module(std::move(module)) {
+    }
+
+    uint64_t hash() const noexcept {
+        return _module->hash;
+    }
+
+    void rewind() noexcept {
+        _next = 0;
+    }
+
+    // Returns null once every entry of the module has been read.
+    const TokenModule::Entry* next() noexcept {
+        return _next < _module->entries.size() ? &_module->entries[_next++] : nullptr;
+    }
+
+private:
+    std::shared_ptr<const TokenModule> _module;
+    size_t _next{};
+};
+
+// Modules shared by several compilations, so that an import is lexed once. A
+// module is looked up by the path and content hash of its file, and modules
+// are immutable once stored.
+class ModuleStore final {
+public:
+    std::shared_ptr<const TokenModule> find(const std::filesystem::path& path, uint64_t hash) {
+        std::lock_guard lock(_mutex);
+        auto it = _modules.find(path.string());
+        return it != _modules.end() && it->second->hash == hash ? it->second : nullptr;
+    }
+
+    void insert(const std::filesystem::path& path, std::shared_ptr<const TokenModule> module) {
+        std::lock_guard lock(_mutex);
+        _modules[path.string()] = std::move(module);
+    }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const TokenModule>> _modules{};
+    std::mutex _mutex{};
+};
+
+} // namespace idl
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "compilation_result.hpp"
+#include "options.hpp"
+
+namespace idl {
+
+inline double traceClock() noexcept {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+inline idl_uint32_t traceThreadId() noexcept {
+    static std::atomic<idl_uint32_t> next{};
+    thread_local const auto id = ++next;
+    return id;
+}
+
+inline bool tracing(const Options* options) noexcept {
+    return options && options->getTracer(nullptr);
+}
+
+inline void trace(const Options* options, idl_utf8_t category, idl_utf8_t name, idl_utf8_t detail, double start) {
+    idl_data_t data{};
+    if (auto tracer = options ? options->getTracer(&data) : nullptr) {
+        const idl_trace_event_t event{ name, category, detail, start, traceClock() - start, traceThreadId() };
+        tracer(&event, data);
+    }
+}
+
+class PhaseTimer final {
+public:
+    PhaseTimer(const Options* options, CompilationResult* result, idl_utf8_t category, std::string name) noexcept :
+        _options(tracing(options) ? options : nullptr),
+        _result(result),
+        _category(category),
+        _name(std::move(name)),
+        _start(_options || _result ? traceClock() : 0.0) {
+    }
+
+    ~PhaseTimer() {
+        if (_result) {
+            _result->addPhase(_name, (traceClock() - _start) / 1000.0);
+        }
+        trace(_options, _category, _name.c_str(), "", _start);
+    }
+
+    PhaseTimer(const PhaseTimer&)            = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    const Options* _options;
+    CompilationResult* _result;
+    idl_utf8_t _category;
+    std::string _name;
+    double _start;
+};
+
+} // namespace idl
+
+#endif
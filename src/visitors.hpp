@@ -135,7 +135,7 @@ struct CName : Visitor {
 
     void visit(ASTArg* node) override {
         if (auto attr = node->findAttr<ASTAttrCName>()) {
-            str = attr->name;
+            str = std::string(attr->name);
         } else {
             str = convert(node->name, Case::SnakeCase);
         }
@@ -147,9 +147,9 @@ struct CName : Visitor {
 
     static std::string cnameDecl(ASTDecl* decl, bool upper) {
         if (auto attr = decl->findAttr<ASTAttrCName>()) {
-            return attr->name;
+            return std::string(attr->name);
         }
-        std::vector<int>* nums = nullptr;
+        ASTVector<int>* nums = nullptr;
         if (auto attr = decl->findAttr<ASTAttrTokenizer>()) {
             nums = &attr->nums;
         }
@@ -369,7 +369,9 @@ struct AllowedAttrs : Visitor {
 };
 
 struct DocValidator : Visitor {
-    DocValidator(Options* ops, CompilationResult* res) noexcept : options(ops), result(res) {
+    DocValidator(Options* ops, std::function<void(const Exception&)> warning) noexcept :
+        options(ops),
+        warn(std::move(warning)) {
     }
 
     void visit(ASTApi* node) override {
@@ -386,8 +388,8 @@ struct DocValidator : Visitor {
             if (warnAsError) {
                 throw;
             }
-            if (result) {
-                result->addMessage(exc, false);
+            if (warn) {
+                warn(exc);
             }
         }
     }
@@ -457,7 +459,7 @@ struct DocValidator : Visitor {
     }
 
     Options* options;
-    CompilationResult* result;
+    std::function<void(const Exception&)> warn;
 };
 
 struct ChildsAggregator : Visitor {